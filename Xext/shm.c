@@ -1338,7 +1338,7 @@ ProcShmDispatch(ClientPtr client)
     if (stuff->data == X_ShmQueryVersion)
         return ProcShmQueryVersion(client);
 
-    if (!client->local)
+    if (!GetClientLocal(client))
         return BadRequest;
 
     switch (stuff->data) {
@@ -1502,7 +1502,7 @@ SProcShmDispatch(ClientPtr client)
     if (stuff->data == X_ShmQueryVersion)
         return SProcShmQueryVersion(client);
 
-    if (!client->local)
+    if (!GetClientLocal(client))
         return BadRequest;
 
     switch (stuff->data) {
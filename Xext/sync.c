@@ -110,6 +110,12 @@ static const char *WARN_INVALID_COUNTER_ALARM =
 
 static void SyncComputeBracketValues(SyncCounter *);
 
+static Bool SyncIndexInsert(SyncCounter *, SyncTrigger *);
+
+static void SyncIndexRemove(SyncCounter *, SyncTrigger *);
+
+static int SyncIndexFind(SyncCounter *, int, int64_t, SyncTrigger *);
+
 static void SyncInitServerTime(void);
 
 static void SyncInitIdleTime(void);
@@ -138,8 +144,9 @@ SyncCheckWarnIsCounter(const SyncObject * pSync, const char *warning)
 }
 
 /*  Each counter maintains a simple linked list of triggers that are
- *  interested in the counter.  The two functions below are used to
- *  delete and add triggers on this list.
+ *  interested in the counter, and an index of the same triggers sorted
+ *  by test value.  The two functions below are used to delete and add
+ *  triggers on both.
  */
 void
 SyncDeleteTriggerFromSyncObject(SyncTrigger * pTrigger)
@@ -174,6 +181,10 @@ SyncDeleteTriggerFromSyncObject(SyncTrigger * pTrigger)
     if (SYNC_COUNTER == pTrigger->pSync->type) {
         pCounter = (SyncCounter *) pTrigger->pSync;
 
+        /* index_type is only meaningful once the trigger was added */
+        if (pCur)
+            SyncIndexRemove(pCounter, pTrigger);
+
         if (IsSystemCounter(pCounter))
             SyncComputeBracketValues(pCounter);
     }
@@ -194,10 +205,20 @@ SyncAddTriggerToSyncObject(SyncTrigger * pTrigger)
         return Success;
 
     /* don't do anything if it's already there */
-    for (pCur = pTrigger->pSync->pTriglist; pCur; pCur = pCur->next) {
-        if (pCur->pTrigger == pTrigger)
+    if (SYNC_COUNTER == pTrigger->pSync->type) {
+        if (pTrigger->index_type >= 0 &&
+            pTrigger->index_type < SYNC_NUM_TEST_TYPES &&
+            SyncIndexFind((SyncCounter *) pTrigger->pSync,
+                          pTrigger->index_type, pTrigger->index_value,
+                          pTrigger) >= 0)
             return Success;
     }
+    else {
+        for (pCur = pTrigger->pSync->pTriglist; pCur; pCur = pCur->next) {
+            if (pCur->pTrigger == pTrigger)
+                return Success;
+        }
+    }
 
     if (!(pCur = malloc(sizeof(SyncTriggerList))))
         return BadAlloc;
@@ -209,6 +230,12 @@ SyncAddTriggerToSyncObject(SyncTrigger * pTrigger)
     if (SYNC_COUNTER == pTrigger->pSync->type) {
         pCounter = (SyncCounter *) pTrigger->pSync;
 
+        if (!SyncIndexInsert(pCounter, pTrigger)) {
+            pTrigger->pSync->pTriglist = pCur->next;
+            free(pCur);
+            return BadAlloc;
+        }
+
         if (IsSystemCounter(pCounter))
             SyncComputeBracketValues(pCounter);
     }
@@ -310,6 +337,198 @@ SyncCheckTriggerFence(SyncTrigger * pTrigger, int64_t unused)
     return (pFence == NULL || pFence->funcs.CheckTriggered(pFence));
 }
 
+/*  Counter triggers are also kept in one array per kind of test, sorted
+ *  by test value, so that a counter change only looks at the triggers
+ *  whose test value lies between the old and the new counter value, and
+ *  system counter brackets come out of a binary search.  The kind is
+ *  taken from CheckTrigger, since that is what decides whether the
+ *  trigger fires.
+ */
+static int
+SyncTriggerIndexType(SyncTrigger * pTrigger)
+{
+    if (pTrigger->CheckTrigger == SyncCheckTriggerPositiveTransition)
+        return XSyncPositiveTransition;
+    if (pTrigger->CheckTrigger == SyncCheckTriggerNegativeTransition)
+        return XSyncNegativeTransition;
+    if (pTrigger->CheckTrigger == SyncCheckTriggerPositiveComparison)
+        return XSyncPositiveComparison;
+    if (pTrigger->CheckTrigger == SyncCheckTriggerNegativeComparison)
+        return XSyncNegativeComparison;
+    return -1;
+}
+
+/* Position of the first trigger with a test value >= value, or > value
+ * if after is set.
+ */
+static int
+SyncIndexSearch(SyncTriggerIndex * pIndex, int64_t value, Bool after)
+{
+    int lo = 0, hi = pIndex->num;
+
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        int64_t test_value = pIndex->triggers[mid]->index_value;
+
+        if (test_value < value || (after && test_value == value))
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return lo;
+}
+
+static int
+SyncIndexFind(SyncCounter * pCounter, int type, int64_t value,
+              SyncTrigger * pTrigger)
+{
+    SyncTriggerIndex *pIndex = &pCounter->index[type];
+    int i;
+
+    for (i = SyncIndexSearch(pIndex, value, FALSE);
+         i < pIndex->num && pIndex->triggers[i]->index_value == value; i++) {
+        if (pIndex->triggers[i] == pTrigger)
+            return i;
+    }
+
+    return -1;
+}
+
+static Bool
+SyncIndexInsert(SyncCounter * pCounter, SyncTrigger * pTrigger)
+{
+    int type = SyncTriggerIndexType(pTrigger);
+    SyncTriggerIndex *pIndex;
+    int i;
+
+    pTrigger->index_type = -1;
+    if (type < 0)
+        return TRUE;
+
+    pIndex = &pCounter->index[type];
+    if (pIndex->num == pIndex->size) {
+        int size = pIndex->size ? pIndex->size * 2 : 8;
+        SyncTrigger **triggers = reallocarray(pIndex->triggers, size,
+                                              sizeof(SyncTrigger *));
+
+        if (!triggers)
+            return FALSE;
+
+        pIndex->triggers = triggers;
+        pIndex->size = size;
+    }
+
+    pTrigger->index_type = type;
+    pTrigger->index_value = pTrigger->test_value;
+
+    i = SyncIndexSearch(pIndex, pTrigger->index_value, TRUE);
+    memmove(&pIndex->triggers[i + 1], &pIndex->triggers[i],
+            (pIndex->num - i) * sizeof(SyncTrigger *));
+    pIndex->triggers[i] = pTrigger;
+    pIndex->num++;
+
+    return TRUE;
+}
+
+static void
+SyncIndexRemove(SyncCounter * pCounter, SyncTrigger * pTrigger)
+{
+    SyncTriggerIndex *pIndex;
+    int i;
+
+    if (pTrigger->index_type < 0)
+        return;
+
+    pIndex = &pCounter->index[pTrigger->index_type];
+    i = SyncIndexFind(pCounter, pTrigger->index_type, pTrigger->index_value,
+                      pTrigger);
+    if (i >= 0) {
+        pIndex->num--;
+        memmove(&pIndex->triggers[i], &pIndex->triggers[i + 1],
+                (pIndex->num - i) * sizeof(SyncTrigger *));
+    }
+
+    pTrigger->index_type = -1;
+}
+
+/* Move a counter trigger whose test changed to its new place.  Staying
+ * within the same array never needs memory, so this only fails when the
+ * kind of test changed.
+ */
+static Bool
+SyncIndexUpdate(SyncTrigger * pTrigger)
+{
+    SyncCounter *pCounter;
+
+    if (!pTrigger->pSync || SYNC_COUNTER != pTrigger->pSync->type ||
+        pTrigger->index_type < 0)
+        return TRUE;
+
+    if (pTrigger->index_type == SyncTriggerIndexType(pTrigger) &&
+        pTrigger->index_value == pTrigger->test_value)
+        return TRUE;
+
+    pCounter = (SyncCounter *) pTrigger->pSync;
+    SyncIndexRemove(pCounter, pTrigger);
+    return SyncIndexInsert(pCounter, pTrigger);
+}
+
+/* Ranges of the index arrays holding the triggers that may have become
+ * true after the counter changed from oldval to its current value.
+ */
+static void
+SyncIndexCandidates(SyncCounter * pCounter, int64_t oldval,
+                    int *start, int *end)
+{
+    SyncTriggerIndex *pIndex = pCounter->index;
+    int64_t newval = pCounter->value;
+    int type;
+
+    /* value >= test_value */
+    type = XSyncPositiveComparison;
+    start[type] = 0;
+    end[type] = SyncIndexSearch(&pIndex[type], newval, TRUE);
+
+    /* value <= test_value */
+    type = XSyncNegativeComparison;
+    start[type] = SyncIndexSearch(&pIndex[type], newval, FALSE);
+    end[type] = pIndex[type].num;
+
+    /* oldval < test_value <= value */
+    type = XSyncPositiveTransition;
+    start[type] = SyncIndexSearch(&pIndex[type], oldval, TRUE);
+    end[type] = max(start[type], SyncIndexSearch(&pIndex[type], newval, TRUE));
+
+    /* value <= test_value < oldval */
+    type = XSyncNegativeTransition;
+    start[type] = SyncIndexSearch(&pIndex[type], newval, FALSE);
+    end[type] = max(start[type], SyncIndexSearch(&pIndex[type], oldval, FALSE));
+}
+
+/* Whether any trigger on the counter is true for a change from oldval to
+ * the current value, without firing it.
+ */
+static Bool
+SyncCheckAnyTrigger(SyncCounter * pCounter, int64_t oldval)
+{
+    int start[SYNC_NUM_TEST_TYPES], end[SYNC_NUM_TEST_TYPES];
+    int type, i;
+
+    SyncIndexCandidates(pCounter, oldval, start, end);
+
+    for (type = 0; type < SYNC_NUM_TEST_TYPES; type++) {
+        for (i = start[type]; i < end[type]; i++) {
+            SyncTrigger *pTrigger = pCounter->index[type].triggers[i];
+
+            if ((*pTrigger->CheckTrigger) (pTrigger, oldval))
+                return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
 static int
 SyncInitTrigger(ClientPtr client, SyncTrigger * pTrigger, XID syncObject,
                 RESTYPE resType, Mask changes)
@@ -332,6 +551,7 @@ SyncInitTrigger(ClientPtr client, SyncTrigger * pTrigger, XID syncObject,
         if (pSync != pTrigger->pSync) { /* new counter for trigger */
             SyncDeleteTriggerFromSyncObject(pTrigger);
             pTrigger->pSync = pSync;
+            pTrigger->index_type = -1;
             newSyncObject = TRUE;
         }
     }
@@ -388,16 +608,19 @@ SyncInitTrigger(ClientPtr client, SyncTrigger * pTrigger, XID syncObject,
             pTrigger->test_value = pTrigger->wait_value;
         else {                  /* relative */
             Bool overflow;
+            int64_t test_value;
 
             if (pCounter == NULL)
                 return BadMatch;
 
-            overflow = checked_int64_add(&pTrigger->test_value,
+            overflow = checked_int64_add(&test_value,
                                          pCounter->value, pTrigger->wait_value);
             if (overflow) {
                 client->errorValue = pTrigger->wait_value >> 32;
+                SyncIndexUpdate(pTrigger);
                 return BadValue;
             }
+            pTrigger->test_value = test_value;
         }
     }
 
@@ -408,8 +631,11 @@ SyncInitTrigger(ClientPtr client, SyncTrigger * pTrigger, XID syncObject,
         if ((rc = SyncAddTriggerToSyncObject(pTrigger)) != Success)
             return rc;
     }
-    else if (pCounter && IsSystemCounter(pCounter)) {
-        SyncComputeBracketValues(pCounter);
+    else if (pCounter) {
+        if (!SyncIndexUpdate(pTrigger))
+            return BadAlloc;
+        if (IsSystemCounter(pCounter))
+            SyncComputeBracketValues(pCounter);
     }
 
     return Success;
@@ -710,16 +936,69 @@ SyncUpdateCounter(SyncCounter *pCounter, int64_t newval)
 void
 SyncChangeCounter(SyncCounter * pCounter, int64_t newval)
 {
-    SyncTriggerList *ptl, *pnext;
+    struct {
+        SyncTrigger *pTrigger;
+        int64_t value;
+        int type;
+    } stack_candidates[32], *candidates = stack_candidates;
+    int start[SYNC_NUM_TEST_TYPES], end[SYNC_NUM_TEST_TYPES];
+    int type, i, num = 0;
     int64_t oldval;
 
     oldval = SyncUpdateCounter(pCounter, newval);
 
-    /* run through triggers to see if any become true */
-    for (ptl = pCounter->sync.pTriglist; ptl; ptl = pnext) {
-        pnext = ptl->next;
-        if ((*ptl->pTrigger->CheckTrigger) (ptl->pTrigger, oldval))
-            (*ptl->pTrigger->TriggerFired) (ptl->pTrigger);
+    SyncIndexCandidates(pCounter, oldval, start, end);
+    for (type = 0; type < SYNC_NUM_TEST_TYPES; type++)
+        num += end[type] - start[type];
+
+    if (num > ARRAY_SIZE(stack_candidates))
+        candidates = xallocarray(num, sizeof(*candidates));
+
+    if (!candidates) {
+        SyncTriggerList *ptl, *pnext;
+
+        /* run through all triggers to see if any become true */
+        for (ptl = pCounter->sync.pTriglist; ptl; ptl = pnext) {
+            pnext = ptl->next;
+            if ((*ptl->pTrigger->CheckTrigger) (ptl->pTrigger, oldval))
+                (*ptl->pTrigger->TriggerFired) (ptl->pTrigger);
+        }
+        for (ptl = pCounter->sync.pTriglist; ptl; ptl = ptl->next)
+            SyncIndexUpdate(ptl->pTrigger);
+    }
+    else {
+        /* Firing a trigger may free others (awaits go away as a whole) or
+         * move the fired one (alarms), so take a snapshot of the candidates
+         * first and make sure each is still indexed before looking at it.
+         */
+        num = 0;
+        for (type = 0; type < SYNC_NUM_TEST_TYPES; type++) {
+            for (i = start[type]; i < end[type]; i++) {
+                candidates[num].pTrigger = pCounter->index[type].triggers[i];
+                candidates[num].value =
+                    candidates[num].pTrigger->index_value;
+                candidates[num].type = type;
+                num++;
+            }
+        }
+
+        for (i = 0; i < num; i++) {
+            SyncTrigger *pTrigger = candidates[i].pTrigger;
+
+            if (SyncIndexFind(pCounter, candidates[i].type,
+                              candidates[i].value, pTrigger) < 0)
+                continue;
+
+            if ((*pTrigger->CheckTrigger) (pTrigger, oldval)) {
+                (*pTrigger->TriggerFired) (pTrigger);
+                if (SyncIndexFind(pCounter, candidates[i].type,
+                                  candidates[i].value, pTrigger) >= 0)
+                    SyncIndexUpdate(pTrigger);
+            }
+        }
+
+        if (candidates != stack_candidates)
+            free(candidates);
     }
 
     if (IsSystemCounter(pCounter)) {
@@ -961,6 +1240,7 @@ SyncCreateCounter(ClientPtr client, XSyncCounter id, int64_t initialvalue)
 
     pCounter->value = initialvalue;
     pCounter->pSysCounterInfo = NULL;
+    memset(pCounter->index, 0, sizeof(pCounter->index));
 
     pCounter->sync.initialized = TRUE;
 
@@ -1015,15 +1295,34 @@ SyncDestroySystemCounter(void *pSysCounter)
     FreeResource(pCounter->sync.id, RT_NONE);
 }
 
+static void
+SyncBracketCandidates(SyncTriggerIndex * pIndex, int less_end,
+                      int greater_start, SysCounterInfo * psci,
+                      int64_t **ppnewltval, int64_t **ppnewgtval)
+{
+    if (less_end > 0 &&
+        pIndex->triggers[less_end - 1]->index_value > psci->bracket_less) {
+        psci->bracket_less = pIndex->triggers[less_end - 1]->index_value;
+        *ppnewltval = &psci->bracket_less;
+    }
+
+    if (greater_start < pIndex->num &&
+        pIndex->triggers[greater_start]->index_value < psci->bracket_greater) {
+        psci->bracket_greater = pIndex->triggers[greater_start]->index_value;
+        *ppnewgtval = &psci->bracket_greater;
+    }
+}
+
 static void
 SyncComputeBracketValues(SyncCounter * pCounter)
 {
-    SyncTriggerList *pCur;
-    SyncTrigger *pTrigger;
+    SyncTriggerIndex *pIndex;
     SysCounterInfo *psci;
     int64_t *pnewgtval = NULL;
     int64_t *pnewltval = NULL;
+    int64_t value;
     SyncCounterType ct;
+    int lt, gt;
 
     if (!pCounter)
         return;
@@ -1036,73 +1335,39 @@ SyncComputeBracketValues(SyncCounter * pCounter)
     psci->bracket_greater = LLONG_MAX;
     psci->bracket_less = LLONG_MIN;
 
-    for (pCur = pCounter->sync.pTriglist; pCur; pCur = pCur->next) {
-        pTrigger = pCur->pTrigger;
+    value = pCounter->value;
 
-        if (pTrigger->test_type == XSyncPositiveComparison &&
-            ct != XSyncCounterNeverIncreases) {
-            if (pCounter->value < pTrigger->test_value &&
-                pTrigger->test_value < psci->bracket_greater) {
-                psci->bracket_greater = pTrigger->test_value;
-                pnewgtval = &psci->bracket_greater;
-            }
-            else if (pCounter->value > pTrigger->test_value &&
-                     pTrigger->test_value > psci->bracket_less) {
-                    psci->bracket_less = pTrigger->test_value;
-                    pnewltval = &psci->bracket_less;
-            }
-        }
-        else if (pTrigger->test_type == XSyncNegativeComparison &&
-                 ct != XSyncCounterNeverDecreases) {
-            if (pCounter->value > pTrigger->test_value &&
-                pTrigger->test_value > psci->bracket_less) {
-                psci->bracket_less = pTrigger->test_value;
-                pnewltval = &psci->bracket_less;
-            }
-            else if (pCounter->value < pTrigger->test_value &&
-                     pTrigger->test_value < psci->bracket_greater) {
-                    psci->bracket_greater = pTrigger->test_value;
-                    pnewgtval = &psci->bracket_greater;
-            }
-        }
-        else if (pTrigger->test_type == XSyncNegativeTransition &&
-                 ct != XSyncCounterNeverIncreases) {
-            if (pCounter->value >= pTrigger->test_value &&
-                pTrigger->test_value > psci->bracket_less) {
-                    /*
-                     * If the value is exactly equal to our threshold, we want one
-                     * more event in the negative direction to ensure we pick up
-                     * when the value is less than this threshold.
-                     */
-                    psci->bracket_less = pTrigger->test_value;
-                    pnewltval = &psci->bracket_less;
-            }
-            else if (pCounter->value < pTrigger->test_value &&
-                     pTrigger->test_value < psci->bracket_greater) {
-                    psci->bracket_greater = pTrigger->test_value;
-                    pnewgtval = &psci->bracket_greater;
-            }
-        }
-        else if (pTrigger->test_type == XSyncPositiveTransition &&
-                 ct != XSyncCounterNeverDecreases) {
-            if (pCounter->value <= pTrigger->test_value &&
-                pTrigger->test_value < psci->bracket_greater) {
-                    /*
-                     * If the value is exactly equal to our threshold, we
-                     * want one more event in the positive direction to
-                     * ensure we pick up when the value *exceeds* this
-                     * threshold.
-                     */
-                    psci->bracket_greater = pTrigger->test_value;
-                    pnewgtval = &psci->bracket_greater;
-            }
-            else if (pCounter->value > pTrigger->test_value &&
-                     pTrigger->test_value > psci->bracket_less) {
-                    psci->bracket_less = pTrigger->test_value;
-                    pnewltval = &psci->bracket_less;
-            }
-        }
-    }                           /* end for each trigger */
+    if (ct != XSyncCounterNeverIncreases) {
+        /* Comparisons bracket from either side, unless right on the value */
+        pIndex = &pCounter->index[XSyncPositiveComparison];
+        lt = SyncIndexSearch(pIndex, value, FALSE);
+        gt = SyncIndexSearch(pIndex, value, TRUE);
+        SyncBracketCandidates(pIndex, lt, gt, psci, &pnewltval, &pnewgtval);
+
+        /*
+         * If the value is exactly equal to a negative transition threshold,
+         * we want one more event in the negative direction to ensure we
+         * pick up when the value is less than this threshold.
+         */
+        pIndex = &pCounter->index[XSyncNegativeTransition];
+        gt = SyncIndexSearch(pIndex, value, TRUE);
+        SyncBracketCandidates(pIndex, gt, gt, psci, &pnewltval, &pnewgtval);
+    }
+
+    if (ct != XSyncCounterNeverDecreases) {
+        pIndex = &pCounter->index[XSyncNegativeComparison];
+        lt = SyncIndexSearch(pIndex, value, FALSE);
+        gt = SyncIndexSearch(pIndex, value, TRUE);
+        SyncBracketCandidates(pIndex, lt, gt, psci, &pnewltval, &pnewgtval);
+
+        /*
+         * Likewise for positive transitions, to ensure we pick up when the
+         * value *exceeds* the threshold.
+         */
+        pIndex = &pCounter->index[XSyncPositiveTransition];
+        lt = SyncIndexSearch(pIndex, value, FALSE);
+        SyncBracketCandidates(pIndex, lt, lt, psci, &pnewltval, &pnewgtval);
+    }
 
     (*psci->BracketValues) ((void *) pCounter, pnewltval, pnewgtval);
 
@@ -1141,6 +1406,7 @@ static int
 FreeCounter(void *env, XID id)
 {
     SyncCounter *pCounter = (SyncCounter *) env;
+    int i;
 
     pCounter->sync.beingDestroyed = TRUE;
 
@@ -1153,6 +1419,8 @@ FreeCounter(void *env, XID id)
             pnext = ptl->next;
             free(ptl); /* destroy the trigger list as we go */
         }
+        for (i = 0; i < SYNC_NUM_TEST_TYPES; i++)
+            free(pCounter->index[i].triggers);
         if (IsSystemCounter(pCounter)) {
             xorg_list_del(&pCounter->pSysCounterInfo->entry);
             free(pCounter->pSysCounterInfo->name);
@@ -1335,6 +1603,7 @@ ProcSyncSetPriority(ClientPtr client)
 
     if (priorityclient->priority != stuff->priority) {
         priorityclient->priority = stuff->priority;
+        update_client_priority(priorityclient);
 
         /*  The following will force the server back into WaitForSomething
          *  so that the change in this client's priority is immediately
@@ -1748,8 +2017,10 @@ ProcSyncCreateAlarm(ClientPtr client)
 
         pCounter = (SyncCounter *) pTrigger->pSync;
 
-        if ((*pTrigger->CheckTrigger) (pTrigger, pCounter->value))
+        if ((*pTrigger->CheckTrigger) (pTrigger, pCounter->value)) {
             (*pTrigger->TriggerFired) (pTrigger);
+            SyncIndexUpdate(pTrigger);
+        }
     }
 
     return Success;
@@ -1795,6 +2066,7 @@ ProcSyncChangeAlarm(ClientPtr client)
     if (!pCounter ||
         (*pAlarm->trigger.CheckTrigger) (&pAlarm->trigger, pCounter->value)) {
         (*pAlarm->trigger.TriggerFired) (&pAlarm->trigger);
+        SyncIndexUpdate(&pAlarm->trigger);
     }
     return Success;
 }
@@ -2661,8 +2933,6 @@ IdleTimeBlockHandler(void *pCounter, void *wt)
     int64_t *less = priv->value_less;
     int64_t *greater = priv->value_greater;
     int64_t idle, old_idle;
-    SyncTriggerList *list = counter->sync.pTriglist;
-    SyncTrigger *trig;
 
     if (!less && !greater)
         return;
@@ -2684,18 +2954,13 @@ IdleTimeBlockHandler(void *pCounter, void *wt)
         /*
          * We've been idle for less than the threshold value, and someone
          * wants to know about that, but now we need to know whether they
-         * want level or edge trigger.  Check the trigger list against the
+         * want level or edge trigger.  Check the triggers against the
          * current idle time, and if any succeed, bomb out of select()
          * immediately so we can reschedule.
          */
 
-        for (list = counter->sync.pTriglist; list; list = list->next) {
-            trig = list->pTrigger;
-            if (trig->CheckTrigger(trig, old_idle)) {
-                AdjustWaitForDelay(wt, 0);
-                break;
-            }
-        }
+        if (SyncCheckAnyTrigger(counter, old_idle))
+            AdjustWaitForDelay(wt, 0);
         /*
          * We've been called exactly on the idle time, but we have a
          * NegativeTransition trigger which requires a transition from an
@@ -2716,15 +2981,8 @@ IdleTimeBlockHandler(void *pCounter, void *wt)
         if (idle < *greater) {
             AdjustWaitForDelay(wt, *greater - idle);
         }
-        else {
-            for (list = counter->sync.pTriglist; list;
-                 list = list->next) {
-                trig = list->pTrigger;
-                if (trig->CheckTrigger(trig, old_idle)) {
-                    AdjustWaitForDelay(wt, 0);
-                    break;
-                }
-            }
+        else if (SyncCheckAnyTrigger(counter, old_idle)) {
+            AdjustWaitForDelay(wt, 0);
         }
     }
 
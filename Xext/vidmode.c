@@ -1607,7 +1607,7 @@ ProcVidModeGetPermissions(ClientPtr client)
     if (stuff->screen >= screenInfo.numScreens)
         return BadValue;
 
-    if (VidModeAllowNonLocal || client->local) {
+    if (VidModeAllowNonLocal || GetClientLocal(client)) {
         rep.permissions |= XF86VM_WRITE_PERMISSION;
     }
     if (client->swapped) {
@@ -1674,7 +1674,7 @@ ProcVidModeDispatch(ClientPtr client)
     case X_XF86VidModeGetPermissions:
         return ProcVidModeGetPermissions(client);
     default:
-        if (VidModeAllowNonLocal || client->local) {
+        if (VidModeAllowNonLocal || GetClientLocal(client)) {
             switch (stuff->data) {
             case X_XF86VidModeAddModeLine:
                 return ProcVidModeAddModeLine(client);
@@ -2096,7 +2096,7 @@ SProcVidModeDispatch(ClientPtr client)
     case X_XF86VidModeGetPermissions:
         return SProcVidModeGetPermissions(client);
     default:
-        if (VidModeAllowNonLocal || client->local) {
+        if (VidModeAllowNonLocal || GetClientLocal(client)) {
             switch (stuff->data) {
             case X_XF86VidModeAddModeLine:
                 return SProcVidModeAddModeLine(client);
@@ -69,6 +69,9 @@ typedef struct PointerBarrierClient *PointerBarrierClientPtr;
 
 struct PointerBarrierDevice {
     struct xorg_list entry;
+    /* entry in the screen's list of barriers hit, valid while hit is TRUE */
+    struct xorg_list hit_entry;
+    PointerBarrierClientPtr barrier;
     int deviceid;
     Time last_timestamp;
     int barrier_event_id;
@@ -93,13 +96,16 @@ struct PointerBarrierClient {
 
 typedef struct _BarrierScreen {
     struct xorg_list barriers;
+    struct PointerBarrierIndex vertical;
+    struct PointerBarrierIndex horizontal;
+    struct xorg_list hit;       /* PointerBarrierDevices with hit set */
 } BarrierScreenRec, *BarrierScreenPtr;
 
 #define GetBarrierScreen(s) ((BarrierScreenPtr)dixLookupPrivate(&(s)->devPrivates, BarrierScreenPrivateKey))
 #define GetBarrierScreenIfSet(s) GetBarrierScreen(s)
 #define SetBarrierScreen(s,p) dixSetPrivate(&(s)->devPrivates, BarrierScreenPrivateKey, p)
 
-static struct PointerBarrierDevice *AllocBarrierDevice(void)
+static struct PointerBarrierDevice *AllocBarrierDevice(PointerBarrierClientPtr c)
 {
     struct PointerBarrierDevice *pbd = NULL;
 
@@ -107,12 +113,14 @@ static struct PointerBarrierDevice *AllocBarrierDevice(void)
     if (!pbd)
         return NULL;
 
+    pbd->barrier = c;
     pbd->deviceid = -1; /* must be set by caller */
     pbd->barrier_event_id = 1;
     pbd->release_event_id = 0;
     pbd->hit = FALSE;
     pbd->seen = FALSE;
     xorg_list_init(&pbd->entry);
+    xorg_list_init(&pbd->hit_entry);
 
     return pbd;
 }
@@ -152,6 +160,92 @@ barrier_is_vertical(const struct PointerBarrier *barrier)
     return barrier->x1 == barrier->x2;
 }
 
+/**
+ * @return The coordinate a barrier is sorted by in a PointerBarrierIndex,
+ * x for vertical barriers and y for horizontal barriers.
+ */
+int
+barrier_index_position(const struct PointerBarrier *barrier)
+{
+    return barrier_is_vertical(barrier) ? barrier->x1 : barrier->y1;
+}
+
+/**
+ * @return The index of the first barrier at or after position.
+ */
+int
+barrier_index_lower_bound(const struct PointerBarrierIndex *index,
+                          int position)
+{
+    int lo = 0, hi = index->num;
+
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+
+        if (barrier_index_position(index->barriers[mid]) < position)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return lo;
+}
+
+/**
+ * Add the barrier to the index, keeping it sorted.
+ *
+ * @return FALSE if the index could not be grown.
+ */
+BOOL
+barrier_index_insert(struct PointerBarrierIndex *index,
+                     struct PointerBarrier *barrier)
+{
+    int pos;
+
+    if (index->num == index->size) {
+        int size = index->size ? index->size * 2 : 16;
+        struct PointerBarrier **barriers;
+
+        barriers = reallocarray(index->barriers, size, sizeof(*barriers));
+        if (!barriers)
+            return FALSE;
+        index->barriers = barriers;
+        index->size = size;
+    }
+
+    pos = barrier_index_lower_bound(index, barrier_index_position(barrier));
+    memmove(&index->barriers[pos + 1], &index->barriers[pos],
+            (index->num - pos) * sizeof(*index->barriers));
+    index->barriers[pos] = barrier;
+    index->num++;
+
+    return TRUE;
+}
+
+void
+barrier_index_remove(struct PointerBarrierIndex *index,
+                     struct PointerBarrier *barrier)
+{
+    int pos = barrier_index_lower_bound(index, barrier_index_position(barrier));
+
+    for (; pos < index->num; pos++) {
+        if (index->barriers[pos] == barrier) {
+            index->num--;
+            memmove(&index->barriers[pos], &index->barriers[pos + 1],
+                    (index->num - pos) * sizeof(*index->barriers));
+            return;
+        }
+    }
+
+    BUG_WARN_MSG(1, "barrier %p not in index\n", barrier);
+}
+
+static struct PointerBarrierIndex *
+GetBarrierIndex(BarrierScreenPtr cs, const struct PointerBarrier *barrier)
+{
+    return barrier_is_vertical(barrier) ? &cs->vertical : &cs->horizontal;
+}
+
 /**
  * @return The set of barrier movement directions the movement vector
  * x1/y1 → x2/y2 represents.
@@ -314,49 +408,98 @@ barrier_blocks_device(struct PointerBarrierClient *client,
 }
 
 /**
- * Find the nearest barrier client that is blocking movement from x1/y1 to x2/y2.
+ * Update nearest/min_distance with the barriers in index that block the
+ * movement from x1/y1 to x2/y2 and are closer to the movement origin.
  *
- * @param dir Only barriers blocking movement in direction dir are checked
- * @param x1 X start coordinate of movement vector
- * @param y1 Y start coordinate of movement vector
- * @param x2 X end coordinate of movement vector
- * @param y2 Y end coordinate of movement vector
- * @return The barrier nearest to the movement origin that blocks this movement.
+ * @param lo Smallest position on the index axis to check
+ * @param hi Largest position on the index axis to check
  */
-static struct PointerBarrierClient *
-barrier_find_nearest(BarrierScreenPtr cs, DeviceIntPtr dev,
-                     int dir,
-                     int x1, int y1, int x2, int y2)
+static void
+barrier_find_nearest_in_index(const struct PointerBarrierIndex *index,
+                              int dir, int x1, int y1, int x2, int y2,
+                              int lo, int hi,
+                              BarrierFilterProc filter, void *closure,
+                              struct PointerBarrier **nearest,
+                              double *min_distance)
 {
-    struct PointerBarrierClient *c, *nearest = NULL;
-    double min_distance = INT_MAX;      /* can't get higher than that in X anyway */
+    int i;
 
-    xorg_list_for_each_entry(c, &cs->barriers, entry) {
-        struct PointerBarrier *b = &c->barrier;
-        struct PointerBarrierDevice *pbd;
+    /* only barriers between the start and end point on the axis they
+     * block can intersect the movement */
+    for (i = barrier_index_lower_bound(index, lo); i < index->num; i++) {
+        struct PointerBarrier *b = index->barriers[i];
         double distance;
 
-        pbd = GetBarrierDevice(c, dev->id);
-        if (pbd->seen)
-            continue;
+        if (barrier_index_position(b) > hi)
+            break;
 
         if (!barrier_is_blocking_direction(b, dir))
             continue;
 
-        if (!barrier_blocks_device(c, dev))
+        if (filter && !(*filter) (b, closure))
             continue;
 
         if (barrier_is_blocking(b, x1, y1, x2, y2, &distance)) {
-            if (min_distance > distance) {
-                min_distance = distance;
-                nearest = c;
+            if (*min_distance > distance) {
+                *min_distance = distance;
+                *nearest = b;
             }
         }
     }
+}
+
+/**
+ * Find the nearest barrier that is blocking movement from x1/y1 to x2/y2.
+ *
+ * @param vertical The vertical barriers to check
+ * @param horizontal The horizontal barriers to check
+ * @param dir Only barriers blocking movement in direction dir are checked
+ * @param x1 X start coordinate of movement vector
+ * @param y1 Y start coordinate of movement vector
+ * @param x2 X end coordinate of movement vector
+ * @param y2 Y end coordinate of movement vector
+ * @param filter If not NULL, barriers it returns FALSE for are skipped
+ * @return The barrier nearest to the movement origin that blocks this movement.
+ */
+struct PointerBarrier *
+barrier_find_nearest(const struct PointerBarrierIndex *vertical,
+                     const struct PointerBarrierIndex *horizontal,
+                     int dir, int x1, int y1, int x2, int y2,
+                     BarrierFilterProc filter, void *closure)
+{
+    struct PointerBarrier *nearest = NULL;
+    double min_distance = INT_MAX;      /* can't get higher than that in X anyway */
+
+    /* vertical barriers can only block movement along the x axis and
+     * vice versa */
+    if (dir & (BarrierPositiveX | BarrierNegativeX))
+        barrier_find_nearest_in_index(vertical, dir, x1, y1, x2, y2,
+                                      min(x1, x2), max(x1, x2),
+                                      filter, closure,
+                                      &nearest, &min_distance);
+    if (dir & (BarrierPositiveY | BarrierNegativeY))
+        barrier_find_nearest_in_index(horizontal, dir, x1, y1, x2, y2,
+                                      min(y1, y2), max(y1, y2),
+                                      filter, closure,
+                                      &nearest, &min_distance);
 
     return nearest;
 }
 
+/* Skip barriers already hit in this motion and those not applying to dev */
+static BOOL
+barrier_applies_to_device(struct PointerBarrier *barrier, void *closure)
+{
+    struct PointerBarrierClient *c =
+        container_of(barrier, struct PointerBarrierClient, barrier);
+    DeviceIntPtr dev = closure;
+
+    if (GetBarrierDevice(c, dev->id)->seen)
+        return FALSE;
+
+    return barrier_blocks_device(c, dev);
+}
+
 /**
  * Clamp to the given barrier given the movement direction specified in dir.
  *
@@ -411,6 +554,7 @@ input_constrain_cursor(DeviceIntPtr dev, ScreenPtr screen,
     };
     InternalEvent *barrier_events = events;
     DeviceIntPtr master;
+    struct PointerBarrierDevice *pbd, *tmp;
 
     if (nevents)
         *nevents = 0;
@@ -436,17 +580,21 @@ input_constrain_cursor(DeviceIntPtr dev, ScreenPtr screen,
 
     while (dir != 0) {
         int new_sequence;
-        struct PointerBarrierDevice *pbd;
 
-        c = barrier_find_nearest(cs, master, dir, current_x, current_y, x, y);
-        if (!c)
+        nearest = barrier_find_nearest(&cs->vertical, &cs->horizontal, dir,
+                                       current_x, current_y, x, y,
+                                       barrier_applies_to_device, master);
+        if (!nearest)
             break;
 
-        nearest = &c->barrier;
+        c = container_of(nearest, struct PointerBarrierClient, barrier);
 
         pbd = GetBarrierDevice(c, master->id);
         new_sequence = !pbd->hit;
 
+        if (!pbd->hit)
+            xorg_list_add(&pbd->hit_entry, &cs->hit);
+
         pbd->seen = TRUE;
         pbd->hit = TRUE;
 
@@ -480,19 +628,21 @@ input_constrain_cursor(DeviceIntPtr dev, ScreenPtr screen,
         *nevents += 1;
     }
 
-    xorg_list_for_each_entry(c, &cs->barriers, entry) {
-        struct PointerBarrierDevice *pbd;
+    /* barriers seen above are all hit, so only those need to be checked */
+    xorg_list_for_each_entry_safe(pbd, tmp, &cs->hit, hit_entry) {
         int flags = 0;
 
-        pbd = GetBarrierDevice(c, master->id);
-        pbd->seen = FALSE;
-        if (!pbd->hit)
+        if (pbd->deviceid != master->id)
             continue;
 
+        c = pbd->barrier;
+        pbd->seen = FALSE;
+
         if (barrier_inside_hit_box(&c->barrier, x, y))
             continue;
 
         pbd->hit = FALSE;
+        xorg_list_del(&pbd->hit_entry);
 
         ev.type = ET_BarrierLeave;
 
@@ -604,7 +754,7 @@ CreatePointerBarrierClient(ClientPtr client,
         if (dev->type != MASTER_POINTER)
             continue;
 
-        pbd = AllocBarrierDevice();
+        pbd = AllocBarrierDevice(ret);
         if (!pbd) {
             err = BadAlloc;
             goto error;
@@ -629,6 +779,12 @@ CreatePointerBarrierClient(ClientPtr client,
     if (barrier_is_vertical(&ret->barrier))
         ret->barrier.directions &= ~(BarrierPositiveY | BarrierNegativeY);
     input_lock();
+    if (!barrier_index_insert(GetBarrierIndex(cs, &ret->barrier),
+                              &ret->barrier)) {
+        input_unlock();
+        err = BadAlloc;
+        goto error;
+    }
     xorg_list_add(&ret->entry, &cs->barriers);
     input_unlock();
 
@@ -645,6 +801,7 @@ static int
 BarrierFreeBarrier(void *data, XID id)
 {
     struct PointerBarrierClient *c;
+    struct PointerBarrierDevice *pbd;
     Time ms = GetTimeInMillis();
     DeviceIntPtr dev = NULL;
     ScreenPtr screen;
@@ -653,7 +810,6 @@ BarrierFreeBarrier(void *data, XID id)
     screen = c->screen;
 
     for (dev = inputInfo.devices; dev; dev = dev->next) {
-        struct PointerBarrierDevice *pbd;
         int root_x, root_y;
         BarrierEvent ev = {
             .header = ET_Internal,
@@ -695,6 +851,11 @@ BarrierFreeBarrier(void *data, XID id)
 
     input_lock();
     xorg_list_del(&c->entry);
+    barrier_index_remove(GetBarrierIndex(GetBarrierScreen(screen),
+                                         &c->barrier),
+                         &c->barrier);
+    xorg_list_for_each_entry(pbd, &c->per_device, entry)
+        xorg_list_del(&pbd->hit_entry);
     input_unlock();
 
     FreePointerBarrierClient(c);
@@ -712,7 +873,7 @@ static void add_master_func(void *res, XID id, void *devid)
     barrier = container_of(b, struct PointerBarrierClient, barrier);
 
 
-    pbd = AllocBarrierDevice();
+    pbd = AllocBarrierDevice(barrier);
     pbd->deviceid = *deviceid;
 
     input_lock();
@@ -762,6 +923,7 @@ static void remove_master_func(void *res, XID id, void *devid)
 
     input_lock();
     xorg_list_del(&pbd->entry);
+    xorg_list_del(&pbd->hit_entry);
     input_unlock();
     free(pbd);
 }
@@ -927,6 +1089,7 @@ XIBarrierInit(void)
         if (!cs)
             return FALSE;
         xorg_list_init(&cs->barriers);
+        xorg_list_init(&cs->hit);
         SetBarrierScreen(pScreen, cs);
     }
 
@@ -943,6 +1106,8 @@ XIBarrierReset(void)
     for (i = 0; i < screenInfo.numScreens; i++) {
         ScreenPtr pScreen = screenInfo.screens[i];
         BarrierScreenPtr cs = GetBarrierScreen(pScreen);
+        free(cs->vertical.barriers);
+        free(cs->horizontal.barriers);
         free(cs);
         SetBarrierScreen(pScreen, NULL);
     }
@@ -26,6 +26,35 @@ void
 barrier_clamp_to_barrier(struct PointerBarrier *barrier, int dir, int *x,
                              int *y);
 
+/* Barriers of one orientation, sorted by their position on the axis they
+ * block (x for vertical barriers, y for horizontal barriers) */
+struct PointerBarrierIndex {
+    struct PointerBarrier **barriers;
+    int num;
+    int size;
+};
+
+int
+barrier_index_position(const struct PointerBarrier *barrier);
+int
+barrier_index_lower_bound(const struct PointerBarrierIndex *index,
+                          int position);
+BOOL
+barrier_index_insert(struct PointerBarrierIndex *index,
+                     struct PointerBarrier *barrier);
+void
+barrier_index_remove(struct PointerBarrierIndex *index,
+                     struct PointerBarrier *barrier);
+
+typedef BOOL (*BarrierFilterProc) (struct PointerBarrier *barrier,
+                                   void *closure);
+
+struct PointerBarrier *
+barrier_find_nearest(const struct PointerBarrierIndex *vertical,
+                     const struct PointerBarrierIndex *horizontal,
+                     int dir, int x1, int y1, int x2, int y2,
+                     BarrierFilterProc filter, void *closure);
+
 #include <xfixesint.h>
 
 int
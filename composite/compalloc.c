@@ -310,7 +310,7 @@ compFreeClientWindow(WindowPtr pWin, XID id)
 
     if (pPixmap) {
         compRestoreWindow(pWin, pPixmap);
-        (*pScreen->DestroyPixmap) (pPixmap);
+        compPoolReleasePixmap(pScreen, pPixmap);
     }
 }
 
@@ -398,6 +398,9 @@ compRedirectSubwindows(ClientPtr pClient, WindowPtr pWin, int update)
      */
     ccw->next = csw->clients;
     csw->clients = ccw;
+    /* Compositing managers are scheduled in the latency class */
+    if (update == CompositeRedirectManual && !pWin->parent)
+        SetClientLatencyClass(pClient, LATENCY_CLASS_POLICY);
     if (!AddResource(ccw->id, CompositeClientSubwindowsType, pWin))
         return BadAlloc;
     if (ccw->update == CompositeRedirectManual) {
@@ -436,6 +439,8 @@ compFreeClientSubwindows(WindowPtr pWin, XID id)
                  * critical output
                  */
                 DamageExtSetCritical(pClient, FALSE);
+                if (!pWin->parent)
+                    UnsetClientLatencyClass(pClient, LATENCY_CLASS_POLICY);
                 csw->update = CompositeRedirectAutomatic;
                 pWin->inhibitBGPaint = FALSE;
                 if (pWin->mapped)
@@ -527,21 +532,162 @@ compUnredirectOneSubwindow(WindowPtr pParent, WindowPtr pWin)
     return Success;
 }
 
+static int
+compPoolBucket(int w, int h, int depth)
+{
+    return ((w * 31 + h) ^ depth) & (COMP_POOL_BUCKETS - 1);
+}
+
+void
+compPoolInit(CompScreenPtr cs)
+{
+    int i;
+
+    xorg_list_init(&cs->poolLru);
+    for (i = 0; i < COMP_POOL_BUCKETS; i++)
+        xorg_list_init(&cs->poolBuckets[i]);
+    cs->poolBytes = 0;
+    cs->poolHits = 0;
+    cs->poolMisses = 0;
+    cs->poolReportTime = GetTimeInMillis();
+}
+
+/*
+ * Pooled pixmaps are server-owned resources, which makes them show up
+ * in X-Resource queries against the server client.  Freeing the
+ * resource drops the entry from the pool and destroys the pixmap
+ * unless it has been claimed for reuse.
+ */
+int
+compPoolFreePixmap(void *value, XID id)
+{
+    CompPooledPixmapPtr pp = value;
+    CompScreenPtr cs = GetCompScreen(pp->pScreen);
+
+    xorg_list_del(&pp->lru);
+    xorg_list_del(&pp->bucket);
+    if (cs)
+        cs->poolBytes -= pp->bytes;
+    if (pp->pPixmap)
+        (*pp->pScreen->DestroyPixmap) (pp->pPixmap);
+    free(pp);
+    return Success;
+}
+
+void
+compPoolFini(ScreenPtr pScreen)
+{
+    CompScreenPtr cs = GetCompScreen(pScreen);
+    CompPooledPixmapPtr pp, tmp;
+
+    xorg_list_for_each_entry_safe(pp, tmp, &cs->poolLru, lru)
+        FreeResource(pp->id, RT_NONE);
+
+    LogMessageVerb(X_INFO, 3, "Composite: screen %d backing pixmap pool "
+                   "%lu hits, %lu misses\n", pScreen->myNum,
+                   cs->poolHits, cs->poolMisses);
+}
+
+/* Log the pool counters at verbosity 5, at most this often */
+#define COMP_POOL_REPORT_INTERVAL       (10 * MILLI_PER_SECOND)
+
+static void
+compPoolReportStats(ScreenPtr pScreen, CompScreenPtr cs)
+{
+    CARD32 now = GetTimeInMillis();
+
+    if (now - cs->poolReportTime < COMP_POOL_REPORT_INTERVAL)
+        return;
+
+    LogMessageVerb(X_INFO, 5, "Composite: screen %d backing pixmap pool "
+                   "%lu hits, %lu misses, %lu KB pooled\n", pScreen->myNum,
+                   cs->poolHits, cs->poolMisses, cs->poolBytes / 1024);
+    cs->poolReportTime = now;
+}
+
 static PixmapPtr
-compNewPixmap(WindowPtr pWin, int x, int y, int w, int h)
+compPoolGetPixmap(ScreenPtr pScreen, int w, int h, int depth)
 {
-    ScreenPtr pScreen = pWin->drawable.pScreen;
-    WindowPtr pParent = pWin->parent;
-    PixmapPtr pPixmap;
+    CompScreenPtr cs = GetCompScreen(pScreen);
+    CompPooledPixmapPtr pp;
+
+    xorg_list_for_each_entry(pp, &cs->poolBuckets[compPoolBucket(w, h, depth)],
+                             bucket) {
+        PixmapPtr pPixmap = pp->pPixmap;
+
+        if (pPixmap->drawable.width == w && pPixmap->drawable.height == h &&
+            pPixmap->drawable.depth == depth) {
+            pp->pPixmap = NULL;
+            FreeResource(pp->id, RT_NONE);
+            cs->poolHits++;
+            compPoolReportStats(pScreen, cs);
+            return pPixmap;
+        }
+    }
 
-    pPixmap = (*pScreen->CreatePixmap) (pScreen, w, h, pWin->drawable.depth,
-                                        CREATE_PIXMAP_USAGE_BACKING_PIXMAP);
+    cs->poolMisses++;
+    compPoolReportStats(pScreen, cs);
+    return (*pScreen->CreatePixmap) (pScreen, w, h, depth,
+                                     CREATE_PIXMAP_USAGE_BACKING_PIXMAP);
+}
 
-    if (!pPixmap)
-        return 0;
+/*
+ * Hand a backing pixmap back once composite is done with it.  Pixmaps
+ * still referenced elsewhere (e.g. named by a compositor) are simply
+ * unreferenced; the rest are kept for reuse while the pool is under
+ * budget.
+ */
+void
+compPoolReleasePixmap(ScreenPtr pScreen, PixmapPtr pPixmap)
+{
+    CompScreenPtr cs = GetCompScreen(pScreen);
+    CompPooledPixmapPtr pp;
+    unsigned long bytes;
 
-    pPixmap->screen_x = x;
-    pPixmap->screen_y = y;
+    bytes = (unsigned long) pPixmap->drawable.width *
+        pPixmap->drawable.height * (pPixmap->drawable.bitsPerPixel >> 3);
+
+    if (!cs || dispatchException || !CompositePooledPixmapType ||
+        pPixmap->refcnt != 1 ||
+        pPixmap->usage_hint != CREATE_PIXMAP_USAGE_BACKING_PIXMAP ||
+        bytes > COMP_POOL_BUDGET / 4 ||
+        !(pp = malloc(sizeof(CompPooledPixmapRec)))) {
+        (*pScreen->DestroyPixmap) (pPixmap);
+        return;
+    }
+
+    pp->pScreen = pScreen;
+    pp->pPixmap = pPixmap;
+    pp->id = FakeClientID(0);
+    pp->bytes = bytes;
+    xorg_list_add(&pp->lru, &cs->poolLru);
+    xorg_list_add(&pp->bucket,
+                  &cs->poolBuckets[compPoolBucket(pPixmap->drawable.width,
+                                                  pPixmap->drawable.height,
+                                                  pPixmap->drawable.depth)]);
+    cs->poolBytes += bytes;
+
+    /* on failure the pixmap has already been destroyed */
+    if (!AddResource(pp->id, CompositePooledPixmapType, pp))
+        return;
+
+    while (cs->poolBytes > COMP_POOL_BUDGET) {
+        pp = xorg_list_last_entry(&cs->poolLru, CompPooledPixmapRec, lru);
+        FreeResource(pp->id, RT_NONE);
+    }
+}
+
+/*
+ * Fill the screen-space rectangle (x, y, w, h) of pPixmap with what is
+ * currently visible in the parent
+ */
+static void
+compCopyFromParent(WindowPtr pWin, PixmapPtr pPixmap, int x, int y, int w, int h)
+{
+    ScreenPtr pScreen = pWin->drawable.pScreen;
+    WindowPtr pParent = pWin->parent;
+    int dst_x = x - pPixmap->screen_x;
+    int dst_y = y - pPixmap->screen_y;
 
     if (pParent->drawable.depth == pWin->drawable.depth) {
         GCPtr pGC = GetScratchGC(pWin->drawable.depth, pScreen);
@@ -556,7 +702,8 @@ compNewPixmap(WindowPtr pWin, int x, int y, int w, int h)
                                    &pPixmap->drawable,
                                    pGC,
                                    x - pParent->drawable.x,
-                                   y - pParent->drawable.y, w, h, 0, 0);
+                                   y - pParent->drawable.y, w, h,
+                                   dst_x, dst_y);
             FreeScratchGC(pGC);
         }
     }
@@ -585,13 +732,86 @@ compNewPixmap(WindowPtr pWin, int x, int y, int w, int h)
                              NULL,
                              pDstPicture,
                              x - pParent->drawable.x,
-                             y - pParent->drawable.y, 0, 0, 0, 0, w, h);
+                             y - pParent->drawable.y, 0, 0,
+                             dst_x, dst_y, w, h);
         }
         if (pSrcPicture)
             FreePicture(pSrcPicture, 0);
         if (pDstPicture)
             FreePicture(pDstPicture, 0);
     }
+}
+
+/*
+ * Allocate a new backing pixmap at (x, y, w, h).  When pOld is given
+ * (a resize), the part of the new pixmap that pOld already covers is
+ * copied straight from pOld and only the newly uncovered strips are
+ * fetched from the parent; otherwise the whole pixmap is filled from
+ * the parent.
+ */
+static PixmapPtr
+compNewPixmap(WindowPtr pWin, int x, int y, int w, int h, PixmapPtr pOld)
+{
+    ScreenPtr pScreen = pWin->drawable.pScreen;
+    PixmapPtr pPixmap;
+    BoxRec newBox, oldBox;
+    RegionRec fetch, reuse;
+    BoxPtr pBox;
+    int nBox;
+
+    pPixmap = compPoolGetPixmap(pScreen, w, h, pWin->drawable.depth);
+
+    if (!pPixmap)
+        return 0;
+
+    pPixmap->screen_x = x;
+    pPixmap->screen_y = y;
+
+    if (!pOld || pOld->drawable.depth != pPixmap->drawable.depth) {
+        compCopyFromParent(pWin, pPixmap, x, y, w, h);
+        return pPixmap;
+    }
+
+    newBox.x1 = x;
+    newBox.y1 = y;
+    newBox.x2 = x + w;
+    newBox.y2 = y + h;
+    oldBox.x1 = pOld->screen_x;
+    oldBox.y1 = pOld->screen_y;
+    oldBox.x2 = pOld->screen_x + pOld->drawable.width;
+    oldBox.y2 = pOld->screen_y + pOld->drawable.height;
+
+    RegionInit(&fetch, &newBox, 1);
+    RegionInit(&reuse, &oldBox, 1);
+    RegionIntersect(&reuse, &reuse, &fetch);
+    RegionSubtract(&fetch, &fetch, &reuse);
+
+    if (RegionNotEmpty(&reuse)) {
+        GCPtr pGC = GetScratchGC(pWin->drawable.depth, pScreen);
+
+        if (pGC) {
+            pBox = RegionExtents(&reuse);
+            ValidateGC(&pPixmap->drawable, pGC);
+            (*pGC->ops->CopyArea) (&pOld->drawable, &pPixmap->drawable, pGC,
+                                   pBox->x1 - oldBox.x1, pBox->y1 - oldBox.y1,
+                                   pBox->x2 - pBox->x1, pBox->y2 - pBox->y1,
+                                   pBox->x1 - x, pBox->y1 - y);
+            FreeScratchGC(pGC);
+        }
+        else
+            RegionReset(&fetch, &newBox);
+    }
+
+    pBox = RegionRects(&fetch);
+    nBox = RegionNumRects(&fetch);
+    while (nBox--) {
+        compCopyFromParent(pWin, pPixmap, pBox->x1, pBox->y1,
+                           pBox->x2 - pBox->x1, pBox->y2 - pBox->y1);
+        pBox++;
+    }
+
+    RegionUninit(&reuse);
+    RegionUninit(&fetch);
     return pPixmap;
 }
 
@@ -603,7 +823,7 @@ compAllocPixmap(WindowPtr pWin)
     int y = pWin->drawable.y - bw;
     int w = pWin->drawable.width + (bw << 1);
     int h = pWin->drawable.height + (bw << 1);
-    PixmapPtr pPixmap = compNewPixmap(pWin, x, y, w, h);
+    PixmapPtr pPixmap = compNewPixmap(pWin, x, y, w, h, NULL);
     CompWindowPtr cw = GetCompWindow(pWin);
 
     if (!pPixmap)
@@ -650,6 +870,7 @@ compSetParentPixmap(WindowPtr pWin)
      * parent exposed area; regions beyond the parent cause crashes
      */
     RegionCopy(&pWin->borderClip, &cw->borderClip);
+    InvalidateNotClippedByChildren(pWin);
     pParentPixmap = (*pScreen->GetWindowPixmap) (pWin->parent);
     pWin->redirectDraw = RedirectDrawNone;
     compSetPixmap(pWin, pParentPixmap, pWin->borderWidth);
@@ -680,7 +901,7 @@ compReallocPixmap(WindowPtr pWin, int draw_x, int draw_y,
     pix_w = w + (bw << 1);
     pix_h = h + (bw << 1);
     if (pix_w != pOld->drawable.width || pix_h != pOld->drawable.height) {
-        pNew = compNewPixmap(pWin, pix_x, pix_y, pix_w, pix_h);
+        pNew = compNewPixmap(pWin, pix_x, pix_y, pix_w, pix_h, pOld);
         if (!pNew)
             return FALSE;
         cw->pOldPixmap = pOld;
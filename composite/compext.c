@@ -57,6 +57,7 @@ static DevPrivateKeyRec CompositeClientPrivateKeyRec;
 RESTYPE CompositeClientWindowType;
 RESTYPE CompositeClientSubwindowsType;
 RESTYPE CompositeClientOverlayType;
+RESTYPE CompositePooledPixmapType;
 
 typedef struct _CompositeClient {
     int major_version;
@@ -501,6 +502,16 @@ SProcCompositeDispatch(ClientPtr client)
         return BadRequest;
 }
 
+static void
+GetCompositePooledPixmapBytes(void *value, XID id, ResourceSizePtr size)
+{
+    CompPooledPixmapPtr pp = value;
+
+    size->resourceSize = pp->bytes;
+    size->pixmapRefSize = pp->bytes;
+    size->refCnt = 1;
+}
+
 /** @see GetDefaultBytes */
 static SizeType coreGetWindowBytes;
 
@@ -569,6 +580,13 @@ CompositeExtensionInit(void)
     if (!CompositeClientOverlayType)
         return;
 
+    CompositePooledPixmapType = CreateNewResourceType
+        (compPoolFreePixmap, "CompositePooledPixmap");
+    if (!CompositePooledPixmapType)
+        return;
+    SetResourceTypeSizeFunc(CompositePooledPixmapType,
+                            GetCompositePooledPixmapBytes);
+
     if (!dixRegisterPrivateKey(&CompositeClientPrivateKeyRec, PRIVATE_CLIENT,
                                sizeof(CompositeClientRec)))
         return;
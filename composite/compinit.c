@@ -58,6 +58,7 @@ compCloseScreen(ScreenPtr pScreen)
     CompScreenPtr cs = GetCompScreen(pScreen);
     Bool ret;
 
+    compPoolFini(pScreen);
     free(cs->alternateVisuals);
 
     pScreen->CloseScreen = cs->CloseScreen;
@@ -351,6 +352,8 @@ compScreenInit(ScreenPtr pScreen)
 
     cs->pendingScreenUpdate = FALSE;
 
+    compPoolInit(cs);
+
     cs->numAlternateVisuals = 0;
     cs->alternateVisuals = NULL;
     cs->numImplicitRedirectExceptions = 0;
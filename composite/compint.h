@@ -72,6 +72,7 @@
 #include "xfixes.h"
 #include <X11/extensions/compositeproto.h>
 #include "compositeext.h"
+#include "list.h"
 #include <assert.h>
 
 /*
@@ -110,6 +111,26 @@ typedef struct _CompSubwindows {
 #define COMP_INCLUDE_RGB24_VISUAL 0
 #endif
 
+/*
+ * Released backing pixmaps are kept per screen, hashed by size, for
+ * reuse by the next window of the same geometry.  The pool is trimmed
+ * least recently released first to stay under COMP_POOL_BUDGET bytes.
+ */
+#ifndef COMP_POOL_BUDGET
+#define COMP_POOL_BUDGET	(32 << 20)
+#endif
+
+#define COMP_POOL_BUCKETS	16
+
+typedef struct _CompPooledPixmap {
+    struct xorg_list lru;
+    struct xorg_list bucket;
+    ScreenPtr pScreen;
+    PixmapPtr pPixmap;
+    XID id;
+    unsigned long bytes;
+} CompPooledPixmapRec, *CompPooledPixmapPtr;
+
 typedef struct _CompOverlayClientRec *CompOverlayClientPtr;
 
 typedef struct _CompOverlayClientRec {
@@ -169,6 +190,15 @@ typedef struct _CompScreen {
     CompOverlayClientPtr pOverlayClients;
 
     SourceValidateProcPtr SourceValidate;
+
+    struct xorg_list poolLru;   /* most recently released first */
+    struct xorg_list poolBuckets[COMP_POOL_BUCKETS];
+    unsigned long poolBytes;
+    /* Not exposed through X-Resource, which has no request that could
+     * carry them; logged by compPoolReportStats and compPoolFini */
+    unsigned long poolHits;
+    unsigned long poolMisses;
+    CARD32 poolReportTime;
 } CompScreenRec, *CompScreenPtr;
 
 extern DevPrivateKeyRec CompScreenPrivateKeyRec;
@@ -192,6 +222,7 @@ extern DevPrivateKeyRec CompSubwindowsPrivateKeyRec;
 
 extern RESTYPE CompositeClientSubwindowsType;
 extern RESTYPE CompositeClientOverlayType;
+extern RESTYPE CompositePooledPixmapType;
 
 /*
  * compalloc.c
@@ -237,6 +268,18 @@ compReallocPixmap(WindowPtr pWin, int x, int y,
 
 void compMarkAncestors(WindowPtr pWin);
 
+void
+ compPoolInit(CompScreenPtr cs);
+
+void
+ compPoolFini(ScreenPtr pScreen);
+
+void
+ compPoolReleasePixmap(ScreenPtr pScreen, PixmapPtr pPixmap);
+
+int
+ compPoolFreePixmap(void *value, XID id);
+
 /*
  * compinit.c
  */
@@ -178,7 +178,7 @@ compCheckRedirect(WindowPtr pWin)
 
             compSetParentPixmap(pWin);
             compRestoreWindow(pWin, pPixmap);
-            (*pScreen->DestroyPixmap) (pPixmap);
+            compPoolReleasePixmap(pScreen, pPixmap);
         }
     }
     else if (should) {
@@ -382,7 +382,7 @@ compFreeOldPixmap(WindowPtr pWin)
         CompWindowPtr cw = GetCompWindow(pWin);
 
         if (cw->pOldPixmap) {
-            (*pScreen->DestroyPixmap) (cw->pOldPixmap);
+            compPoolReleasePixmap(pScreen, cw->pOldPixmap);
             cw->pOldPixmap = NullPixmap;
         }
     }
@@ -615,7 +615,7 @@ compDestroyWindow(WindowPtr pWin)
         PixmapPtr pPixmap = (*pScreen->GetWindowPixmap) (pWin);
 
         compSetParentPixmap(pWin);
-        (*pScreen->DestroyPixmap) (pPixmap);
+        compPoolReleasePixmap(pScreen, pPixmap);
     }
     ret = (*pScreen->DestroyWindow) (pWin);
     cs->DestroyWindow = pScreen->DestroyWindow;
@@ -663,28 +663,16 @@ compGetRedirectBorderClip(WindowPtr pWin)
 }
 
 static void
-compWindowUpdateAutomatic(WindowPtr pWin)
+compWindowUpdateAutomatic(WindowPtr pWin, PicturePtr *ppDstPicture)
 {
     CompWindowPtr cw = GetCompWindow(pWin);
     ScreenPtr pScreen = pWin->drawable.pScreen;
     WindowPtr pParent = pWin->parent;
     PixmapPtr pSrcPixmap = (*pScreen->GetWindowPixmap) (pWin);
     PictFormatPtr pSrcFormat = PictureWindowFormat(pWin);
-    PictFormatPtr pDstFormat = PictureWindowFormat(pWin->parent);
     int error;
     RegionPtr pRegion = DamageRegion(cw->damage);
-    PicturePtr pSrcPicture = CreatePicture(0, &pSrcPixmap->drawable,
-                                           pSrcFormat,
-                                           0, 0,
-                                           serverClient,
-                                           &error);
-    XID subwindowMode = IncludeInferiors;
-    PicturePtr pDstPicture = CreatePicture(0, &pParent->drawable,
-                                           pDstFormat,
-                                           CPSubwindowMode,
-                                           &subwindowMode,
-                                           serverClient,
-                                           &error);
+    PicturePtr pSrcPicture;
 
     /*
      * First move the region from window to screen coordinates
@@ -696,27 +684,61 @@ compWindowUpdateAutomatic(WindowPtr pWin)
      */
     RegionIntersect(pRegion, pRegion, &cw->borderClip);
 
+    /*
+     * The border clip already excludes siblings stacked above us, so
+     * if nothing is left the damage is fully occluded; skip the paint
+     * and the picture setup entirely
+     */
+    if (!RegionNotEmpty(pRegion))
+        goto done;
+
     /*
      * Now translate from screen to dest coordinates
      */
     RegionTranslate(pRegion, -pParent->drawable.x, -pParent->drawable.y);
 
+    /*
+     * The destination picture is shared by all the siblings painted
+     * in one pass; it is created on first use and freed by
+     * compPaintChildrenToWindow
+     */
+    if (!*ppDstPicture) {
+        XID subwindowMode = IncludeInferiors;
+
+        *ppDstPicture = CreatePicture(0, &pParent->drawable,
+                                      PictureWindowFormat(pParent),
+                                      CPSubwindowMode,
+                                      &subwindowMode,
+                                      serverClient,
+                                      &error);
+        if (!*ppDstPicture)
+            goto done;
+    }
+
+    pSrcPicture = CreatePicture(0, &pSrcPixmap->drawable,
+                                pSrcFormat,
+                                0, 0,
+                                serverClient,
+                                &error);
+    if (!pSrcPicture)
+        goto done;
+
     /*
      * Clip the picture
      */
-    SetPictureClipRegion(pDstPicture, 0, 0, pRegion);
+    SetPictureClipRegion(*ppDstPicture, 0, 0, pRegion);
 
     /*
      * And paint
      */
-    CompositePicture(PictOpSrc, pSrcPicture, 0, pDstPicture,
+    CompositePicture(PictOpSrc, pSrcPicture, 0, *ppDstPicture,
                      0, 0,      /* src_x, src_y */
                      0, 0,      /* msk_x, msk_y */
                      pSrcPixmap->screen_x - pParent->drawable.x,
                      pSrcPixmap->screen_y - pParent->drawable.y,
                      pSrcPixmap->drawable.width, pSrcPixmap->drawable.height);
     FreePicture(pSrcPicture, 0);
-    FreePicture(pDstPicture, 0);
+ done:
     /*
      * Empty the damage region.  This has the nice effect of
      * rendering the translations above harmless
@@ -725,7 +747,7 @@ compWindowUpdateAutomatic(WindowPtr pWin)
 }
 
 static void
-compPaintWindowToParent(WindowPtr pWin)
+compPaintWindowToParent(WindowPtr pWin, PicturePtr *ppDstPicture)
 {
     compPaintChildrenToWindow(pWin);
 
@@ -733,7 +755,7 @@ compPaintWindowToParent(WindowPtr pWin)
         CompWindowPtr cw = GetCompWindow(pWin);
 
         if (cw->damaged) {
-            compWindowUpdateAutomatic(pWin);
+            compWindowUpdateAutomatic(pWin, ppDstPicture);
             cw->damaged = FALSE;
         }
     }
@@ -743,12 +765,22 @@ void
 compPaintChildrenToWindow(WindowPtr pWin)
 {
     WindowPtr pChild;
+    PicturePtr pDstPicture = NULL;
 
     if (!pWin->damagedDescendants)
         return;
 
+    /*
+     * Automatically redirected siblings clip each other, so the
+     * clipped damage painted for each child below never overlaps;
+     * every parent pixel is written at most once per pass and only
+     * the destination picture is worth sharing
+     */
     for (pChild = pWin->lastChild; pChild; pChild = pChild->prevSib)
-        compPaintWindowToParent(pChild);
+        compPaintWindowToParent(pChild, &pDstPicture);
+
+    if (pDstPicture)
+        FreePicture(pDstPicture, 0);
 
     pWin->damagedDescendants = FALSE;
 }
@@ -29,6 +29,7 @@
 #include "damagestr.h"
 #include "protocol-versions.h"
 #include "extinit.h"
+#include "opaque.h"
 
 #ifdef PANORAMIX
 #include "panoramiX.h"
@@ -52,6 +53,9 @@ static DevPrivateKeyRec DamageClientPrivateKeyRec;
 
 #define DamageClientPrivateKey (&DamageClientPrivateKeyRec)
 
+/* Damage objects with coalesced damage waiting for the block handler */
+static struct xorg_list DamageExtPendingList;
+
 static void
 DamageNoteCritical(ClientPtr pClient)
 {
@@ -61,6 +65,7 @@ DamageNoteCritical(ClientPtr pClient)
     if (pDamageClient->critical > 0) {
         SetCriticalOutputPending();
         pClient->smart_priority = SMART_MAX_PRIORITY;
+        update_client_priority(pClient);
     }
 }
 
@@ -132,11 +137,78 @@ DamageExtNotify(DamageExtPtr pDamageExt, BoxPtr pBoxes, int nBoxes)
     DamageNoteCritical(pClient);
 }
 
+/*
+ * With -damagecoalesce, damage is accumulated per damage object and sent
+ * from the block handler, once per dispatch cycle. Damage objects with more
+ * than DamageCoalesceRects pending rectangles report the bounding box.
+ */
+static void
+DamageExtQueue(DamageExtPtr pDamageExt, RegionPtr pRegion)
+{
+    RegionPtr pPending = &pDamageExt->pending;
+
+    if (pDamageExt->level == DamageReportBoundingBox) {
+        RegionRec extents;
+
+        RegionInit(&extents, RegionExtents(pRegion), 1);
+        RegionUnion(pPending, pPending, &extents);
+        RegionUninit(&extents);
+    }
+    else
+        RegionUnion(pPending, pPending, pRegion);
+
+    if (RegionNumRects(pPending) > DamageCoalesceRects) {
+        BoxRec box = *RegionExtents(pPending);
+
+        RegionReset(pPending, &box);
+    }
+
+    if (xorg_list_is_empty(&pDamageExt->pendingEntry))
+        xorg_list_append(&pDamageExt->pendingEntry, &DamageExtPendingList);
+}
+
+static void
+DamageExtDropPending(DamageExtPtr pDamageExt)
+{
+    xorg_list_del(&pDamageExt->pendingEntry);
+    RegionEmpty(&pDamageExt->pending);
+}
+
+static void
+DamageExtFlushPending(DamageExtPtr pDamageExt)
+{
+    RegionPtr pPending = &pDamageExt->pending;
+
+    if (RegionNotEmpty(pPending)) {
+        if (pDamageExt->level == DamageReportBoundingBox)
+            DamageExtNotify(pDamageExt, RegionExtents(pPending), 1);
+        else
+            DamageExtNotify(pDamageExt, RegionRects(pPending),
+                            RegionNumRects(pPending));
+    }
+    DamageExtDropPending(pDamageExt);
+}
+
+static void
+DamageExtBlockHandler(void *data, void *timeout)
+{
+    DamageExtPtr pDamageExt, tmp;
+
+    xorg_list_for_each_entry_safe(pDamageExt, tmp, &DamageExtPendingList,
+                                  pendingEntry)
+        DamageExtFlushPending(pDamageExt);
+}
+
 static void
 DamageExtReport(DamagePtr pDamage, RegionPtr pRegion, void *closure)
 {
     DamageExtPtr pDamageExt = closure;
 
+    if (DamageCoalesceRects > 0 && pDamageExt->level != DamageReportNonEmpty) {
+        DamageExtQueue(pDamageExt, pRegion);
+        return;
+    }
+
     switch (pDamageExt->level) {
     case DamageReportRawRegion:
     case DamageReportDeltaRegion:
@@ -150,6 +222,7 @@ DamageExtReport(DamagePtr pDamage, RegionPtr pRegion, void *closure)
         DamageExtNotify(pDamageExt, NullBox, 0);
         break;
     case DamageReportNone:
+    case DamageReportTiled:
         break;
     }
 }
@@ -159,6 +232,7 @@ DamageExtDestroy(DamagePtr pDamage, void *closure)
 {
     DamageExtPtr pDamageExt = closure;
 
+    DamageExtDropPending(pDamageExt);
     pDamageExt->pDamage = 0;
     if (pDamageExt->id)
         FreeResource(pDamageExt->id, RT_NONE);
@@ -238,6 +312,8 @@ DamageExtCreate(DrawablePtr pDrawable, DamageReportLevel level,
     pDamageExt->pDrawable = pDrawable;
     pDamageExt->level = level;
     pDamageExt->pClient = client;
+    RegionNull(&pDamageExt->pending);
+    xorg_list_init(&pDamageExt->pendingEntry);
     pDamageExt->pDamage = DamageCreate(DamageExtReport, DamageExtDestroy, level,
                                        FALSE, pDrawable->pScreen, pDamageExt);
     if (!pDamageExt->pDamage) {
@@ -578,6 +654,8 @@ FreeDamageExt(void *value, XID did)
     if (pDamageExt->pDamage) {
         DamageDestroy(pDamageExt->pDamage);
     }
+    DamageExtDropPending(pDamageExt);
+    RegionUninit(&pDamageExt->pending);
     free(pDamageExt);
     return Success;
 }
@@ -737,6 +815,13 @@ DamageExtensionInit(void)
         (&DamageClientPrivateKeyRec, PRIVATE_CLIENT, sizeof(DamageClientRec)))
         return;
 
+    xorg_list_init(&DamageExtPendingList);
+    if (DamageCoalesceRects > 0 &&
+        !RegisterBlockAndWakeupHandlers(DamageExtBlockHandler,
+                                        (ServerWakeupHandlerProcPtr) NoopDDA,
+                                        NULL))
+        DamageCoalesceRects = 0;
+
     if ((extEntry = AddExtension(DAMAGE_NAME, XDamageNumberEvents,
                                  XDamageNumberErrors,
                                  ProcDamageDispatch, SProcDamageDispatch,
@@ -39,6 +39,7 @@
 #include "scrnintstr.h"
 #include "damage.h"
 #include "xfixes.h"
+#include "list.h"
 
 typedef struct _DamageClient {
     CARD32 major_version;
@@ -55,6 +56,8 @@ typedef struct _DamageExt {
     ClientPtr pClient;
     XID id;
     XID drawable;
+    RegionRec pending;          /* not yet sent, see -damagecoalesce */
+    struct xorg_list pendingEntry;
 } DamageExtRec, *DamageExtPtr;
 
 #define VERIFY_DAMAGEEXT(pDamageExt, rid, client, mode) { \
@@ -120,9 +120,13 @@ DeviceSetTransform(DeviceIntPtr dev, float *transform_data)
     scale.m[1][2] = dev->valuator->axes[1].min_value;
 
     /* transform */
+    dev->transform_is_identity = TRUE;
     for (y = 0; y < 3; y++)
-        for (x = 0; x < 3; x++)
+        for (x = 0; x < 3; x++) {
             transform.m[y][x] = *transform_data++;
+            if (transform.m[y][x] != (x == y ? 1.0 : 0.0))
+                dev->transform_is_identity = FALSE;
+        }
 
     pixman_f_transform_multiply(&dev->scale_and_transform, &scale, &transform);
 
@@ -133,6 +137,11 @@ DeviceSetTransform(DeviceIntPtr dev, float *transform_data)
 
     pixman_f_transform_multiply(&dev->scale_and_transform, &dev->scale_and_transform, &scale);
 
+    /* needed for every event that only updates one of the axes */
+    if (!pixman_f_transform_invert(&dev->inverse_scale_and_transform,
+                                   &dev->scale_and_transform))
+        pixman_f_transform_init_identity(&dev->inverse_scale_and_transform);
+
     /* remove translation component for relative movements */
     dev->relative_transform = transform;
     dev->relative_transform.m[0][2] = 0;
@@ -317,6 +326,8 @@ AddInputDevice(ClientPtr client, DeviceProc deviceProc, Bool autoStart)
     dev->relative_transform.m[1][1] = 1.0;
     dev->relative_transform.m[2][2] = 1.0;
     dev->scale_and_transform = dev->relative_transform;
+    dev->inverse_scale_and_transform = dev->relative_transform;
+    dev->transform_is_identity = TRUE;
 
     XIChangeDeviceProperty(dev, XIGetKnownProperty(XI_PROP_TRANSFORM),
                            XIGetKnownProperty(XATOM_FLOAT), 32,
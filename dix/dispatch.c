@@ -250,7 +250,6 @@ long SmartScheduleMaxSlice = SMART_SCHEDULE_MAX_SLICE;
 long SmartScheduleTime;
 int SmartScheduleLatencyLimited = 0;
 static ClientPtr SmartLastClient;
-static int SmartLastIndex[SMART_MAX_PRIORITY - SMART_MIN_PRIORITY + 1];
 
 #ifdef SMART_DEBUG
 long SmartLastPrint;
@@ -258,22 +257,132 @@ long SmartLastPrint;
 
 void Dispatch(void);
 
-static struct xorg_list ready_clients;
+#define SMART_NUM_PRIORITIES (SMART_MAX_PRIORITY - SMART_MIN_PRIORITY + 1)
+
+/*
+ * Ready clients are queued by client->priority, then by smart_priority.
+ * Each distinct client->priority gets a RunQueue holding one FIFO per
+ * smart_priority, and a bitmask of which FIFOs may be non-empty, so
+ * picking the next client to run doesn't depend on how many are ready.
+ * The mask is cleaned lazily: bits are set on insertion and only cleared
+ * when a lookup finds the FIFO empty.
+ */
+typedef struct _RunQueue {
+    struct xorg_list link;      /* in run_queues, highest priority first */
+    int priority;
+    uint64_t ready;
+    struct xorg_list buckets[SMART_NUM_PRIORITIES];
+} RunQueueRec, *RunQueuePtr;
+
+static struct xorg_list run_queues;
+static RunQueueRec latency_run_queue;
+static RunQueueRec default_run_queue;
+static struct xorg_list latency_clients;
+static ClientPtr focus_latency_client;
+static long latency_check_tick;
 static struct xorg_list saved_ready_clients;
 struct xorg_list output_pending_clients;
 
+#define RUN_QUEUE_BIT(b)	((uint64_t) 1 << (b))
+
+static void
+init_run_queue(RunQueuePtr rq, int priority)
+{
+    int i;
+
+    rq->priority = priority;
+    rq->ready = 0;
+    for (i = 0; i < SMART_NUM_PRIORITIES; i++)
+        xorg_list_init(&rq->buckets[i]);
+}
+
 static void
 init_client_ready(void)
 {
-    xorg_list_init(&ready_clients);
+    xorg_list_init(&run_queues);
+    /* Latency class clients always come first */
+    init_run_queue(&latency_run_queue, 0);
+    xorg_list_append(&latency_run_queue.link, &run_queues);
+    init_run_queue(&default_run_queue, 0);
+    xorg_list_append(&default_run_queue.link, &run_queues);
+    xorg_list_init(&latency_clients);
+    focus_latency_client = NullClient;
     xorg_list_init(&saved_ready_clients);
     xorg_list_init(&output_pending_clients);
 }
 
+/* Highest non-empty bucket of rq, or -1 */
+static int
+run_queue_top(RunQueuePtr rq)
+{
+    while (rq->ready) {
+        int bucket = 63 - __builtin_clzll(rq->ready);
+
+        if (!xorg_list_is_empty(&rq->buckets[bucket]))
+            return bucket;
+        rq->ready &= ~RUN_QUEUE_BIT(bucket);
+    }
+    return -1;
+}
+
+static RunQueuePtr
+find_run_queue(int priority)
+{
+    RunQueuePtr rq, new;
+
+    xorg_list_for_each_entry(rq, &run_queues, link) {
+        if (rq == &latency_run_queue)
+            continue;
+        if (rq->priority == priority)
+            return rq;
+        if (rq->priority < priority)
+            break;
+    }
+
+    /* Better to run the client at the default priority than not at all */
+    new = malloc(sizeof(RunQueueRec));
+    if (!new)
+        return &default_run_queue;
+
+    init_run_queue(new, priority);
+    /* Insert ahead of the first lower priority queue */
+    xorg_list_append(&new->link, &rq->link);
+    return new;
+}
+
+/* In the latency class and within its budget */
+static inline Bool
+latency_class_active(ClientPtr client)
+{
+    return client->latency_class && !client->latency_throttled;
+}
+
+static void
+enqueue_client(ClientPtr client)
+{
+    RunQueuePtr rq;
+    int bucket = client->smart_priority - SMART_MIN_PRIORITY;
+
+    if (latency_class_active(client))
+        rq = &latency_run_queue;
+    else
+        rq = find_run_queue(client->priority);
+
+    xorg_list_append(&client->ready, &rq->buckets[bucket]);
+    rq->ready |= RUN_QUEUE_BIT(bucket);
+    client->run_queue = rq;
+}
+
 Bool
 clients_are_ready(void)
 {
-    return !xorg_list_is_empty(&ready_clients);
+    RunQueuePtr rq;
+
+    xorg_list_for_each_entry(rq, &run_queues, link) {
+        if (run_queue_top(rq) >= 0)
+            return TRUE;
+    }
+    return FALSE;
 }
 
 /* Client has requests queued or data on the network */
@@ -281,7 +390,7 @@ void
 mark_client_ready(ClientPtr client)
 {
     if (xorg_list_is_empty(&client->ready))
-        xorg_list_append(&client->ready, &ready_clients);
+        enqueue_client(client);
 }
 
 /*
@@ -299,17 +408,137 @@ void
 mark_client_not_ready(ClientPtr client)
 {
     xorg_list_del(&client->ready);
+    client->run_queue = NULL;
+    /* Idle again, so it may go back to the latency class */
+    client->latency_throttled = FALSE;
+}
+
+/* Client priority or smart_priority changed */
+void
+update_client_priority(ClientPtr client)
+{
+    if (client->run_queue) {
+        xorg_list_del(&client->ready);
+        enqueue_client(client);
+    }
+}
+
+static void
+latency_class_changed(ClientPtr client, int old)
+{
+    if (!old == !client->latency_class)
+        return;
+
+    if (client->latency_class)
+        xorg_list_append(&client->latency, &latency_clients);
+    else
+        xorg_list_del(&client->latency);
+    update_client_priority(client);
+}
+
+void
+SetClientLatencyClass(ClientPtr client, int reason)
+{
+    int old = client->latency_class;
+
+    if (client->clientGone || client == serverClient)
+        return;
+
+    if (reason & LATENCY_CLASS_GRAB)
+        client->latency_grabs++;
+    if (reason & LATENCY_CLASS_POLICY)
+        client->latency_policies++;
+    client->latency_class |= reason;
+    latency_class_changed(client, old);
+}
+
+void
+UnsetClientLatencyClass(ClientPtr client, int reason)
+{
+    int old = client->latency_class;
+
+    if ((reason & LATENCY_CLASS_GRAB) && client->latency_grabs) {
+        /* Still holding a grab on another device */
+        if (--client->latency_grabs)
+            reason &= ~LATENCY_CLASS_GRAB;
+    }
+    if ((reason & LATENCY_CLASS_POLICY) && client->latency_policies) {
+        /* Still managing, compositing or an input method elsewhere */
+        if (--client->latency_policies)
+            reason &= ~LATENCY_CLASS_POLICY;
+    }
+    client->latency_class &= ~reason;
+    latency_class_changed(client, old);
+}
+
+/* Client owning the window with the core keyboard focus, if any */
+void
+SetFocusLatencyClient(ClientPtr client)
+{
+    if (client == serverClient)
+        client = NullClient;
+    if (client == focus_latency_client)
+        return;
+
+    if (focus_latency_client)
+        UnsetClientLatencyClass(focus_latency_client, LATENCY_CLASS_FOCUS);
+    focus_latency_client = client;
+    if (client)
+        SetClientLatencyClass(client, LATENCY_CLASS_FOCUS);
+}
+
+static void
+clear_client_latency_class(ClientPtr client)
+{
+    if (client == focus_latency_client)
+        focus_latency_client = NullClient;
+    if (client->latency_class)
+        xorg_list_del(&client->latency);
+    client->latency_class = 0;
+    client->latency_throttled = FALSE;
+    client->latency_grabs = 0;
+    client->latency_policies = 0;
+}
+
+/*
+ * Latency class clients preempt everybody else.  While another client is
+ * running, look for requests from them once per tick, and end the slice
+ * when one has something to do.  Throttled clients wait their turn.
+ */
+static Bool
+SmartSchedulePreempt(ClientPtr current)
+{
+    ClientPtr pClient;
+
+    if (latency_class_active(current) || xorg_list_is_empty(&latency_clients))
+        return FALSE;
+
+    if (SmartScheduleTime != latency_check_tick) {
+        latency_check_tick = SmartScheduleTime;
+        xorg_list_for_each_entry(pClient, &latency_clients, latency) {
+            if (!pClient->latency_throttled && !client_is_ready(pClient))
+                CheckClientInput(pClient);
+        }
+    }
+    return run_queue_top(&latency_run_queue) >= 0;
 }
 
 static void
 mark_client_grab(ClientPtr grab)
 {
+    RunQueuePtr rq;
     ClientPtr   client, tmp;
-
-    xorg_list_for_each_entry_safe(client, tmp, &ready_clients, ready) {
-        if (client != grab) {
-            xorg_list_del(&client->ready);
-            xorg_list_append(&client->ready, &saved_ready_clients);
+    int         i;
+
+    xorg_list_for_each_entry(rq, &run_queues, link) {
+        for (i = 0; i < SMART_NUM_PRIORITIES; i++) {
+            xorg_list_for_each_entry_safe(client, tmp, &rq->buckets[i], ready) {
+                if (client != grab) {
+                    xorg_list_del(&client->ready);
+                    xorg_list_append(&client->ready, &saved_ready_clients);
+                    client->run_queue = NULL;
+                }
+            }
         }
     }
 }
@@ -321,59 +550,83 @@ mark_client_ungrab(void)
 
     xorg_list_for_each_entry_safe(client, tmp, &saved_ready_clients, ready) {
         xorg_list_del(&client->ready);
-        xorg_list_append(&client->ready, &ready_clients);
+        enqueue_client(client);
+    }
+}
+
+/*
+ * Praise clients which haven't run in a while.  Each bucket is in
+ * round-robin order, so those idle the longest are at the front; walk
+ * from the top so a promoted client isn't looked at twice.
+ */
+static void
+SmartSchedulePraise(RunQueuePtr rq, long now, long idle)
+{
+    int bucket;
+
+    for (bucket = -1 - SMART_MIN_PRIORITY; bucket >= 0; bucket--) {
+        struct xorg_list *head = &rq->buckets[bucket];
+
+        if (!(rq->ready & RUN_QUEUE_BIT(bucket)))
+            continue;
+
+        while (!xorg_list_is_empty(head)) {
+            ClientPtr pClient = xorg_list_first_entry(head, ClientRec, ready);
+
+            if ((now - pClient->smart_stop_tick) < idle)
+                break;
+            if (pClient->smart_priority < 0)
+                pClient->smart_priority++;
+            update_client_priority(pClient);
+        }
     }
 }
 
 static ClientPtr
 SmartScheduleClient(void)
 {
-    ClientPtr pClient, best = NULL;
-    int bestRobin, robin;
+    RunQueuePtr rq, tmp;
+    ClientPtr best = NULL;
     long now = SmartScheduleTime;
     long idle;
-    int nready = 0;
+    Bool alone = FALSE;
+    int bucket;
 
-    bestRobin = 0;
     idle = 2 * SmartScheduleSlice;
 
-    xorg_list_for_each_entry(pClient, &ready_clients, ready) {
-        nready++;
+    xorg_list_for_each_entry(rq, &run_queues, link)
+        SmartSchedulePraise(rq, now, idle);
 
-        /* Praise clients which haven't run in a while */
-        if ((now - pClient->smart_stop_tick) >= idle) {
-            if (pClient->smart_priority < 0)
-                pClient->smart_priority++;
+    xorg_list_for_each_entry_safe(rq, tmp, &run_queues, link) {
+        bucket = run_queue_top(rq);
+        if (bucket < 0) {
+            if (rq != &default_run_queue && rq != &latency_run_queue) {
+                xorg_list_del(&rq->link);
+                free(rq);
+            }
+            continue;
         }
 
-        /* check priority to select best client */
-        robin =
-            (pClient->index -
-             SmartLastIndex[pClient->smart_priority -
-                            SMART_MIN_PRIORITY]) & 0xff;
-
-        /* pick the best client */
-        if (!best ||
-            pClient->priority > best->priority ||
-            (pClient->priority == best->priority &&
-             (pClient->smart_priority > best->smart_priority ||
-              (pClient->smart_priority == best->smart_priority && robin > bestRobin))))
-        {
-            best = pClient;
-            bestRobin = robin;
+        if (!best) {
+            /* Take the head of the bucket and move it to the back */
+            best = xorg_list_first_entry(&rq->buckets[bucket], ClientRec, ready);
+            xorg_list_del(&best->ready);
+            xorg_list_append(&best->ready, &rq->buckets[bucket]);
+            alone = (best->ready.next == best->ready.prev &&
+                     rq->ready == RUN_QUEUE_BIT(bucket));
+        }
+        else {
+            alone = FALSE;
+            break;
         }
-#ifdef SMART_DEBUG
-        if ((now - SmartLastPrint) >= 5000)
-            fprintf(stderr, " %2d: %3d", pClient->index, pClient->smart_priority);
-#endif
     }
 #ifdef SMART_DEBUG
     if ((now - SmartLastPrint) >= 5000) {
-        fprintf(stderr, " use %2d\n", best->index);
+        fprintf(stderr, "use %2d: %3d %3d\n", best->index,
+                best->priority, best->smart_priority);
         SmartLastPrint = now;
     }
 #endif
-    SmartLastIndex[best->smart_priority - SMART_MIN_PRIORITY] = best->index;
     /*
      * Set current client pointer
      */
@@ -384,7 +637,7 @@ SmartScheduleClient(void)
     /*
      * Adjust slice
      */
-    if (nready == 1 && SmartScheduleLatencyLimited == 0) {
+    if (alone && SmartScheduleLatencyLimited == 0) {
         /*
          * If it's been a long time since another client
          * has run, bump the slice up to get maximal
@@ -476,6 +729,7 @@ Dispatch(void)
     int result;
     ClientPtr client;
     long start_tick;
+    CARD64 start_time, trace_start = 0;
 
     nextFreeClientID = 1;
     nClients = 0;
@@ -503,6 +757,7 @@ Dispatch(void)
             isItTimeToYield = FALSE;
 
             start_tick = SmartScheduleTime;
+            start_time = GetTimeInMicros();
             while (!isItTimeToYield) {
                 if (InputCheckPending())
                     ProcessInputEvents();
@@ -511,11 +766,21 @@ Dispatch(void)
                 if ((SmartScheduleTime - start_tick) >= SmartScheduleSlice)
                 {
                     /* Penalize clients which consume ticks */
-                    if (client->smart_priority > SMART_MIN_PRIORITY)
+                    if (client->smart_priority > SMART_MIN_PRIORITY) {
                         client->smart_priority--;
+                        update_client_priority(client);
+                    }
+                    /* A slice is all the latency class gets at once */
+                    if (latency_class_active(client)) {
+                        client->latency_throttled = TRUE;
+                        update_client_priority(client);
+                    }
                     break;
                 }
 
+                if (SmartSchedulePreempt(client))
+                    break;
+
                 /* now, finally, deal with client requests */
                 result = ReadRequestFromClient(client);
                 if (result <= 0) {
@@ -541,6 +806,8 @@ Dispatch(void)
                                           client->index,
                                           client->requestBuffer);
 #endif
+                if (TraceActive)
+                    trace_start = GetTimeInMicros();
                 if (result > (maxBigRequestSize << 2))
                     result = BadLength;
                 else {
@@ -561,6 +828,8 @@ Dispatch(void)
                                          client->majorOp, client->sequence,
                                          client->index, result);
 #endif
+                if (TraceActive)
+                    TraceRequest(client, result, trace_start);
 
                 if (client->noClientException != Success) {
                     CloseDownClient(client);
@@ -574,8 +843,10 @@ Dispatch(void)
                 }
             }
             FlushAllOutput();
-            if (client == SmartLastClient)
+            if (client == SmartLastClient) {
                 client->smart_stop_tick = SmartScheduleTime;
+                client->smart_dispatch_time += GetTimeInMicros() - start_time;
+            }
         }
         dispatchException &= ~DE_PRIORITYCHANGE;
     }
@@ -3465,6 +3736,63 @@ ProcNoOperation(ClientPtr client)
     return Success;
 }
 
+/*
+ * Clients which connect and disconnect in quick succession would
+ * otherwise go through malloc for every ClientRec and its privates, so
+ * keep a few around.  A cached record is only reused while the client
+ * privates are still the size it was allocated for.
+ */
+#define CLIENT_CACHE_SIZE       16
+
+static ClientPtr client_cache[CLIENT_CACHE_SIZE];
+static int client_cache_count;
+static int client_cache_privates;
+
+static void
+FlushClientCache(void)
+{
+    while (client_cache_count)
+        free(client_cache[--client_cache_count]);
+}
+
+static ClientPtr
+AllocClientRec(void)
+{
+    ClientPtr client;
+    unsigned base;
+
+    if (client_cache_count &&
+        client_cache_privates != dixPrivatesSize(PRIVATE_CLIENT))
+        FlushClientCache();
+
+    if (!client_cache_count)
+        return dixAllocateObjectWithPrivates(ClientRec, PRIVATE_CLIENT);
+
+    client = client_cache[--client_cache_count];
+    base = (sizeof(ClientRec) + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+    memset(client, '\0', sizeof(ClientRec));
+    dixInitPrivates(client, (char *) client + base, PRIVATE_CLIENT);
+    return client;
+}
+
+static void
+FreeClientRec(ClientPtr client)
+{
+    int size = dixPrivatesSize(PRIVATE_CLIENT);
+
+    if (client_cache_count && client_cache_privates != size)
+        FlushClientCache();
+
+    if (client_cache_count == CLIENT_CACHE_SIZE) {
+        dixFreeObjectWithPrivates(client, PRIVATE_CLIENT);
+        return;
+    }
+
+    dixFiniPrivates(client, PRIVATE_CLIENT);
+    client_cache_privates = size;
+    client_cache[client_cache_count++] = client;
+}
+
 /**********************
  * CloseDownClient
  *
@@ -3517,6 +3845,16 @@ CloseDownClient(ClientPtr client)
         CloseDownConnection(client);
         output_pending_clear(client);
         mark_client_not_ready(client);
+        clear_client_latency_class(client);
+
+        if (client->smart_dispatch_time)
+            LogMessageVerb(X_INFO, 5,
+                           "client %d (%s): %llu ms spent in dispatch\n",
+                           client->index,
+                           GetClientCmdName(client) ? GetClientCmdName(client)
+                                                    : "unknown",
+                           (unsigned long long)
+                           (client->smart_dispatch_time / 1000));
 
         /* If the client made it to the Running stage, nClients has
          * been incremented on its behalf, so we need to decrement it
@@ -3554,7 +3892,7 @@ CloseDownClient(ClientPtr client)
             nextFreeClientID = client->index;
         clients[client->index] = NullClient;
         SmartLastClient = NullClient;
-        dixFreeObjectWithPrivates(client, PRIVATE_CLIENT);
+        FreeClientRec(client);
 
         while (!clients[currentMaxClients - 1])
             currentMaxClients--;
@@ -3583,6 +3921,7 @@ InitClient(ClientPtr client, int i, void *ospriv)
     client->index = i;
     xorg_list_init(&client->ready);
     xorg_list_init(&client->output_pending);
+    xorg_list_init(&client->latency);
     client->clientAsMask = ((Mask) i) << CLIENTOFFSET;
     client->closeDownMode = i ? DestroyAll : RetainPermanent;
     client->requestVector = InitialVector;
@@ -3610,20 +3949,19 @@ NextAvailableClient(void *ospriv)
     i = nextFreeClientID;
     if (i == LimitClients)
         return (ClientPtr) NULL;
-    clients[i] = client =
-        dixAllocateObjectWithPrivates(ClientRec, PRIVATE_CLIENT);
+    clients[i] = client = AllocClientRec();
     if (!client)
         return (ClientPtr) NULL;
     InitClient(client, i, ospriv);
     if (!InitClientResources(client)) {
-        dixFreeObjectWithPrivates(client, PRIVATE_CLIENT);
+        FreeClientRec(client);
         return (ClientPtr) NULL;
     }
     data.reqType = 1;
     data.length = bytes_to_int32(sz_xReq + sz_xConnClientPrefix);
     if (!InsertFakeRequest(client, (char *) &data, sz_xReq)) {
         FreeClientResources(client);
-        dixFreeObjectWithPrivates(client, PRIVATE_CLIENT);
+        FreeClientRec(client);
         return (ClientPtr) NULL;
     }
     if (i == currentMaxClients)
@@ -3670,7 +4008,7 @@ ProcInitialConnection(ClientPtr client)
         swaps(&stuff->length);
     }
     if (order == 'r' || order == 'R') {
-	client->local = FALSE;
+	client->maybeLocal = FALSE;
     }
     ResetCurrentRequest(client);
     return Success;
@@ -1558,6 +1558,34 @@ UpdateGesturesForGrab(DeviceIntPtr mouse)
     }
 }
 
+/* Clients holding device grabs are scheduled in the latency class */
+static void
+GrabLatencyClass(GrabPtr grab, Bool active)
+{
+    ClientPtr client = clients[CLIENT_ID(grab->resource)];
+
+    if (!client)
+        return;
+    if (active)
+        SetClientLatencyClass(client, LATENCY_CLASS_GRAB);
+    else
+        UnsetClientLatencyClass(client, LATENCY_CLASS_GRAB);
+}
+
+/* The owner of the core keyboard focus window is in the latency class */
+static void
+FocusLatencyClass(DeviceIntPtr dev)
+{
+    WindowPtr win = dev->focus->win;
+
+    if (dev != inputInfo.keyboard)
+        return;
+    if (win == NoneWin || win == PointerRootWin || win == FollowKeyboardWin)
+        SetFocusLatencyClient(NullClient);
+    else
+        SetFocusLatencyClient(wClient(win));
+}
+
 /**
  * Activate a pointer grab on the given device. A pointer grab will cause all
  * core pointer events of this device to be delivered to the grabbing client only.
@@ -1606,13 +1634,16 @@ ActivatePointerGrab(DeviceIntPtr mouse, GrabPtr grab,
     grabinfo->grab = AllocGrab(grab);
     grabinfo->fromPassiveGrab = isPassive;
     grabinfo->implicitGrab = autoGrab & ImplicitGrabMask;
+    GrabLatencyClass(grab, TRUE);
     PostNewCursor(mouse);
     UpdateTouchesForGrab(mouse);
     UpdateGesturesForGrab(mouse);
     CheckGrabForSyncs(mouse, (Bool) grab->pointerMode,
                       (Bool) grab->keyboardMode);
-    if (oldgrab)
+    if (oldgrab) {
+        GrabLatencyClass(oldgrab, FALSE);
         FreeGrab(oldgrab);
+    }
 }
 
 /**
@@ -1685,6 +1716,7 @@ DeactivatePointerGrab(DeviceIntPtr mouse)
 
     ComputeFreezes();
 
+    GrabLatencyClass(grab, FALSE);
     FreeGrab(grab);
 }
 
@@ -1729,10 +1761,13 @@ ActivateKeyboardGrab(DeviceIntPtr keybd, GrabPtr grab, TimeStamp time,
     grabinfo->grab = AllocGrab(grab);
     grabinfo->fromPassiveGrab = passive;
     grabinfo->implicitGrab = passive & ImplicitGrabMask;
+    GrabLatencyClass(grab, TRUE);
     CheckGrabForSyncs(keybd, (Bool) grab->keyboardMode,
                       (Bool) grab->pointerMode);
-    if (oldgrab)
+    if (oldgrab) {
+        GrabLatencyClass(oldgrab, FALSE);
         FreeGrab(oldgrab);
+    }
 }
 
 /**
@@ -1775,6 +1810,7 @@ DeactivateKeyboardGrab(DeviceIntPtr keybd)
 
     ComputeFreezes();
 
+    GrabLatencyClass(grab, FALSE);
     FreeGrab(grab);
 }
 
@@ -2093,8 +2129,10 @@ TryClientEvents(ClientPtr client, DeviceIntPtr dev, xEvent *pEvents,
     }
 
     if (BitIsOn(criticalEvents, type)) {
-        if (client->smart_priority < SMART_MAX_PRIORITY)
+        if (client->smart_priority < SMART_MAX_PRIORITY) {
             client->smart_priority++;
+            update_client_priority(client);
+        }
         SetCriticalOutputPending();
     }
 
@@ -4530,6 +4568,18 @@ RecalculateDeliverableEvents(WindowPtr pWin)
     }
 }
 
+/* Window managers are scheduled in the latency class */
+static void
+RedirectLatencyClass(WindowPtr pWin, ClientPtr client, Mask old, Mask new)
+{
+    if (pWin->parent || !client || !((old ^ new) & SubstructureRedirectMask))
+        return;
+    if (new & SubstructureRedirectMask)
+        SetClientLatencyClass(client, LATENCY_CLASS_POLICY);
+    else
+        UnsetClientLatencyClass(client, LATENCY_CLASS_POLICY);
+}
+
 /**
  *
  *  \param value must conform to DeleteType
@@ -4549,6 +4599,7 @@ OtherClientGone(void *value, XID id)
                 if (!(pWin->optional->otherClients = other->next))
                     CheckWindowOptionalNeed(pWin);
             }
+            RedirectLatencyClass(pWin, clients[CLIENT_ID(id)], other->mask, 0);
             free(other);
             RecalculateDeliverableEvents(pWin);
             return Success;
@@ -4592,6 +4643,7 @@ EventSelectForWindow(WindowPtr pWin, ClientPtr client, Mask mask)
     if (wClient(pWin) == client) {
         check = pWin->eventMask;
         pWin->eventMask = mask;
+        RedirectLatencyClass(pWin, client, check, mask);
     }
     else {
         for (others = wOtherClients(pWin); others; others = others->next) {
@@ -4603,6 +4655,7 @@ EventSelectForWindow(WindowPtr pWin, ClientPtr client, Mask mask)
                 }
                 else
                     others->mask = mask;
+                RedirectLatencyClass(pWin, client, check, mask);
                 goto maskSet;
             }
         }
@@ -4616,6 +4669,7 @@ EventSelectForWindow(WindowPtr pWin, ClientPtr client, Mask mask)
         others->resource = FakeClientID(client->index);
         others->next = pWin->optional->otherClients;
         pWin->optional->otherClients = others;
+        RedirectLatencyClass(pWin, client, 0, mask);
         if (!AddResource(others->resource, RT_OTHERCLIENT, (void *) pWin))
             return BadAlloc;
     }
@@ -4943,6 +4997,7 @@ SetInputFocus(ClientPtr client,
         focus->win = FollowKeyboardWin;
     else
         focus->win = focusWin;
+    FocusLatencyClass(dev);
     if ((focusWin == NoneWin) || (focusWin == PointerRootWin))
         focus->traceGood = 0;
     else {
@@ -5932,6 +5987,7 @@ DeleteWindowFromAnyEvents(WindowPtr pWin, Bool freeResources)
                     focus->traceGood = 0;
                     break;
                 }
+                FocusLatencyClass(keybd);
             }
         }
 
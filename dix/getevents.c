@@ -589,10 +589,10 @@ updateMotionHistory(DeviceIntPtr pDev, CARD32 ms, ValuatorMask *mask,
 
         memset(buff, 0, sizeof(INT32) * pDev->valuator->numAxes);
 
-        for (i = 0; i < MAX_VALUATORS; i++) {
+        for (i = 0; i < min(v->numAxes, valuator_mask_size(mask)); i++) {
             int val;
 
-            if (valuator_mask_size(mask) <= i || !valuator_mask_isset(mask, i)) {
+            if (!valuator_mask_isset(mask, i)) {
                 buff += sizeof(INT32);
                 continue;
             }
@@ -1184,7 +1184,8 @@ transformRelative(DeviceIntPtr dev, ValuatorMask *mask)
     valuator_mask_fetch_double(mask, 0, &x);
     valuator_mask_fetch_double(mask, 1, &y);
 
-    transform(&dev->relative_transform, &x, &y);
+    if (!dev->transform_is_identity)
+        transform(&dev->relative_transform, &x, &y);
 
     if (x)
         valuator_mask_set_double(mask, 0, x);
@@ -1214,18 +1215,16 @@ transformAbsolute(DeviceIntPtr dev, ValuatorMask *mask)
     has_x = valuator_mask_isset(mask, 0);
     has_y = valuator_mask_isset(mask, 1);
 
-    if (!has_x && !has_y)
+    /* the identity leaves both axes untouched */
+    if ((!has_x && !has_y) || dev->transform_is_identity)
         return;
 
     if (!has_x || !has_y) {
-        struct pixman_f_transform invert;
-
         /* undo transformation from last event */
         ox = dev->last.valuators[0];
         oy = dev->last.valuators[1];
 
-        pixman_f_transform_invert(&invert, &dev->scale_and_transform);
-        transform(&invert, &ox, &oy);
+        transform(&dev->inverse_scale_and_transform, &ox, &oy);
     }
 
     if (has_x)
@@ -187,6 +187,7 @@ dix_main(int argc, char *argv[], char *envp[])
         dixResetRegistry();
         InitFonts();
         InitCallbackManager();
+        TraceInit();
         InitOutput(&screenInfo, argc, argv);
 
         if (screenInfo.numScreens < 1)
@@ -432,6 +432,8 @@ InitTrackers(DeviceVelocityPtr vel, int ntracker)
     free(vel->tracker);
     vel->tracker = (MotionTrackerPtr) calloc(ntracker, sizeof(MotionTracker));
     vel->num_tracker = ntracker;
+    vel->motion_x = 0.0;
+    vel->motion_y = 0.0;
 }
 
 enum directions {
@@ -553,22 +555,40 @@ GetDirection(int dx, int dy)
 #define TRACKER_INDEX(s, d) (((s)->num_tracker + (s)->cur_tracker - (d)) % (s)->num_tracker)
 #define TRACKER(s, d) &(s)->tracker[TRACKER_INDEX(s,d)]
 
+/* accumulated motion after which the trackers are rebased to keep the
+ * per-tracker deltas precise */
+#define TRACKER_REBASE_LIMIT (1 << 20)
+
 /**
- * Add the delta motion to each tracker, then reset the latest tracker to
- * 0/0 and set it as the current one.
+ * Add the delta motion to the accumulated motion, then start the next
+ * tracker at the new position and set it as the current one.
+ *
+ * Each tracker only stores the accumulated motion at the time it was
+ * started, the delta it covers is the difference to the current
+ * accumulated motion. This keeps feeding a motion O(1) instead of
+ * touching every tracker.
  */
 static inline void
 FeedTrackers(DeviceVelocityPtr vel, double dx, double dy, int cur_t)
 {
     int n;
 
-    for (n = 0; n < vel->num_tracker; n++) {
-        vel->tracker[n].dx += dx;
-        vel->tracker[n].dy += dy;
+    vel->motion_x += dx;
+    vel->motion_y += dy;
+
+    if (fabs(vel->motion_x) > TRACKER_REBASE_LIMIT ||
+        fabs(vel->motion_y) > TRACKER_REBASE_LIMIT) {
+        for (n = 0; n < vel->num_tracker; n++) {
+            vel->tracker[n].x -= vel->motion_x;
+            vel->tracker[n].y -= vel->motion_y;
+        }
+        vel->motion_x = 0.0;
+        vel->motion_y = 0.0;
     }
+
     n = (vel->cur_tracker + 1) % vel->num_tracker;
-    vel->tracker[n].dx = 0.0;
-    vel->tracker[n].dy = 0.0;
+    vel->tracker[n].x = vel->motion_x;
+    vel->tracker[n].y = vel->motion_y;
     vel->tracker[n].time = cur_t;
     vel->tracker[n].dir = GetDirection(dx, dy);
     DebugAccelF("motion [dx: %f dy: %f dir:%d diff: %d]\n",
@@ -583,9 +603,12 @@ FeedTrackers(DeviceVelocityPtr vel, double dx, double dy, int cur_t)
  * This assumes linear motion.
  */
 static double
-CalcTracker(const MotionTracker * tracker, int cur_t)
+CalcTracker(const DeviceVelocityRec * vel, const MotionTracker * tracker,
+            int cur_t)
 {
-    double dist = sqrt(tracker->dx * tracker->dx + tracker->dy * tracker->dy);
+    double dx = vel->motion_x - tracker->x;
+    double dy = vel->motion_y - tracker->y;
+    double dist = sqrt(dx * dx + dy * dy);
     int dtime = cur_t - tracker->time;
 
     if (dtime > 0)
@@ -638,7 +661,7 @@ QueryTrackers(DeviceVelocityPtr vel, int cur_t)
             break;
         }
 
-        tracker_velocity = CalcTracker(tracker, cur_t) * velocity_factor;
+        tracker_velocity = CalcTracker(vel, tracker, cur_t) * velocity_factor;
 
         if ((initial_velocity == 0 || offset <= vel->initial_range) &&
             tracker_velocity != 0) {
@@ -674,7 +697,8 @@ QueryTrackers(DeviceVelocityPtr vel, int cur_t)
         MotionTracker *tracker = TRACKER(vel, used_offset);
 
         DebugAccelF("result: offset %i [dx: %f dy: %f diff: %i]\n",
-                    used_offset, tracker->dx, tracker->dy,
+                    used_offset, vel->motion_x - tracker->x,
+                    vel->motion_y - tracker->y,
                     cur_t - tracker->time);
 #endif
     }
@@ -683,6 +707,7 @@ QueryTrackers(DeviceVelocityPtr vel, int cur_t)
 
 #undef TRACKER_INDEX
 #undef TRACKER
+#undef TRACKER_REBASE_LIMIT
 
 /**
  * Perform velocity approximation based on 2D 'mickeys' (mouse motion delta).
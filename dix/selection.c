@@ -109,6 +109,27 @@ CallSelectionCallback(Selection * pSel, ClientPtr client,
     CallCallbacks(&SelectionCallback, &info);
 }
 
+static Bool
+IsInputMethodSelection(Atom selection)
+{
+    static const char prefix[] = "@server=";
+    const char *name = NameForAtom(selection);
+
+    return name && strncmp(name, prefix, sizeof(prefix) - 1) == 0;
+}
+
+/* XIM servers own "@server=<name>"; schedule them in the latency class */
+static void
+SelectionLatencyClass(Selection * pSel, Bool owned)
+{
+    if (!pSel->client || !IsInputMethodSelection(pSel->selection))
+        return;
+    if (owned)
+        SetClientLatencyClass(pSel->client, LATENCY_CLASS_POLICY);
+    else
+        UnsetClientLatencyClass(pSel->client, LATENCY_CLASS_POLICY);
+}
+
 void
 DeleteWindowFromAnySelections(WindowPtr pWin)
 {
@@ -117,6 +138,7 @@ DeleteWindowFromAnySelections(WindowPtr pWin)
     for (pSel = CurrentSelections; pSel; pSel = pSel->next)
         if (pSel->pWin == pWin) {
             CallSelectionCallback(pSel, NULL, SelectionWindowDestroy);
+            SelectionLatencyClass(pSel, FALSE);
 
             pSel->pWin = (WindowPtr) NULL;
             pSel->window = None;
@@ -132,6 +154,7 @@ DeleteClientFromAnySelections(ClientPtr client)
     for (pSel = CurrentSelections; pSel; pSel = pSel->next)
         if (pSel->client == client) {
             CallSelectionCallback(pSel, NULL, SelectionClientClose);
+            SelectionLatencyClass(pSel, FALSE);
 
             pSel->pWin = (WindowPtr) NULL;
             pSel->window = None;
@@ -214,10 +237,12 @@ ProcSetSelectionOwner(ClientPtr client)
     else
         return rc;
 
+    SelectionLatencyClass(pSel, FALSE);
     pSel->lastTimeChanged = time;
     pSel->window = stuff->window;
     pSel->pWin = pWin;
     pSel->client = (pWin ? client : NullClient);
+    SelectionLatencyClass(pSel, TRUE);
 
     CallSelectionCallback(pSel, client, SelectionSetOwner);
     return Success;
@@ -106,17 +106,28 @@ DDXTouchPointInfoPtr
 TouchFindByDDXID(DeviceIntPtr dev, uint32_t ddx_id, Bool create)
 {
     DDXTouchPointInfoPtr ti;
+    int *hint;
     int i;
 
     if (!dev->touch)
         return NULL;
 
-    for (i = 0; i < dev->last.num_touches; i++) {
+    hint = &dev->last_touch_index[ddx_id % TOUCH_INDEX_SIZE];
+    i = *hint - 1;
+    if (i >= 0 && i < dev->last.num_touches) {
         ti = &dev->last.touches[i];
         if (ti->active && ti->ddx_id == ddx_id)
             return ti;
     }
 
+    for (i = 0; i < dev->last.num_touches; i++) {
+        ti = &dev->last.touches[i];
+        if (ti->active && ti->ddx_id == ddx_id) {
+            *hint = i + 1;
+            return ti;
+        }
+    }
+
     return create ? TouchBeginDDXTouch(dev, ddx_id) : NULL;
 }
 
@@ -177,6 +188,8 @@ TouchBeginDDXTouch(DeviceIntPtr dev, uint32_t ddx_id)
             next_client_id = 1;
         ti->client_id = client_id;
         ti->emulate_pointer = emulate_pointer;
+        dev->last_touch_index[ddx_id % TOUCH_INDEX_SIZE] =
+            ti - dev->last.touches + 1;
     }
     return ti;
 }
@@ -250,10 +263,7 @@ TouchFreeTouchPoint(DeviceIntPtr device, int index)
     ti->sprite.spriteTrace = NULL;
     free(ti->listeners);
     ti->listeners = NULL;
-    free(ti->history);
-    ti->history = NULL;
-    ti->history_size = 0;
-    ti->history_elements = 0;
+    TouchEventHistoryFree(ti);
 }
 
 /**
@@ -265,17 +275,28 @@ TouchFindByClientID(DeviceIntPtr dev, uint32_t client_id)
 {
     TouchClassPtr t = dev->touch;
     TouchPointInfoPtr ti;
+    int *hint;
     int i;
 
     if (!t)
         return NULL;
 
-    for (i = 0; i < t->num_touches; i++) {
+    hint = &t->index[client_id % TOUCH_INDEX_SIZE];
+    i = *hint - 1;
+    if (i >= 0 && i < t->num_touches) {
         ti = &t->touches[i];
         if (ti->active && ti->client_id == client_id)
             return ti;
     }
 
+    for (i = 0; i < t->num_touches; i++) {
+        ti = &t->touches[i];
+        if (ti->active && ti->client_id == client_id) {
+            *hint = i + 1;
+            return ti;
+        }
+    }
+
     return NULL;
 }
 
@@ -294,6 +315,7 @@ TouchBeginTouch(DeviceIntPtr dev, int sourceid, uint32_t touchid,
     TouchClassPtr t = dev->touch;
     TouchPointInfoPtr ti;
     void *tmp;
+    size_t size;
 
     if (!t)
         return NULL;
@@ -314,17 +336,32 @@ TouchBeginTouch(DeviceIntPtr dev, int sourceid, uint32_t touchid,
             ti->client_id = touchid;
             ti->sourceid = sourceid;
             ti->emulate_pointer = emulate_pointer;
+            t->index[touchid % TOUCH_INDEX_SIZE] = i + 1;
             return ti;
         }
     }
 
-    /* If we get here, then we've run out of touches: enlarge dev->touch and
-     * try again. */
-    tmp = reallocarray(t->touches, t->num_touches + 1, sizeof(*ti));
+    /* If we get here, then we've run out of touches: enlarge dev->touch by
+     * half its current size and try again. */
+    size = t->num_touches + t->num_touches / 2 + 1;
+    if (size > USHRT_MAX)
+        size = USHRT_MAX;
+    if (size <= t->num_touches)
+        return NULL;
+
+    tmp = reallocarray(t->touches, size, sizeof(*ti));
     if (tmp) {
+        int old_size = t->num_touches;
+
         t->touches = tmp;
-        t->num_touches++;
-        if (TouchInitTouchPoint(t, dev->valuator, t->num_touches - 1))
+        while (t->num_touches < size) {
+            t->num_touches++;
+            if (!TouchInitTouchPoint(t, dev->valuator, t->num_touches - 1)) {
+                t->num_touches--;
+                break;
+            }
+        }
+        if (t->num_touches > old_size)
             goto try_find_touch;
     }
 
@@ -384,6 +421,7 @@ TouchEventHistoryAllocate(TouchPointInfoPtr ti)
 
     ti->history = calloc(TOUCH_HISTORY_SIZE, sizeof(*ti->history));
     ti->history_elements = 0;
+    ti->history_first = 0;
     if (ti->history)
         ti->history_size = TOUCH_HISTORY_SIZE;
     return ti->history != NULL;
@@ -396,6 +434,7 @@ TouchEventHistoryFree(TouchPointInfoPtr ti)
     ti->history = NULL;
     ti->history_size = 0;
     ti->history_elements = 0;
+    ti->history_first = 0;
 }
 
 /**
@@ -405,6 +444,10 @@ TouchEventHistoryFree(TouchPointInfoPtr ti)
  * If more than one TouchBegin is pushed onto the stack, the push is
  * ignored, calling this function multiple times for the TouchBegin is
  * valid.
+ *
+ * The TouchBegin always stays in history[0], the remaining elements are a
+ * ring of TouchUpdates. Once the ring is full, the oldest TouchUpdate is
+ * overwritten.
  */
 void
 TouchEventHistoryPush(TouchPointInfoPtr ti, const DeviceEvent *ev)
@@ -430,13 +473,16 @@ TouchEventHistoryPush(TouchPointInfoPtr ti, const DeviceEvent *ev)
     if (ev->flags & (TOUCH_CLIENT_ID | TOUCH_REPLAYING))
         return;
 
-    ti->history[ti->history_elements++] = *ev;
-    /* FIXME: proper overflow fixes */
-    if (ti->history_elements > ti->history_size - 1) {
-        ti->history_elements = ti->history_size - 1;
-        DebugF("source device %d: history size %zu overflowing for touch %u\n",
-               ti->sourceid, ti->history_size, ti->client_id);
+    if (ti->history_elements < ti->history_size) {
+        ti->history[ti->history_elements++] = *ev;
+        return;
     }
+
+    /* ring is full, drop the oldest update but keep the TouchBegin */
+    ti->history[1 + ti->history_first] = *ev;
+    ti->history_first = (ti->history_first + 1) % (ti->history_size - 1);
+    DebugF("source device %d: history size %zu overflowing for touch %u\n",
+           ti->sourceid, ti->history_size, ti->client_id);
 }
 
 void
@@ -452,6 +498,10 @@ TouchEventHistoryReplay(TouchPointInfoPtr ti, DeviceIntPtr dev, XID resource)
     for (i = 0; i < ti->history_elements; i++) {
         DeviceEvent *ev = &ti->history[i];
 
+        if (i > 0)
+            ev = &ti->history[1 + (ti->history_first + i - 1) %
+                              (ti->history_size - 1)];
+
         ev->flags |= TOUCH_REPLAYING;
         ev->resource = resource;
         /* FIXME:
@@ -483,6 +483,9 @@ SetWindowToDefaults(WindowPtr pWin)
     pWin->optional = NULL;
     pWin->cursorIsNone = TRUE;
 
+    pWin->notClipped = NULL;
+    pWin->notClippedSerial = 0;
+
     pWin->backingStore = NotUseful;
 
     pWin->mapped = FALSE;       /* off */
@@ -1002,6 +1005,9 @@ FreeWindowResources(WindowPtr pWin)
     RegionUninit(&pWin->winSize);
     RegionUninit(&pWin->borderClip);
     RegionUninit(&pWin->borderSize);
+    if (pWin->notClipped)
+        RegionDestroy(pWin->notClipped);
+    pWin->notClipped = NULL;
     if (wBoundingShape(pWin))
         RegionDestroy(wBoundingShape(pWin));
     if (wClipShape(pWin))
@@ -3012,6 +3018,45 @@ NotClippedByChildren(WindowPtr pWin)
     return pReg;
 }
 
+/*
+ * Same region as NotClippedByChildren, but owned by the window and
+ * recomputed only when the clip changes.  The result must not be
+ * modified or destroyed by the caller and is only good until the
+ * window's clip is next recomputed.
+ */
+RegionPtr
+GetNotClippedByChildren(WindowPtr pWin)
+{
+    if (!pWin->notClipped) {
+        pWin->notClipped = RegionCreate(NullBox, 1);
+        if (!pWin->notClipped)
+            return NULL;
+    }
+
+    if (!pWin->parent &&
+        screenIsSaved == SCREEN_SAVER_ON &&
+        HasSaverWindow(pWin->drawable.pScreen)) {
+        RegionEmpty(pWin->notClipped);
+        pWin->notClippedSerial = 0;
+    }
+    else if (pWin->notClippedSerial != pWin->drawable.serialNumber) {
+        RegionIntersect(pWin->notClipped, &pWin->borderClip, &pWin->winSize);
+        pWin->notClippedSerial = pWin->drawable.serialNumber;
+    }
+    return pWin->notClipped;
+}
+
+/*
+ * Called wherever borderClip or winSize change without the drawable
+ * serial number being bumped, e.g. when an unmapped window's clip is
+ * emptied.
+ */
+void
+InvalidateNotClippedByChildren(WindowPtr pWin)
+{
+    pWin->notClippedSerial = 0;
+}
+
 void
 SendVisibilityNotify(WindowPtr pWin)
 {
@@ -3693,6 +3738,7 @@ SetRootClip(ScreenPtr pScreen, int enable)
         RegionEmpty(&pWin->borderClip);
         RegionBreak(&pWin->clipList);
     }
+    InvalidateNotClippedByChildren(pWin);
 
     ResizeChildrenWinSize(pWin, 0, 0, 0, 0);
 
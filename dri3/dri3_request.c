@@ -570,7 +570,7 @@ int
 proc_dri3_dispatch(ClientPtr client)
 {
     REQUEST(xReq);
-    if (!client->local)
+    if (!GetClientLocal(client))
         return BadMatch;
     if (stuff->data >= DRI3NumberRequests || !proc_dri3_vector[stuff->data])
         return BadRequest;
@@ -713,7 +713,7 @@ int _X_COLD
 sproc_dri3_dispatch(ClientPtr client)
 {
     REQUEST(xReq);
-    if (!client->local)
+    if (!GetClientLocal(client))
         return BadMatch;
     if (stuff->data >= DRI3NumberRequests || !sproc_dri3_vector[stuff->data])
         return BadRequest;
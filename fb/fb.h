@@ -399,6 +399,17 @@ typedef void (*FinishWrapProcPtr) (DrawablePtr pDraw);
 
 #endif
 
+/*
+ * Split large pixel loops across worker threads; the access wrappers
+ * aren't known to be thread safe, so wfb stays on the main thread.
+ */
+#ifdef FB_ACCESS_WRAPPER
+#define fbRunBands(y1, y2, bytes, proc, closure) (*(proc)) (closure, y1, y2)
+#else
+#define fbRunBands(y1, y2, bytes, proc, closure) \
+	WorkerRunBands(y1, y2, bytes, proc, closure)
+#endif
+
 extern _X_EXPORT DevPrivateKey
 fbGetScreenPrivateKey(void);
 
@@ -108,6 +108,29 @@ fbStipple(FbBits * dst, FbStride dstStride,
     }
 }
 
+typedef struct {
+    FbBits *dst;
+    FbStride dstStride;
+    int dstBpp;
+    int x, width;
+    FbBits and, xor;
+} FbSolidBandRec;
+
+static void
+fbSolidBand(void *closure, int y1, int y2)
+{
+    FbSolidBandRec *b = closure;
+
+#ifndef FB_ACCESS_WRAPPER
+    if (b->and || !pixman_fill((uint32_t *) b->dst, b->dstStride, b->dstBpp,
+                               b->x, y1, b->width, y2 - y1, b->xor))
+#endif
+        fbSolid(b->dst + y1 * b->dstStride,
+                b->dstStride,
+                b->x * b->dstBpp,
+                b->dstBpp, b->width * b->dstBpp, y2 - y1, b->and, b->xor);
+}
+
 void
 fbFill(DrawablePtr pDrawable, GCPtr pGC, int x, int y, int width, int height)
 {
@@ -120,17 +143,21 @@ fbFill(DrawablePtr pDrawable, GCPtr pGC, int x, int y, int width, int height)
     fbGetDrawable(pDrawable, dst, dstStride, dstBpp, dstXoff, dstYoff);
 
     switch (pGC->fillStyle) {
-    case FillSolid:
-#ifndef FB_ACCESS_WRAPPER
-        if (pPriv->and || !pixman_fill((uint32_t *) dst, dstStride, dstBpp,
-                                       x + dstXoff, y + dstYoff,
-                                       width, height, pPriv->xor))
-#endif
-            fbSolid(dst + (y + dstYoff) * dstStride,
-                    dstStride,
-                    (x + dstXoff) * dstBpp,
-                    dstBpp, width * dstBpp, height, pPriv->and, pPriv->xor);
+    case FillSolid:{
+        FbSolidBandRec band = {
+            .dst = dst,
+            .dstStride = dstStride,
+            .dstBpp = dstBpp,
+            .x = x + dstXoff,
+            .width = width,
+            .and = pPriv->and,
+            .xor = pPriv->xor
+        };
+
+        fbRunBands(y + dstYoff, y + dstYoff + height,
+                   (size_t) width * height * dstBpp / 8, fbSolidBand, &band);
         break;
+    }
     case FillStippled:
     case FillOpaqueStippled:{
         PixmapPtr pStip = pGC->stipple;
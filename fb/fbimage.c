@@ -74,6 +74,29 @@ fbPutImage(DrawablePtr pDrawable,
     }
 }
 
+typedef struct {
+    FbStip *src;
+    FbStride srcStride;
+    int srcX;
+    FbStip *dst;
+    FbStride dstStride;
+    int dstX;
+    int width;
+    int alu;
+    FbBits pm;
+    int bpp;
+} FbPutZImageBandRec;
+
+static void
+fbPutZImageBand(void *closure, int y1, int y2)
+{
+    FbPutZImageBandRec *b = closure;
+
+    fbBltStip(b->src + y1 * b->srcStride, b->srcStride, b->srcX,
+              b->dst + y1 * b->dstStride, b->dstStride, b->dstX,
+              b->width, y2 - y1, b->alu, b->pm, b->bpp);
+}
+
 void
 fbPutZImage(DrawablePtr pDrawable,
             RegionPtr pClip,
@@ -89,6 +112,7 @@ fbPutZImage(DrawablePtr pDrawable,
     int nbox;
     BoxPtr pbox;
     int x1, y1, x2, y2;
+    FbPutZImageBandRec band;
 
     fbGetStipDrawable(pDrawable, dst, dstStride, dstBpp, dstXoff, dstYoff);
 
@@ -108,13 +132,20 @@ fbPutZImage(DrawablePtr pDrawable,
             y2 = pbox->y2;
         if (x1 >= x2 || y1 >= y2)
             continue;
-        fbBltStip(src + (y1 - y) * srcStride,
-                  srcStride,
-                  (x1 - x) * dstBpp,
-                  dst + (y1 + dstYoff) * dstStride,
-                  dstStride,
-                  (x1 + dstXoff) * dstBpp,
-                  (x2 - x1) * dstBpp, (y2 - y1), alu, pm, dstBpp);
+        band = (FbPutZImageBandRec) {
+            .src = src + (y1 - y) * srcStride,
+            .srcStride = srcStride,
+            .srcX = (x1 - x) * dstBpp,
+            .dst = dst + (y1 + dstYoff) * dstStride,
+            .dstStride = dstStride,
+            .dstX = (x1 + dstXoff) * dstBpp,
+            .width = (x2 - x1) * dstBpp,
+            .alu = alu,
+            .pm = pm,
+            .bpp = dstBpp
+        };
+        fbRunBands(0, y2 - y1, (size_t) (x2 - x1) * (y2 - y1) * dstBpp / 8,
+                   fbPutZImageBand, &band);
     }
 
     fbFinishAccess(pDrawable);
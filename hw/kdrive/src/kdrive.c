@@ -615,6 +615,7 @@ KdCreateWindow(WindowPtr pWin)
         if (!pScreenPriv->enabled) {
             RegionEmpty(&pWin->borderClip);
             RegionBreak(&pWin->clipList);
+            InvalidateNotClippedByChildren(pWin);
         }
     }
 #endif
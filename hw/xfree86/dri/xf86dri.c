@@ -118,7 +118,7 @@ ProcXF86DRIQueryDirectRenderingCapable(register ClientPtr client)
         return BadValue;
     }
 
-    if (!client->local || client->swapped)
+    if (!GetClientLocal(client) || client->swapped)
         isCapable = 0;
 
     rep = (xXF86DRIQueryDirectRenderingCapableReply) {
@@ -528,7 +528,7 @@ ProcXF86DRIDispatch(register ClientPtr client)
         return ProcXF86DRIQueryDirectRenderingCapable(client);
     }
 
-    if (!client->local)
+    if (!GetClientLocal(client))
         return DRIErrorBase + XF86DRIClientNotLocal;
 
     switch (stuff->data) {
@@ -599,7 +599,7 @@ ProcDRI2Dispatch(ClientPtr client)
         return ProcDRI2QueryVersion(client);
     }
 
-    if (!client->local)
+    if (!GetClientLocal(client))
         return BadRequest;
 
     switch (stuff->data) {
@@ -628,7 +628,7 @@ ProcAppleWMDispatch(register ClientPtr client)
         return ProcAppleWMQueryVersion(client);
     }
 
-    if (!client->local)
+    if (!GetClientLocal(client))
         return WMErrorBase + AppleWMClientNotLocal;
 
     switch (stuff->data) {
@@ -700,7 +700,7 @@ SProcAppleWMDispatch(register ClientPtr client)
     REQUEST(xReq);
 
     /* It is bound to be non-local when there is byte swapping */
-    if (!client->local)
+    if (!GetClientLocal(client))
         return WMErrorBase + AppleWMClientNotLocal;
 
     /* only local clients are allowed WM access */
@@ -133,7 +133,7 @@ ProcAppleDRIQueryDirectRenderingCapable(register ClientPtr client)
     }
     rep.isCapable = isCapable;
 
-    if (!client->local)
+    if (!GetClientLocal(client))
         rep.isCapable = 0;
 
     if (client->swapped) {
@@ -358,7 +358,7 @@ ProcAppleDRIDispatch(register ClientPtr client)
         return ProcAppleDRIQueryDirectRenderingCapable(client);
     }
 
-    if (!client->local)
+    if (!GetClientLocal(client))
         return DRIErrorBase + AppleDRIClientNotLocal;
 
     switch (stuff->data) {
@@ -479,7 +479,7 @@ SProcAppleDRIDispatch(register ClientPtr client)
         return SProcAppleDRIQueryDirectRenderingCapable(client);
     }
 
-    if (!client->local)
+    if (!GetClientLocal(client))
         return DRIErrorBase + AppleDRIClientNotLocal;
 
     switch (stuff->data) {
@@ -168,6 +168,8 @@ xwl_close_screen(ScreenPtr screen)
 
     xwl_screen_release_tablet_manager(xwl_screen);
 
+    xwl_shm_close_screen(xwl_screen);
+
     RemoveNotifyFd(xwl_screen->wayland_fd);
 
     wl_display_disconnect(xwl_screen->display);
@@ -619,6 +621,7 @@ xwl_screen_init(ScreenPtr pScreen, int argc, char **argv)
     xorg_list_init(&xwl_screen->seat_list);
     xorg_list_init(&xwl_screen->damage_window_list);
     xorg_list_init(&xwl_screen->window_list);
+    xorg_list_init(&xwl_screen->shm_pools);
     xwl_screen->depth = 24;
 
     if (!monitorResolution)
@@ -71,6 +71,7 @@ struct xwl_screen {
     struct xorg_list seat_list;
     struct xorg_list damage_window_list;
     struct xorg_list window_list;
+    struct xorg_list shm_pools;
 
     int wayland_fd;
     struct wl_display *display;
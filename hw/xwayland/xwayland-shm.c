@@ -43,10 +43,48 @@
 #include "xwayland-screen.h"
 #include "xwayland-shm.h"
 
+/* Pixmaps are carved out of a few large shared pools instead of getting
+ * an anonymous file, a mapping and a wl_shm_pool each.  Every pool
+ * reserves XWL_SHM_POOL_RESERVE bytes of address space up front and maps
+ * the file into the start of it, so growing a pool never moves the
+ * pixels of the pixmaps already living in it.  Pixmaps bigger than
+ * XWL_SHM_POOL_MAX_SLICE get a pool of their own, sized to fit.  Shared
+ * pools are kept at the size they grew to, but pages freed beyond the
+ * first XWL_SHM_POOL_SIZE bytes are given back with a hole punch.
+ */
+#define XWL_SHM_POOL_SIZE       (4 << 20)
+#define XWL_SHM_POOL_RESERVE    (64 << 20)
+#define XWL_SHM_POOL_MAX_SLICE  (16 << 20)
+#define XWL_SHM_SLICE_ALIGN     64
+
+#ifndef MAP_NORESERVE
+#define MAP_NORESERVE 0
+#endif
+
+struct xwl_shm_range {
+    struct xorg_list link;
+    size_t offset;
+    size_t size;
+};
+
+struct xwl_shm_pool {
+    struct xorg_list link;      /* xwl_screen->shm_pools */
+    struct xwl_screen *xwl_screen;      /* NULL once the screen is gone */
+    struct wl_shm_pool *pool;
+    int fd;
+    char *data;
+    size_t size;                /* bytes backed by the file */
+    size_t reserved;            /* bytes of address space reserved */
+    struct xorg_list free_ranges;       /* sorted by offset */
+    int nslices;
+};
+
 struct xwl_pixmap {
     struct wl_buffer *buffer;
     void *data;
     size_t size;
+    struct xwl_shm_pool *pool;
+    size_t offset;
 };
 
 #ifndef HAVE_MKOSTEMP
@@ -93,6 +131,45 @@ create_tmpfile_cloexec(char *tmpname)
     return os_move_fd(fd);
 }
 
+/*
+ * Grow an anonymous file created by os_create_anonymous_file() to the
+ * given size, with the same guarantees about the backing store.
+ * Returns 0 on success, -1 with errno set on failure.
+ */
+static int
+os_resize_anonymous_file(int fd, off_t size)
+{
+    int ret;
+
+#ifdef HAVE_POSIX_FALLOCATE
+    /*
+     * posix_fallocate does an explicit rollback if it gets EINTR.
+     * Temporarily block signals to allow the call to succeed on
+     * slow systems where the smart scheduler's SIGALRM prevents
+     * large allocation attempts from ever succeeding.
+     */
+    OsBlockSignals();
+    do {
+        ret = posix_fallocate(fd, 0, size);
+    } while (ret == EINTR);
+    OsReleaseSignals();
+
+    if (ret != 0) {
+        errno = ret;
+        return -1;
+    }
+#else
+    do {
+        ret = ftruncate(fd, size);
+    } while (ret == -1 && errno == EINTR);
+
+    if (ret < 0)
+        return -1;
+#endif
+
+    return 0;
+}
+
 /*
  * Create a new, unique, anonymous file of the given size, and
  * return the file descriptor for it. The file descriptor is set
@@ -128,7 +205,6 @@ os_create_anonymous_file(off_t size)
     const char *path;
     char *name;
     int fd;
-    int ret;
 
 #ifdef HAVE_MEMFD_CREATE
     fd = memfd_create("xwayland-shared", MFD_CLOEXEC | MFD_ALLOW_SEALING);
@@ -164,34 +240,10 @@ os_create_anonymous_file(off_t size)
             return -1;
     }
 
-#ifdef HAVE_POSIX_FALLOCATE
-    /*
-     * posix_fallocate does an explicit rollback if it gets EINTR.
-     * Temporarily block signals to allow the call to succeed on
-     * slow systems where the smart scheduler's SIGALRM prevents
-     * large allocation attempts from ever succeeding.
-     */
-    OsBlockSignals();
-    do {
-        ret = posix_fallocate(fd, 0, size);
-    } while (ret == EINTR);
-    OsReleaseSignals();
-
-    if (ret != 0) {
-        close(fd);
-        errno = ret;
-        return -1;
-    }
-#else
-    do {
-        ret = ftruncate(fd, size);
-    } while (ret == -1 && errno == EINTR);
-
-    if (ret < 0) {
+    if (os_resize_anonymous_file(fd, size) < 0) {
         close(fd);
         return -1;
     }
-#endif
 
     return fd;
 }
@@ -213,6 +265,272 @@ shm_format_for_depth(int depth)
     }
 }
 
+/* Returns the free range now covering offset, NULL if it got lost */
+static struct xwl_shm_range *
+xwl_shm_pool_add_range(struct xwl_shm_pool *pool, size_t offset, size_t size)
+{
+    struct xwl_shm_range *range, *prev = NULL, *next = NULL;
+
+    xorg_list_for_each_entry(range, &pool->free_ranges, link) {
+        if (range->offset > offset) {
+            next = range;
+            break;
+        }
+        prev = range;
+    }
+
+    if (prev && prev->offset + prev->size == offset) {
+        prev->size += size;
+        if (next && prev->offset + prev->size == next->offset) {
+            prev->size += next->size;
+            xorg_list_del(&next->link);
+            free(next);
+        }
+        return prev;
+    }
+
+    if (next && offset + size == next->offset) {
+        next->offset = offset;
+        next->size += size;
+        return next;
+    }
+
+    range = malloc(sizeof(*range));
+    if (!range)
+        return NULL; /* The space is lost until the pool goes away */
+
+    range->offset = offset;
+    range->size = size;
+    if (next)
+        xorg_list_add(&range->link, next->link.prev);
+    else
+        xorg_list_append(&range->link, &pool->free_ranges);
+    return range;
+}
+
+/* Give the pages around a freed slice back to the system once nothing
+ * uses them, if they lie beyond the initial size of the pool; the
+ * mapping stays and the pages read back as zero when used again.
+ */
+static void
+xwl_shm_pool_punch_hole(struct xwl_shm_pool *pool,
+                        struct xwl_shm_range *range,
+                        size_t offset, size_t size)
+{
+#ifdef FALLOC_FL_PUNCH_HOLE
+    size_t page = sysconf(_SC_PAGESIZE);
+    size_t start, end;
+
+    start = max(offset & ~(page - 1), XWL_SHM_POOL_SIZE);
+    start = max(start, (range->offset + page - 1) & ~(page - 1));
+    end = (offset + size + page - 1) & ~(page - 1);
+    end = min(end, (range->offset + range->size) & ~(page - 1));
+    end = min(end, pool->size);
+    if (start >= end)
+        return;
+
+    fallocate(pool->fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+              start, end - start);
+#endif
+}
+
+static Bool
+xwl_shm_pool_alloc(struct xwl_shm_pool *pool, size_t size, size_t *offset)
+{
+    struct xwl_shm_range *range;
+
+    xorg_list_for_each_entry(range, &pool->free_ranges, link) {
+        if (range->size < size)
+            continue;
+
+        *offset = range->offset;
+        range->offset += size;
+        range->size -= size;
+        if (range->size == 0) {
+            xorg_list_del(&range->link);
+            free(range);
+        }
+        pool->nslices++;
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
+static void
+xwl_shm_pool_destroy(struct xwl_shm_pool *pool)
+{
+    struct xwl_shm_range *range, *next;
+
+    xorg_list_for_each_entry_safe(range, next, &pool->free_ranges, link) {
+        xorg_list_del(&range->link);
+        free(range);
+    }
+
+    if (pool->pool)
+        wl_shm_pool_destroy(pool->pool);
+    xorg_list_del(&pool->link);
+    munmap(pool->data, pool->reserved);
+    close(pool->fd);
+    free(pool);
+}
+
+static struct xwl_shm_pool *
+xwl_shm_pool_create(struct xwl_screen *xwl_screen,
+                    size_t size, size_t reserved)
+{
+    struct xwl_shm_pool *pool;
+    void *data;
+
+    pool = calloc(1, sizeof(*pool));
+    if (!pool)
+        return NULL;
+
+    pool->fd = os_create_anonymous_file(size);
+    if (pool->fd < 0)
+        goto err_free_pool;
+
+    pool->data = mmap(NULL, reserved, PROT_NONE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (pool->data == MAP_FAILED)
+        goto err_close_fd;
+
+    data = mmap(pool->data, size, PROT_READ | PROT_WRITE,
+                MAP_SHARED | MAP_FIXED, pool->fd, 0);
+    if (data == MAP_FAILED)
+        goto err_munmap;
+
+    pool->xwl_screen = xwl_screen;
+    pool->pool = wl_shm_create_pool(xwl_screen->shm, pool->fd, size);
+    pool->size = size;
+    pool->reserved = reserved;
+    xorg_list_init(&pool->free_ranges);
+    xwl_shm_pool_add_range(pool, 0, size);
+    xorg_list_append(&pool->link, &xwl_screen->shm_pools);
+
+    return pool;
+
+ err_munmap:
+    munmap(pool->data, reserved);
+ err_close_fd:
+    close(pool->fd);
+ err_free_pool:
+    free(pool);
+
+    return NULL;
+}
+
+static Bool
+xwl_shm_pool_grow(struct xwl_shm_pool *pool, size_t size)
+{
+    void *data;
+
+    if (os_resize_anonymous_file(pool->fd, size) < 0)
+        return FALSE;
+
+    data = mmap(pool->data + pool->size, size - pool->size,
+                PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED,
+                pool->fd, pool->size);
+    if (data == MAP_FAILED)
+        return FALSE;
+
+    wl_shm_pool_resize(pool->pool, size);
+    xwl_shm_pool_add_range(pool, pool->size, size - pool->size);
+    pool->size = size;
+
+    return TRUE;
+}
+
+static struct xwl_shm_pool *
+xwl_shm_alloc(struct xwl_screen *xwl_screen, size_t size, size_t *offset)
+{
+    struct xwl_shm_pool *pool;
+    size_t grow;
+
+    if (size > XWL_SHM_POOL_MAX_SLICE) {
+        size = (size + getpagesize() - 1) & ~(size_t) (getpagesize() - 1);
+        pool = xwl_shm_pool_create(xwl_screen, size, size);
+        if (pool && !xwl_shm_pool_alloc(pool, size, offset)) {
+            xwl_shm_pool_destroy(pool);
+            pool = NULL;
+        }
+        return pool;
+    }
+
+    xorg_list_for_each_entry(pool, &xwl_screen->shm_pools, link) {
+        if (xwl_shm_pool_alloc(pool, size, offset))
+            return pool;
+    }
+
+    /* No room anywhere, try to grow a pool before starting a new one */
+    xorg_list_for_each_entry(pool, &xwl_screen->shm_pools, link) {
+        if (pool->size + size > pool->reserved)
+            continue;
+
+        grow = max(pool->size * 2, pool->size +
+                   ((size + XWL_SHM_POOL_SIZE - 1) & ~(size_t) (XWL_SHM_POOL_SIZE - 1)));
+        grow = min(grow, pool->reserved);
+        if (xwl_shm_pool_grow(pool, grow) &&
+            xwl_shm_pool_alloc(pool, size, offset))
+            return pool;
+    }
+
+    pool = xwl_shm_pool_create(xwl_screen, XWL_SHM_POOL_SIZE,
+                               XWL_SHM_POOL_RESERVE);
+    if (pool && !xwl_shm_pool_alloc(pool, size, offset)) {
+        xwl_shm_pool_destroy(pool);
+        pool = NULL;
+    }
+
+    return pool;
+}
+
+static void
+xwl_shm_release(struct xwl_shm_pool *pool, size_t offset, size_t size)
+{
+    struct xwl_shm_range *range;
+
+    range = xwl_shm_pool_add_range(pool, offset, size);
+
+    /* Keep the first shared pool mapped for the next allocation, so
+     * that a client creating and destroying a single window does not
+     * go back to creating a file every time.
+     */
+    if (--pool->nslices == 0 &&
+        !(pool->xwl_screen && pool->reserved == XWL_SHM_POOL_RESERVE &&
+          pool == xorg_list_first_entry(&pool->xwl_screen->shm_pools,
+                                        struct xwl_shm_pool, link))) {
+        xwl_shm_pool_destroy(pool);
+        return;
+    }
+
+    if (range && pool->size > XWL_SHM_POOL_SIZE)
+        xwl_shm_pool_punch_hole(pool, range, offset, size);
+}
+
+void
+xwl_shm_close_screen(struct xwl_screen *xwl_screen)
+{
+    struct xwl_shm_pool *pool, *next;
+
+    /* Pixmaps still using a pool may outlive the screen and the Wayland
+     * connection, so only the empty pools go now; the others are
+     * detached and freed along with their last pixmap.
+     */
+    xorg_list_for_each_entry_safe(pool, next, &xwl_screen->shm_pools, link) {
+        if (pool->nslices == 0) {
+            xwl_shm_pool_destroy(pool);
+            continue;
+        }
+
+        wl_shm_pool_destroy(pool->pool);
+        pool->pool = NULL;
+        pool->xwl_screen = NULL;
+        xorg_list_del(&pool->link);
+        xorg_list_init(&pool->link);
+    }
+}
+
 static const struct wl_buffer_listener xwl_shm_buffer_listener = {
     xwl_pixmap_buffer_release_cb,
 };
@@ -223,11 +541,9 @@ xwl_shm_create_pixmap(ScreenPtr screen,
 {
     struct xwl_screen *xwl_screen = xwl_screen_get(screen);
     struct xwl_pixmap *xwl_pixmap;
-    struct wl_shm_pool *pool;
     PixmapPtr pixmap;
     size_t size, stride;
     uint32_t format;
-    int fd;
 
     if (hint == CREATE_PIXMAP_USAGE_GLYPH_PICTURE ||
         (!xwl_screen->rootless && hint != CREATE_PIXMAP_USAGE_BACKING_PIXMAP) ||
@@ -244,30 +560,26 @@ xwl_shm_create_pixmap(ScreenPtr screen,
 
     stride = PixmapBytePad(width, depth);
     size = stride * height;
+    size = (size + XWL_SHM_SLICE_ALIGN - 1) & ~(size_t) (XWL_SHM_SLICE_ALIGN - 1);
     xwl_pixmap->buffer = NULL;
     xwl_pixmap->size = size;
-    fd = os_create_anonymous_file(size);
-    if (fd < 0)
+    xwl_pixmap->pool = xwl_shm_alloc(xwl_screen, size, &xwl_pixmap->offset);
+    if (xwl_pixmap->pool == NULL)
         goto err_free_xwl_pixmap;
 
-    xwl_pixmap->data = mmap(NULL, size, PROT_READ | PROT_WRITE,
-                                  MAP_SHARED, fd, 0);
-    if (xwl_pixmap->data == MAP_FAILED)
-        goto err_close_fd;
+    xwl_pixmap->data = xwl_pixmap->pool->data + xwl_pixmap->offset;
 
     if (!(*screen->ModifyPixmapHeader) (pixmap, width, height, depth,
                                         BitsPerPixel(depth),
                                         stride, xwl_pixmap->data))
-        goto err_munmap;
+        goto err_release;
 
     format = shm_format_for_depth(pixmap->drawable.depth);
-    pool = wl_shm_create_pool(xwl_screen->shm, fd, xwl_pixmap->size);
-    xwl_pixmap->buffer = wl_shm_pool_create_buffer(pool, 0,
+    xwl_pixmap->buffer = wl_shm_pool_create_buffer(xwl_pixmap->pool->pool,
+                                                   xwl_pixmap->offset,
                                                    pixmap->drawable.width,
                                                    pixmap->drawable.height,
                                                    pixmap->devKind, format);
-    wl_shm_pool_destroy(pool);
-    close(fd);
 
     wl_buffer_add_listener(xwl_pixmap->buffer,
                            &xwl_shm_buffer_listener, pixmap);
@@ -276,10 +588,8 @@ xwl_shm_create_pixmap(ScreenPtr screen,
 
     return pixmap;
 
- err_munmap:
-    munmap(xwl_pixmap->data, size);
- err_close_fd:
-    close(fd);
+ err_release:
+    xwl_shm_release(xwl_pixmap->pool, xwl_pixmap->offset, size);
  err_free_xwl_pixmap:
     free(xwl_pixmap);
  err_destroy_pixmap:
@@ -297,7 +607,8 @@ xwl_shm_destroy_pixmap(PixmapPtr pixmap)
         xwl_pixmap_del_buffer_release_cb(pixmap);
         if (xwl_pixmap->buffer)
             wl_buffer_destroy(xwl_pixmap->buffer);
-        munmap(xwl_pixmap->data, xwl_pixmap->size);
+        xwl_shm_release(xwl_pixmap->pool, xwl_pixmap->offset,
+                        xwl_pixmap->size);
         free(xwl_pixmap);
     }
 
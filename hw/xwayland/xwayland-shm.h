@@ -32,10 +32,13 @@
 #include "scrnintstr.h"
 #include "pixmapstr.h"
 
+#include "xwayland-types.h"
+
 Bool xwl_shm_create_screen_resources(ScreenPtr screen);
 PixmapPtr xwl_shm_create_pixmap(ScreenPtr screen, int width, int height,
                                 int depth, unsigned int hint);
 Bool xwl_shm_destroy_pixmap(PixmapPtr pixmap);
 struct wl_buffer *xwl_shm_pixmap_get_wl_buffer(PixmapPtr pixmap);
+void xwl_shm_close_screen(struct xwl_screen *xwl_screen);
 
 #endif /* XWAYLAND_SHM_H */
@@ -34,11 +34,15 @@
 #include "xwayland-window-buffers.h"
 
 #define BUFFER_TIMEOUT 1 * 1000 /* ms */
+#define BUFFER_TIMEOUT_MIN 50 /* ms */
+#define BUFFER_EXPIRY_FRAMES 8
+/* Log the copy rate over all windows at verbosity 5, at most this often */
+#define BUFFER_STATS_INTERVAL 10 * 1000 /* ms */
 
 struct xwl_window_buffer {
     struct xwl_window *xwl_window;
     PixmapPtr pixmap;
-    RegionPtr damage_region;
+    uint32_t frame;     /* window frame the pixmap contents match */
     Bool recycle_on_release;
     int refcnt;
     uint32_t time;
@@ -68,6 +72,63 @@ copy_pixmap_area(PixmapPtr src_pixmap, PixmapPtr dst_pixmap,
     return FALSE;
 }
 
+static size_t
+copy_pixmap_region(PixmapPtr src_pixmap, PixmapPtr dst_pixmap,
+                   RegionPtr region, int dx, int dy)
+{
+    BoxPtr pBox = RegionRects(region);
+    int nBox = RegionNumRects(region);
+    size_t bytes = 0;
+    GCPtr pGC;
+
+    if (!nBox)
+        return 0;
+
+    pGC = GetScratchGC(dst_pixmap->drawable.depth,
+                       dst_pixmap->drawable.pScreen);
+    if (!pGC)
+        return (size_t) -1;
+
+    ValidateGC(&dst_pixmap->drawable, pGC);
+    while (nBox--) {
+        (void) (*pGC->ops->CopyArea) (&src_pixmap->drawable,
+                                      &dst_pixmap->drawable,
+                                      pGC,
+                                      pBox->x1 + dx, pBox->y1 + dy,
+                                      pBox->x2 - pBox->x1,
+                                      pBox->y2 - pBox->y1,
+                                      pBox->x1 + dx, pBox->y1 + dy);
+        bytes += (size_t) (pBox->x2 - pBox->x1) * (pBox->y2 - pBox->y1) *
+            dst_pixmap->drawable.bitsPerPixel / 8;
+        pBox++;
+    }
+    FreeScratchGC(pGC);
+
+    return bytes;
+}
+
+static void
+xwl_window_buffers_report_copied(size_t bytes)
+{
+    static uint64_t total, last_total;
+    static uint32_t last_time;
+    uint32_t now = GetTimeInMillis();
+    uint32_t elapsed = now - last_time;
+
+    total += bytes;
+    if (elapsed < BUFFER_STATS_INTERVAL)
+        return;
+
+    if (last_time)
+        LogMessageVerb(X_INFO, 5,
+                       "xwayland: window buffers: %llu KB/s copied, "
+                       "%llu KB in total\n",
+                       (unsigned long long) (total - last_total) / elapsed,
+                       (unsigned long long) total / 1024);
+    last_total = total;
+    last_time = now;
+}
+
 static struct xwl_window_buffer *
 xwl_window_buffer_new(struct xwl_window *xwl_window)
 {
@@ -78,7 +139,6 @@ xwl_window_buffer_new(struct xwl_window *xwl_window)
         return NULL;
 
     xwl_window_buffer->xwl_window = xwl_window;
-    xwl_window_buffer->damage_region = RegionCreate(NullBox, 1);
     xwl_window_buffer->pixmap = NullPixmap;
     xwl_window_buffer->refcnt = 1;
 
@@ -106,8 +166,6 @@ xwl_window_buffer_dispose(struct xwl_window_buffer *xwl_window_buffer)
     if (--xwl_window_buffer->refcnt)
         return FALSE;
 
-    RegionDestroy(xwl_window_buffer->damage_region);
-
     if (xwl_window_buffer->pixmap)
         xwl_window_buffer_destroy_pixmap (xwl_window_buffer);
 
@@ -120,34 +178,66 @@ xwl_window_buffer_dispose(struct xwl_window_buffer *xwl_window_buffer)
 static void
 xwl_window_buffer_recycle(struct xwl_window_buffer *xwl_window_buffer)
 {
-    RegionEmpty(xwl_window_buffer->damage_region);
     xwl_window_buffer->recycle_on_release = FALSE;
 
     if (xwl_window_buffer->pixmap)
         xwl_window_buffer_destroy_pixmap (xwl_window_buffer);
 }
 
+/* Collect the damage a buffer last brought up to date at frame
+ * xwl_window_buffer->frame has missed, up to and including the current
+ * frame.  Returns FALSE if that goes further back than the history.
+ */
+static Bool
+xwl_window_buffer_get_damage(struct xwl_window_buffer *xwl_window_buffer,
+                             RegionPtr damage)
+{
+    struct xwl_window *xwl_window = xwl_window_buffer->xwl_window;
+    uint32_t frame = xwl_window->window_buffers_frame;
+    uint32_t age = frame - xwl_window_buffer->frame;
+    uint32_t i;
+
+    if (!xwl_window_buffer->frame || age > XWL_WINDOW_BUFFERS_HISTORY)
+        return FALSE;
+
+    for (i = 0; i < age; i++)
+        RegionUnion(damage, damage,
+                    &xwl_window->window_buffers_damage[(frame - i) %
+                                                       XWL_WINDOW_BUFFERS_HISTORY]);
+
+    return TRUE;
+}
+
 static void
-xwl_window_buffer_add_damage_region(struct xwl_window *xwl_window,
-                                    RegionPtr damage_region)
+xwl_window_buffers_new_frame(struct xwl_window *xwl_window,
+                             RegionPtr damage_region)
 {
-    struct xwl_window_buffer *xwl_window_buffer;
+    uint32_t now = GetTimeInMillis();
+    uint32_t interval;
 
-    /* Add damage region to all buffers */
-    xorg_list_for_each_entry(xwl_window_buffer,
-                             &xwl_window->window_buffers_available,
-                             link_buffer) {
-        RegionUnion(xwl_window_buffer->damage_region,
-                    xwl_window_buffer->damage_region,
-                    damage_region);
-    }
-    xorg_list_for_each_entry(xwl_window_buffer,
-                             &xwl_window->window_buffers_unavailable,
-                             link_buffer) {
-        RegionUnion(xwl_window_buffer->damage_region,
-                    xwl_window_buffer->damage_region,
-                    damage_region);
+    /* Frame 0 means "never synced" for a buffer */
+    if (++xwl_window->window_buffers_frame == 0)
+        xwl_window->window_buffers_frame = 1;
+
+    RegionCopy(&xwl_window->window_buffers_damage[xwl_window->window_buffers_frame %
+                                                  XWL_WINDOW_BUFFERS_HISTORY],
+               damage_region);
+
+    /* Spare buffers expire after a few frames' worth of time, so that a
+     * window drawing fast keeps enough of them around and a slow one
+     * does not hold on to more than it needs.
+     */
+    if (xwl_window->window_buffers_frame_time) {
+        interval = now - xwl_window->window_buffers_frame_time;
+        if (xwl_window->window_buffers_frame_interval)
+            interval = (xwl_window->window_buffers_frame_interval * 7 +
+                        interval) / 8;
+        xwl_window->window_buffers_frame_interval = interval;
+        xwl_window->window_buffers_timeout =
+            min(max(interval * BUFFER_EXPIRY_FRAMES, BUFFER_TIMEOUT_MIN),
+                BUFFER_TIMEOUT);
     }
+    xwl_window->window_buffers_frame_time = now;
 }
 
 static struct xwl_window_buffer *
@@ -161,6 +251,44 @@ xwl_window_buffer_get_available(struct xwl_window *xwl_window)
                                 link_buffer);
 }
 
+static uint32_t
+xwl_window_buffer_timeout(struct xwl_window_buffer *xwl_window_buffer)
+{
+    struct xwl_window *xwl_window = xwl_window_buffer->xwl_window;
+
+    /* The most recently released buffer is the next one to be picked,
+     * keep it for the full timeout so that a window going idle for a bit
+     * does not come back to a full copy into a fresh pixmap.
+     */
+    if (xwl_window_buffer ==
+        xorg_list_last_entry(&xwl_window->window_buffers_available,
+                             struct xwl_window_buffer,
+                             link_buffer) ||
+        !xwl_window->window_buffers_timeout)
+        return BUFFER_TIMEOUT;
+
+    return xwl_window->window_buffers_timeout;
+}
+
+static uint32_t
+xwl_window_buffers_next_expiry(struct xwl_window *xwl_window, uint32_t time)
+{
+    struct xwl_window_buffer *xwl_window_buffer;
+    int32_t next = BUFFER_TIMEOUT;
+
+    xorg_list_for_each_entry(xwl_window_buffer,
+                             &xwl_window->window_buffers_available,
+                             link_buffer) {
+        int32_t left = (int32_t) (xwl_window_buffer->time +
+                                  xwl_window_buffer_timeout(xwl_window_buffer) -
+                                  time);
+        if (left < next)
+            next = left;
+    }
+
+    return max(next, 1);
+}
+
 static CARD32
 xwl_window_buffer_timer_callback(OsTimerPtr timer, CARD32 time, void *arg)
 {
@@ -171,19 +299,14 @@ xwl_window_buffer_timer_callback(OsTimerPtr timer, CARD32 time, void *arg)
     xorg_list_for_each_entry_safe(xwl_window_buffer, tmp,
                                   &xwl_window->window_buffers_available,
                                   link_buffer) {
-        if ((int64_t)(time - xwl_window_buffer->time) >= BUFFER_TIMEOUT)
+        if ((int64_t)(time - xwl_window_buffer->time) >=
+            xwl_window_buffer_timeout(xwl_window_buffer))
             xwl_window_buffer_dispose(xwl_window_buffer);
     }
 
     /* If there are still available buffers, re-arm the timer */
-    if (!xorg_list_is_empty(&xwl_window->window_buffers_available)) {
-        struct xwl_window_buffer *oldest_available_buffer =
-            xorg_list_first_entry(&xwl_window->window_buffers_available,
-                                  struct xwl_window_buffer,
-                                  link_buffer);
-
-        return oldest_available_buffer->time + BUFFER_TIMEOUT - time;
-    }
+    if (!xorg_list_is_empty(&xwl_window->window_buffers_available))
+        return xwl_window_buffers_next_expiry(xwl_window, time);
 
     /* Don't re-arm the timer */
     return 0;
@@ -194,7 +317,7 @@ xwl_window_buffer_release_callback(void *data)
 {
     struct xwl_window_buffer *xwl_window_buffer = data;
     struct xwl_window *xwl_window = xwl_window_buffer->xwl_window;
-    struct xwl_window_buffer *oldest_available_buffer;
+    uint32_t time;
 
     /* Drop the reference on the buffer we took in get_pixmap. If that
      * frees the window buffer, we're done.
@@ -214,18 +337,13 @@ xwl_window_buffer_release_callback(void *data)
     xorg_list_del(&xwl_window_buffer->link_buffer);
     xorg_list_append(&xwl_window_buffer->link_buffer,
                      &xwl_window->window_buffers_available);
-    xwl_window_buffer->time = (uint32_t) GetTimeInMillis();
+    time = (uint32_t) GetTimeInMillis();
+    xwl_window_buffer->time = time;
 
-    oldest_available_buffer =
-        xorg_list_first_entry(&xwl_window->window_buffers_available,
-                             struct xwl_window_buffer,
-                             link_buffer);
-
-    /* Schedule next timer based on time of the oldest buffer */
+    /* Schedule next timer based on the buffer expiring first */
     xwl_window->window_buffers_timer =
-        TimerSet(xwl_window->window_buffers_timer,
-                 TimerAbsolute,
-                 oldest_available_buffer->time + BUFFER_TIMEOUT,
+        TimerSet(xwl_window->window_buffers_timer, 0,
+                 xwl_window_buffers_next_expiry(xwl_window, time),
                  &xwl_window_buffer_timer_callback,
                  xwl_window);
 }
@@ -233,8 +351,13 @@ xwl_window_buffer_release_callback(void *data)
 void
 xwl_window_buffers_init(struct xwl_window *xwl_window)
 {
+    int i;
+
     xorg_list_init(&xwl_window->window_buffers_available);
     xorg_list_init(&xwl_window->window_buffers_unavailable);
+
+    for (i = 0; i < XWL_WINDOW_BUFFERS_HISTORY; i++)
+        RegionNull(&xwl_window->window_buffers_damage[i]);
 }
 
 void
@@ -264,6 +387,7 @@ void
 xwl_window_buffers_dispose(struct xwl_window *xwl_window)
 {
     struct xwl_window_buffer *xwl_window_buffer, *tmp;
+    int i;
 
     /* This is called prior to free the xwl_window, make sure to untie
      * the buffers from the xwl_window so that we don't point at freed
@@ -287,6 +411,18 @@ xwl_window_buffers_dispose(struct xwl_window *xwl_window)
         TimerFree(xwl_window->window_buffers_timer);
         xwl_window->window_buffers_timer = 0;
     }
+
+    for (i = 0; i < XWL_WINDOW_BUFFERS_HISTORY; i++)
+        RegionUninit(&xwl_window->window_buffers_damage[i]);
+
+    if (xwl_window->window_buffers_frame)
+        LogMessageVerb(X_INFO, 5,
+                       "xwayland: window 0x%x: %u frames, "
+                       "%llu bytes copied into buffers\n",
+                       (unsigned int) xwl_window->window->drawable.id,
+                       (unsigned int) xwl_window->window_buffers_frame,
+                       (unsigned long long)
+                       xwl_window->window_buffers_bytes_copied);
 }
 
 PixmapPtr
@@ -296,7 +432,8 @@ xwl_window_buffers_get_pixmap(struct xwl_window *xwl_window,
     struct xwl_screen *xwl_screen = xwl_window->xwl_screen;
     struct xwl_window_buffer *xwl_window_buffer;
     PixmapPtr window_pixmap;
-    RegionPtr full_damage;
+    RegionRec full_damage;
+    size_t bytes;
 
     window_pixmap = (*xwl_screen->screen->GetWindowPixmap) (xwl_window->window);
 
@@ -309,31 +446,28 @@ xwl_window_buffers_get_pixmap(struct xwl_window *xwl_window,
     if (!xwl_window_buffer)
         return window_pixmap;
 
-    xwl_window_buffer_add_damage_region(xwl_window, damage_region);
-
-    full_damage = xwl_window_buffer->damage_region;
-
-    if (xwl_window_buffer->pixmap) {
-        BoxPtr pBox = RegionRects(full_damage);
-        int nBox = RegionNumRects(full_damage);
-        while (nBox--) {
-            if (!copy_pixmap_area(window_pixmap,
-                                  xwl_window_buffer->pixmap,
-                                  pBox->x1 + xwl_window->window->borderWidth,
-                                  pBox->y1 + xwl_window->window->borderWidth,
-                                  pBox->x2 - pBox->x1,
-                                  pBox->y2 - pBox->y1))
-                return window_pixmap;
-
-            pBox++;
-        }
+    xwl_window_buffers_new_frame(xwl_window, damage_region);
+
+    RegionNull(&full_damage);
+    if (xwl_window_buffer->pixmap &&
+        xwl_window_buffer_get_damage(xwl_window_buffer, &full_damage)) {
+        bytes = copy_pixmap_region(window_pixmap, xwl_window_buffer->pixmap,
+                                   &full_damage,
+                                   xwl_window->window->borderWidth,
+                                   xwl_window->window->borderWidth);
+        RegionUninit(&full_damage);
+        if (bytes == (size_t) -1)
+            return window_pixmap;
     } else {
-        xwl_window_buffer->pixmap =
-            (*xwl_screen->screen->CreatePixmap) (window_pixmap->drawable.pScreen,
-                                                 window_pixmap->drawable.width,
-                                                 window_pixmap->drawable.height,
-                                                 window_pixmap->drawable.depth,
-                                                 CREATE_PIXMAP_USAGE_BACKING_PIXMAP);
+        RegionUninit(&full_damage);
+
+        if (!xwl_window_buffer->pixmap)
+            xwl_window_buffer->pixmap =
+                (*xwl_screen->screen->CreatePixmap) (window_pixmap->drawable.pScreen,
+                                                     window_pixmap->drawable.width,
+                                                     window_pixmap->drawable.height,
+                                                     window_pixmap->drawable.depth,
+                                                     CREATE_PIXMAP_USAGE_BACKING_PIXMAP);
 
         if (!xwl_window_buffer->pixmap)
             return window_pixmap;
@@ -346,9 +480,16 @@ xwl_window_buffers_get_pixmap(struct xwl_window *xwl_window,
             xwl_window_buffer_recycle(xwl_window_buffer);
             return window_pixmap;
         }
+        bytes = (size_t) window_pixmap->drawable.height *
+            xwl_window_buffer->pixmap->devKind;
     }
 
-    RegionEmpty(xwl_window_buffer->damage_region);
+    xwl_window_buffer->frame = xwl_window->window_buffers_frame;
+    xwl_window->window_buffers_bytes_copied += bytes;
+    xwl_window_buffers_report_copied(bytes);
+    DebugF("xwayland: window 0x%x frame %u copied %zu bytes\n",
+           (unsigned int) xwl_window->window->drawable.id,
+           (unsigned int) xwl_window->window_buffers_frame, bytes);
 
     /* Hold a reference on the buffer until it's released by the compositor */
     xwl_window_buffer->refcnt++;
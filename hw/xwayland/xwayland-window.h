@@ -37,6 +37,11 @@
 
 #include "xwayland-types.h"
 
+/* Number of past frames whose damage is kept to bring a recycled
+ * window buffer up to date; older buffers get a full copy.
+ */
+#define XWL_WINDOW_BUFFERS_HISTORY 4
+
 struct xwl_window {
     struct xwl_screen *xwl_screen;
     struct wl_surface *surface;
@@ -51,6 +56,12 @@ struct xwl_window {
     struct xorg_list window_buffers_available;
     struct xorg_list window_buffers_unavailable;
     OsTimerPtr window_buffers_timer;
+    RegionRec window_buffers_damage[XWL_WINDOW_BUFFERS_HISTORY];
+    uint32_t window_buffers_frame;
+    uint32_t window_buffers_frame_time;
+    uint32_t window_buffers_frame_interval;
+    uint32_t window_buffers_timeout;
+    uint64_t window_buffers_bytes_copied; /* in total, logged at dispose */
 #ifdef GLAMOR_HAS_GBM
     struct xorg_list frame_callback_list;
     Bool present_flipped;
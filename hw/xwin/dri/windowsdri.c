@@ -80,7 +80,7 @@ ProcWindowsDRIQueryDirectRenderingCapable(ClientPtr client)
     rep.length = 0;
     rep.sequenceNumber = client->sequence;
 
-    if (!client->local)
+    if (!GetClientLocal(client))
         rep.isCapable = 0;
     else
         rep.isCapable = glxWinGetScreenAiglxIsActive(screenInfo.screens[stuff->screen]);
@@ -162,7 +162,7 @@ ProcWindowsDRIDispatch(ClientPtr client)
         return ProcWindowsDRIQueryDirectRenderingCapable(client);
     }
 
-    if (!client->local)
+    if (!GetClientLocal(client))
         return WindowsDRIErrorBase + WindowsDRIClientNotLocal;
 
     switch (stuff->data) {
@@ -237,7 +237,7 @@ SProcWindowsDRIDispatch(ClientPtr client)
         return SProcWindowsDRIQueryDirectRenderingCapable(client);
     }
 
-    if (!client->local)
+    if (!GetClientLocal(client))
         return WindowsDRIErrorBase + WindowsDRIClientNotLocal;
 
     switch (stuff->data) {
@@ -38,6 +38,7 @@ typedef struct {
     pid_t pid;                  /* process ID, -1 if not available */
     const char *cmdname;        /* process name, NULL if not available */
     const char *cmdargs;        /* process arguments, NULL if not available */
+    int cmdDetermined;          /* cmdname and cmdargs have been looked up */
 } ClientIdRec, *ClientIdPtr;
 
 struct _Client;
@@ -82,7 +82,8 @@ typedef struct _Client {
     short index;
     unsigned char majorOp, minorOp;
     unsigned int swapped:1;
-    unsigned int local:1;
+    unsigned int maybeLocal:1;   /* local transport, use GetClientLocal() */
+    unsigned int localChecked:1; /* maybeLocal checked for forwarding */
     unsigned int big_requests:1; /* supports large requests */
     unsigned int clientGone:1;
     unsigned int closeDownMode:2;
@@ -111,6 +112,14 @@ typedef struct _Client {
     DeviceIntPtr clientPtr;
     ClientIdPtr clientIds;
     int req_fds;
+
+    struct _RunQueue *run_queue;        /* scheduler queue, while runnable */
+    CARD64 smart_dispatch_time;         /* microseconds spent in dispatch */
+    struct xorg_list latency;           /* in latency clients list */
+    unsigned char latency_class;        /* LATENCY_CLASS_* reasons */
+    unsigned char latency_throttled;    /* used a whole slice, queue normally */
+    unsigned short latency_grabs;       /* device grabs held */
+    unsigned short latency_policies;    /* policy roles held */
 } ClientRec;
 
 static inline void
@@ -147,6 +156,24 @@ void mark_client_saved_ready(ClientPtr client);
 /* Client has no requests queued and no data on network */
 void mark_client_not_ready(ClientPtr client);
 
+/* Client priority or smart_priority changed */
+void update_client_priority(ClientPtr client);
+
+/*
+ * Clients in the latency class are dispatched ahead of every other
+ * client as soon as they have requests, cutting short the slice of
+ * whichever client is running.  The class is held while any reason
+ * applies.  A client which uses up a whole slice in the class is queued
+ * like any other until it runs out of requests.
+ */
+#define LATENCY_CLASS_POLICY    (1 << 0)  /* window manager, compositor, input method */
+#define LATENCY_CLASS_GRAB      (1 << 1)  /* holds an active device grab */
+#define LATENCY_CLASS_FOCUS     (1 << 2)  /* owns the core keyboard focus */
+
+void SetClientLatencyClass(ClientPtr client, int reason);
+void UnsetClientLatencyClass(ClientPtr client, int reason);
+void SetFocusLatencyClient(ClientPtr client);
+
 static inline Bool client_is_ready(ClientPtr client)
 {
     return !xorg_list_is_empty(&client->ready);
@@ -329,6 +329,8 @@ typedef struct _TouchPointInfo {
     DeviceEvent *history;       /* History of events on this touchpoint */
     size_t history_elements;    /* Number of current elements in history */
     size_t history_size;        /* Size of history in elements */
+    size_t history_first;       /* Ring offset of the oldest TouchUpdate,
+                                 * history[0] is always the TouchBegin */
 } TouchPointInfoRec;
 
 typedef struct _DDXTouchPointInfo {
@@ -340,6 +342,9 @@ typedef struct _DDXTouchPointInfo {
     ValuatorMask *valuators;    /* last axis values as posted, pre-transform */
 } DDXTouchPointInfoRec;
 
+/* Number of entries in the direct-mapped touch id -> slot lookup tables */
+#define TOUCH_INDEX_SIZE 64
+
 typedef struct _TouchClassRec {
     int sourceid;
     TouchPointInfoPtr touches;
@@ -350,6 +355,7 @@ typedef struct _TouchClassRec {
     CARD8 buttonsDown;          /* number of buttons down */
     unsigned short state;       /* logical button state */
     Mask motionMask;
+    int index[TOUCH_INDEX_SIZE]; /* client_id -> touches slot + 1, a hint */
 } TouchClassRec;
 
 typedef struct _GestureListener {
@@ -630,6 +636,14 @@ typedef struct _DeviceIntRec {
     int xtest_master_id;
 
     struct _SyncCounter *idle_counter;
+
+    /* inverse of scale_and_transform */
+    struct pixman_f_transform inverse_scale_and_transform;
+    /* TRUE if the user supplied transform is the identity matrix */
+    Bool transform_is_identity;
+
+    /* ddx_id -> last.touches slot + 1, a hint */
+    int last_touch_index[TOUCH_INDEX_SIZE];
 } DeviceIntRec;
 
 typedef struct {
@@ -72,6 +72,12 @@ extern _X_EXPORT Bool whiteRoot;
 extern _X_EXPORT Bool bgNoneRoot;
 
 extern _X_EXPORT Bool CoreDump;
+extern _X_EXPORT Bool CompressMotionEvents;
+extern _X_EXPORT int DamageCoalesceRects;
+extern _X_EXPORT int FakeScreenRefresh;
+extern _X_EXPORT int WorkerThreads;
+extern _X_EXPORT char *TraceFile;
+extern _X_EXPORT Bool IoUring;
 extern _X_EXPORT Bool NoListenAll;
 
 #endif                          /* OPAQUE_H */
@@ -167,6 +167,8 @@ extern _X_EXPORT void IgnoreClient(ClientPtr /*client */ );
 
 extern _X_EXPORT void AttendClient(ClientPtr /*client */ );
 
+extern void CheckClientInput(ClientPtr /*client */ );
+
 extern _X_EXPORT void MakeClientGrabImpervious(ClientPtr /*client */ );
 
 extern _X_EXPORT void MakeClientGrabPervious(ClientPtr /*client */ );
@@ -433,6 +435,9 @@ GetClientFd(ClientPtr);
 extern _X_EXPORT Bool
 ClientIsLocal(ClientPtr client);
 
+extern _X_EXPORT Bool
+GetClientLocal(ClientPtr client);
+
 extern _X_EXPORT int
 GetAccessControl(void);
 
@@ -561,9 +566,28 @@ extern _X_EXPORT void
 ddxGiveUp(enum ExitCode error);
 extern _X_EXPORT void
 ddxInputThreadInit(void);
+
+/*
+ * Run proc over rows [y1, y2), split into bands across the -workerthreads
+ * threads when bytes (the memory touched) makes it worthwhile.  proc may
+ * only touch the pixels it is given.
+ */
+typedef void (*WorkerBandProcPtr) (void *closure, int y1, int y2);
+
+extern _X_EXPORT void
+WorkerRunBands(int y1, int y2, size_t bytes, WorkerBandProcPtr proc,
+               void *closure);
 extern _X_EXPORT int
 TimeSinceLastInputEvent(void);
 
+/* Binary protocol trace, see -tracefile */
+extern _X_EXPORT Bool TraceActive;
+
+extern _X_EXPORT void
+TraceInit(void);
+extern _X_EXPORT void
+TraceRequest(ClientPtr client, int result, CARD64 start);
+
 /* Function fallbacks provided by AC_REPLACE_FUNCS in configure.ac */
 
 #ifndef HAVE_REALLOCARRAY
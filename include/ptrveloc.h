@@ -57,7 +57,7 @@ typedef double (*PointerAccelerationProfileFunc)
  * a more or less straight line
  */
 typedef struct _MotionTracker {
-    double dx, dy;              /* accumulated delta for each axis */
+    double x, y;                /* accumulated motion at time of creation */
     int time;                   /* time of creation */
     int dir;                    /* initial direction bitfield */
 } MotionTracker, *MotionTrackerPtr;
@@ -69,6 +69,8 @@ typedef struct _DeviceVelocityRec {
     MotionTrackerPtr tracker;
     int num_tracker;
     int cur_tracker;            /* current index */
+    double motion_x;            /* motion accumulated since the trackers */
+    double motion_y;            /* were last rebased, see FeedTrackers */
     double velocity;            /* velocity as guessed by algorithm */
     double last_velocity;       /* previous velocity estimate */
     double last_dx;             /* last time-difference */
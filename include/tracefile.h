@@ -0,0 +1,71 @@
+/*
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE COPYRIGHT HOLDER(S) OR AUTHOR(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS
+ * SOFTWARE.
+ */
+
+/*
+ * Layout of the file written by the -tracefile option: a header followed
+ * by a ring of fixed size records.  Only fixed width types are used so
+ * that tools can read traces without the server headers.
+ */
+
+#ifndef TRACEFILE_H
+#define TRACEFILE_H
+
+#include <stdint.h>
+
+#define TRACE_MAGIC             0x43525458      /* "XTRC" */
+#define TRACE_VERSION           1
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t header_size;
+    uint32_t record_size;
+    uint64_t nrecords;          /* records in the ring, a power of two */
+    uint64_t head;              /* records written so far */
+} TraceHeaderRec;
+
+/* Record kinds */
+#define TRACE_REQUEST           1
+#define TRACE_REPLY             2
+#define TRACE_EVENT             3
+#define TRACE_ERROR             4
+
+/*
+ * Requests carry the opcodes, the request length, the time spent in the
+ * request handler and its result.  Replies and errors carry the opcodes
+ * of the request they answer, errors store the error code in result.
+ * Events store the event type in major, and for GenericEvents the
+ * extension opcode in result and the event type in minor.
+ */
+typedef struct {
+    uint64_t time;              /* microseconds, as GetTimeInMicros() */
+    uint32_t duration;          /* microseconds, requests only */
+    uint32_t length;            /* bytes */
+    uint32_t sequence;          /* client sequence number */
+    uint16_t client;            /* client index */
+    uint8_t kind;
+    uint8_t major;
+    uint16_t minor;
+    uint16_t result;
+    uint32_t pad;
+} TraceRecordRec;
+
+#endif                          /* TRACEFILE_H */
@@ -195,6 +195,10 @@ extern _X_EXPORT Bool PointInWindowIsVisible(WindowPtr /*pWin */ ,
 
 extern _X_EXPORT RegionPtr NotClippedByChildren(WindowPtr /*pWin */ );
 
+extern _X_EXPORT RegionPtr GetNotClippedByChildren(WindowPtr /*pWin */ );
+
+extern _X_EXPORT void InvalidateNotClippedByChildren(WindowPtr /*pWin */ );
+
 extern _X_EXPORT void SendVisibilityNotify(WindowPtr /*pWin */ );
 
 extern _X_EXPORT int dixSaveScreens(ClientPtr client, int on, int mode);
@@ -138,6 +138,8 @@ typedef struct _Window {
     union _Validate *valdata;
     RegionRec winSize;
     RegionRec borderSize;
+    RegionPtr notClipped;       /* cached NotClippedByChildren */
+    unsigned long notClippedSerial;     /* serial the cache was built at */
     DDXPointRec origin;         /* position relative to parent */
     unsigned short borderWidth;
     unsigned short deliverableEvents;   /* all masks from all clients */
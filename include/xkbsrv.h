@@ -197,6 +197,8 @@ typedef struct _XkbSrvInfo {
     XkbSrvCheckRepeatPtr checkRepeat;
 
     char overlay_perkey_state[256/8]; /* bitfield */
+
+    int nFilters;               /* filters in use, all above are inactive */
 } XkbSrvInfoRec, *XkbSrvInfoPtr;
 
 #define	XkbSLI_IsDefault	(1L<<0)
@@ -205,6 +205,8 @@ extern _X_EXPORT void mieqProcessDeviceEvent(DeviceIntPtr /* dev */ ,
 extern _X_EXPORT void mieqProcessInputEvents(void
     );
 
+extern _X_EXPORT unsigned long mieqGetCompressedMotionCount(void);
+
 extern _X_EXPORT void mieqAddCallbackOnDrained(CallbackProcPtr callback,
                                                void *param);
 
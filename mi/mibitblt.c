@@ -115,8 +115,11 @@ miCopyArea(DrawablePtr pSrcDrawable,
     }
     else {
         if (pGC->subWindowMode == IncludeInferiors) {
-            prgnSrcClip = NotClippedByChildren((WindowPtr) pSrcDrawable);
-            realSrcClip = 1;
+            prgnSrcClip = GetNotClippedByChildren((WindowPtr) pSrcDrawable);
+            if (!prgnSrcClip) {
+                prgnSrcClip = NotClippedByChildren((WindowPtr) pSrcDrawable);
+                realSrcClip = 1;
+            }
         }
         else
             prgnSrcClip = &((WindowPtr) pSrcDrawable)->clipList;
@@ -548,10 +551,11 @@ miCopyPlane(DrawablePtr pSrcDrawable,
         /* clip to visible drawable */
 
         if (pGC->subWindowMode == IncludeInferiors) {
-            RegionPtr clipList = NotClippedByChildren((WindowPtr) pSrcDrawable);
+            RegionPtr clipList =
+                GetNotClippedByChildren((WindowPtr) pSrcDrawable);
 
-            RegionIntersect(prgnSrc, prgnSrc, clipList);
-            RegionDestroy(clipList);
+            if (clipList)
+                RegionIntersect(prgnSrc, prgnSrc, clipList);
         }
         else
             RegionIntersect(prgnSrc, prgnSrc,
@@ -188,8 +188,11 @@ miDoCopy(DrawablePtr pSrcDrawable,
                 prgnSrcClip = miGetCompositeClip(pGC);
             }
             else {
-                prgnSrcClip = NotClippedByChildren((WindowPtr) pSrcDrawable);
-                freeSrcClip = TRUE;
+                prgnSrcClip = GetNotClippedByChildren((WindowPtr) pSrcDrawable);
+                if (!prgnSrcClip) {
+                    prgnSrcClip = NotClippedByChildren((WindowPtr) pSrcDrawable);
+                    freeSrcClip = TRUE;
+                }
             }
         }
         else {
@@ -53,6 +53,7 @@ in this Software without prior written authorization from The Open Group.
 #include   "extinit.h"
 #include   "exglobals.h"
 #include   "eventstr.h"
+#include   "opaque.h"
 
 #ifdef DPMSExtension
 #include "dpmsproc.h"
@@ -82,6 +83,7 @@ typedef struct _EventQueue {
     EventRec *events;           /* our queue as an array */
     size_t nevents;             /* the number of buckets in our queue */
     size_t dropped;             /* counter for number of consecutive dropped events */
+    unsigned long compressed;   /* motion events merged into a later one */
     mieqHandler handlers[128];  /* custom event handler */
 } EventQueueRec, *EventQueuePtr;
 
@@ -509,6 +511,91 @@ mieqProcessDeviceEvent(DeviceIntPtr dev, InternalEvent *event, ScreenPtr screen)
     }
 }
 
+/**
+ * Try to fold the motion event just taken off the queue into the next
+ * motion event from the same device.
+ *
+ * Only raw motion events from the same device may sit between the two,
+ * anything else (other devices, button or key events, screen changes)
+ * counts as an intervening state change and the event is processed
+ * normally.  Raw events are left in the queue so XI2 raw listeners still
+ * see every one of them, and the motion history was already updated when
+ * the event was generated.
+ *
+ * Valuators set in the dropped event but not in the later one are copied
+ * over so the later event reports every axis that changed.
+ *
+ * Pre-condition: Called with input_lock held
+ *
+ * @return TRUE if the event was merged and must not be processed.
+ */
+static Bool
+mieqCompressMotion(EventQueuePtr eventQueue, EventRec *e)
+{
+    DeviceEvent *ev = &e->events->device_event;
+    HWEventQueueType i;
+
+    if (!CompressMotionEvents || ev->type != ET_Motion ||
+        eventQueue->handlers[ET_Motion])
+        return FALSE;
+
+    for (i = eventQueue->head; i != eventQueue->tail;
+         i = (i + 1) % eventQueue->nevents) {
+        EventRec *next = &eventQueue->events[i];
+        DeviceEvent *nev = &next->events->device_event;
+        int j;
+
+        if (next->pDev != e->pDev)
+            return FALSE;
+
+        if (nev->type == ET_RawMotion)
+            continue;
+
+        if (nev->type != ET_Motion || next->pScreen != e->pScreen ||
+            nev->flags != ev->flags || nev->root != ev->root ||
+            memcmp(nev->buttons, ev->buttons, sizeof(ev->buttons)) != 0)
+            return FALSE;
+
+        for (j = 0; j < MAX_VALUATORS; j++) {
+            if (!BitIsOn(ev->valuators.mask, j) ||
+                BitIsOn(nev->valuators.mask, j))
+                continue;
+
+            SetBit(nev->valuators.mask, j);
+            if (BitIsOn(ev->valuators.mode, j))
+                SetBit(nev->valuators.mode, j);
+            else
+                ClearBit(nev->valuators.mode, j);
+            nev->valuators.data[j] = ev->valuators.data[j];
+        }
+
+        /* mieqEnqueue would overwrite the merged event if it is last */
+        if ((i + 1) % eventQueue->nevents == eventQueue->tail)
+            eventQueue->lastMotion = 0;
+
+        eventQueue->compressed++;
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
+/**
+ * @return The number of motion events merged by the motion compression
+ * since the server started.
+ */
+unsigned long
+mieqGetCompressedMotionCount(void)
+{
+    unsigned long count;
+
+    input_lock();
+    count = miEventQueue.compressed;
+    input_unlock();
+
+    return count;
+}
+
 /* Call this from ProcessInputEvents(). */
 void
 mieqProcessInputEvents(void)
@@ -546,6 +633,9 @@ mieqProcessInputEvents(void)
 
         miEventQueue.head = (miEventQueue.head + 1) % miEventQueue.nevents;
 
+        if (mieqCompressMotion(&miEventQueue, e))
+            continue;
+
         input_unlock();
 
         master = (dev) ? GetMaster(dev, MASTER_ATTACHED) : NULL;
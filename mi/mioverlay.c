@@ -708,6 +708,7 @@ miOverlayMarkUnrealizedWindow(WindowPtr pChild,
         if (pChild->drawable.pScreen->ClipNotify)
             (*pChild->drawable.pScreen->ClipNotify) (pChild, 0, 0);
         RegionEmpty(&pChild->borderClip);
+        InvalidateNotClippedByChildren(pChild);
         if ((pTree = MIOVERLAY_GET_WINDOW_TREE(pChild))) {
             if (pTree->valdata != (miOverlayValDataPtr) UnmapValData) {
                 RegionEmpty(&pTree->clipList);
@@ -693,6 +693,7 @@ miValidateTree(WindowPtr pParent,       /* Parent to validate */
                 if (pScreen->ClipNotify)
                     (*pScreen->ClipNotify) (pWin, 0, 0);
                 RegionEmpty(&pWin->borderClip);
+                InvalidateNotClippedByChildren(pWin);
                 pWin->valdata = NULL;
             }
         }
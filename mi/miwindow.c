@@ -742,6 +742,7 @@ miMarkUnrealizedWindow(WindowPtr pChild, WindowPtr pWin, Bool fromConfigure)
         if (pChild->drawable.pScreen->ClipNotify)
             (*pChild->drawable.pScreen->ClipNotify) (pChild, 0, 0);
         RegionEmpty(&pChild->borderClip);
+        InvalidateNotClippedByChildren(pChild);
     }
 }
 
@@ -121,6 +121,157 @@ getDrawableDamageRef(DrawablePtr pDrawable)
     DamagePtr	*pPrev = (DamagePtr *) \
 	dixLookupPrivateAddr(&(pWindow)->devPrivates, damageWinPrivateKey)
 
+#define damageTileCount(n) (((n) + DAMAGE_TILE_SIZE - 1) / DAMAGE_TILE_SIZE)
+
+/*
+ * DamageReportTiled keeps a bitmap of DAMAGE_TILE_SIZE tiles covering the
+ * drawable (including the border of windows) instead of an exact region.
+ * Marking is a handful of bit operations per box, the bitmap is folded into
+ * pDamage->damage only when somebody looks at the region.
+ */
+static void
+damageTilesFlush(DamagePtr pDamage)
+{
+    int nTilesWide, nTilesHigh, tx, ty, start, n;
+    BoxPtr boxes, pBox;
+    RegionRec tileRegion;
+
+    if (!pDamage->tilesSet)
+        return;
+
+    nTilesWide = damageTileCount(pDamage->tileWidth);
+    nTilesHigh = damageTileCount(pDamage->tileHeight);
+
+    /* at most one box for every other tile in a row */
+    boxes = xallocarray(nTilesHigh * ((nTilesWide + 1) / 2), sizeof(BoxRec));
+    if (!boxes) {
+        BoxRec box;
+
+        box.x1 = pDamage->tileX;
+        box.y1 = pDamage->tileY;
+        box.x2 = pDamage->tileX + pDamage->tileWidth;
+        box.y2 = pDamage->tileY + pDamage->tileHeight;
+        RegionInit(&tileRegion, &box, 1);
+        n = 0;
+    }
+    else {
+        n = 0;
+        for (ty = 0; ty < nTilesHigh; ty++) {
+            CARD32 *row = pDamage->tiles + ty * pDamage->tileStride;
+
+            for (tx = 0; tx < nTilesWide; tx++) {
+                if (!(row[tx / 32] & (1U << (tx % 32)))) {
+                    if (tx % 32 == 0 && row[tx / 32] == 0)
+                        tx += 31;
+                    continue;
+                }
+                start = tx;
+                while (tx + 1 < nTilesWide &&
+                       (row[(tx + 1) / 32] & (1U << ((tx + 1) % 32))))
+                    tx++;
+
+                pBox = &boxes[n++];
+                pBox->x1 = pDamage->tileX + start * DAMAGE_TILE_SIZE;
+                pBox->x2 = pDamage->tileX +
+                    min((tx + 1) * DAMAGE_TILE_SIZE, pDamage->tileWidth);
+                pBox->y1 = pDamage->tileY + ty * DAMAGE_TILE_SIZE;
+                pBox->y2 = pDamage->tileY +
+                    min((ty + 1) * DAMAGE_TILE_SIZE, pDamage->tileHeight);
+            }
+        }
+        RegionInitBoxes(&tileRegion, boxes, n);
+        free(boxes);
+    }
+
+    RegionUnion(&pDamage->damage, &pDamage->damage, &tileRegion);
+    RegionUninit(&tileRegion);
+
+    memset(pDamage->tiles, 0,
+           pDamage->tileStride * nTilesHigh * sizeof(CARD32));
+    pDamage->tilesSet = FALSE;
+}
+
+static void
+damageTilesFree(DamagePtr pDamage)
+{
+    damageTilesFlush(pDamage);
+    free(pDamage->tiles);
+    pDamage->tiles = NULL;
+}
+
+static Bool
+damageTilesMark(DamagePtr pDamage, RegionPtr pRegion)
+{
+    DrawablePtr pDrawable = pDamage->pDrawable;
+    int x, y, w, h, bw = 0;
+    BoxPtr pBox;
+    int nBox;
+
+    if (!pDrawable)
+        return FALSE;
+
+    if (pDrawable->type == DRAWABLE_WINDOW)
+        bw = ((WindowPtr) pDrawable)->borderWidth;
+    x = -bw;
+    y = -bw;
+    w = pDrawable->width + 2 * bw;
+    h = pDrawable->height + 2 * bw;
+    if (w <= 0 || h <= 0)
+        return FALSE;
+
+    /* (re)create the grid when the drawable changed size */
+    if (!pDamage->tiles ||
+        x != pDamage->tileX || y != pDamage->tileY ||
+        w != pDamage->tileWidth || h != pDamage->tileHeight) {
+        damageTilesFree(pDamage);
+        pDamage->tileStride = (damageTileCount(w) + 31) / 32;
+        pDamage->tiles = calloc(pDamage->tileStride * damageTileCount(h),
+                                sizeof(CARD32));
+        if (!pDamage->tiles)
+            return FALSE;
+        pDamage->tileX = x;
+        pDamage->tileY = y;
+        pDamage->tileWidth = w;
+        pDamage->tileHeight = h;
+    }
+
+    pBox = RegionRects(pRegion);
+    nBox = RegionNumRects(pRegion);
+    while (nBox--) {
+        int x1 = max(pBox->x1, x) - x;
+        int y1 = max(pBox->y1, y) - y;
+        int x2 = min(pBox->x2, x + w) - x;
+        int y2 = min(pBox->y2, y + h) - y;
+        int tx, ty;
+
+        pBox++;
+        if (x1 >= x2 || y1 >= y2)
+            continue;
+
+        for (ty = y1 / DAMAGE_TILE_SIZE; ty <= (y2 - 1) / DAMAGE_TILE_SIZE; ty++) {
+            CARD32 *row = pDamage->tiles + ty * pDamage->tileStride;
+
+            for (tx = x1 / DAMAGE_TILE_SIZE;
+                 tx <= (x2 - 1) / DAMAGE_TILE_SIZE; tx++)
+                row[tx / 32] |= 1U << (tx % 32);
+        }
+        pDamage->tilesSet = TRUE;
+    }
+
+    return TRUE;
+}
+
+/* Add pRegion to the accumulated damage */
+static void
+damageUnion(DamagePtr pDamage, RegionPtr pRegion)
+{
+    if (pDamage->damageLevel == DamageReportTiled &&
+        damageTilesMark(pDamage, pRegion))
+        return;
+
+    RegionUnion(&pDamage->damage, &pDamage->damage, pRegion);
+}
+
 #if DAMAGE_DEBUG_ENABLE
 static void
 _damageRegionAppend(DrawablePtr pDrawable, RegionPtr pRegion, Bool clip,
@@ -172,9 +323,9 @@ damageRegionAppend(DrawablePtr pDrawable, RegionPtr pRegion, Bool clip,
         }
         else if (subWindowMode == IncludeInferiors) {
             RegionPtr pTempRegion =
-                NotClippedByChildren((WindowPtr) (pDrawable));
-            RegionIntersect(pRegion, pRegion, pTempRegion);
-            RegionDestroy(pTempRegion);
+                GetNotClippedByChildren((WindowPtr) (pDrawable));
+            if (pTempRegion)
+                RegionIntersect(pRegion, pRegion, pTempRegion);
         }
         /* If subWindowMode is set to an invalid value, don't perform
          * any drawable-based clipping. */
@@ -265,7 +416,7 @@ damageRegionAppend(DrawablePtr pDrawable, RegionPtr pRegion, Bool clip,
             if (pDamage->damageReport)
                 DamageReportDamage(pDamage, pDamageRegion);
             else
-                RegionUnion(&pDamage->damage, &pDamage->damage, pDamageRegion);
+                damageUnion(pDamage, pDamageRegion);
         }
 
         /*
@@ -293,8 +444,7 @@ damageRegionProcessPending(DrawablePtr pDrawable)
             if (pDamage->damageReport)
                 DamageReportDamage(pDamage, &pDamage->pendingDamage);
             else
-                RegionUnion(&pDamage->damage, &pDamage->damage,
-                            &pDamage->pendingDamage);
+                damageUnion(pDamage, &pDamage->pendingDamage);
         }
 
         if (pDamage->reportAfter)
@@ -1822,6 +1972,7 @@ DamageUnregister(DamagePtr pDamage)
         }
 #endif
     }
+    damageTilesFree(pDamage);
     pDamage->pDrawable = 0;
     damageRemoveDamage(getDrawableDamageRef(pDrawable), pDamage);
 }
@@ -1839,6 +1990,7 @@ DamageDestroy(DamagePtr pDamage)
     if (pDamage->damageDestroy)
         (*pDamage->damageDestroy) (pDamage, pDamage->closure);
     (*pScrPriv->funcs.Destroy) (pDamage);
+    free(pDamage->tiles);
     RegionUninit(&pDamage->damage);
     RegionUninit(&pDamage->pendingDamage);
     free(pDamage);
@@ -1851,6 +2003,7 @@ DamageSubtract(DamagePtr pDamage, const RegionPtr pRegion)
     RegionRec pixmapClip;
     DrawablePtr pDrawable = pDamage->pDrawable;
 
+    damageTilesFlush(pDamage);
     RegionSubtract(&pDamage->damage, &pDamage->damage, pRegion);
     if (pDrawable) {
         if (pDrawable->type == DRAWABLE_WINDOW)
@@ -1877,12 +2030,18 @@ DamageSubtract(DamagePtr pDamage, const RegionPtr pRegion)
 void
 DamageEmpty(DamagePtr pDamage)
 {
+    if (pDamage->tilesSet) {
+        memset(pDamage->tiles, 0, pDamage->tileStride *
+               damageTileCount(pDamage->tileHeight) * sizeof(CARD32));
+        pDamage->tilesSet = FALSE;
+    }
     RegionEmpty(&pDamage->damage);
 }
 
 RegionPtr
 DamageRegion(DamagePtr pDamage)
 {
+    damageTilesFlush(pDamage);
     return &pDamage->damage;
 }
 
@@ -1970,5 +2129,15 @@ DamageReportDamage(DamagePtr pDamage, RegionPtr pDamageRegion)
     case DamageReportNone:
         RegionUnion(&pDamage->damage, &pDamage->damage, pDamageRegion);
         break;
+    case DamageReportTiled:
+        was_empty = !pDamage->tilesSet && !RegionNotEmpty(&pDamage->damage);
+        damageUnion(pDamage, pDamageRegion);
+        if (was_empty && pDamage->damageReport &&
+            (pDamage->tilesSet || RegionNotEmpty(&pDamage->damage))) {
+            damageTilesFlush(pDamage);
+            (*pDamage->damageReport) (pDamage, &pDamage->damage,
+                                      pDamage->closure);
+        }
+        break;
     }
 }
@@ -34,9 +34,13 @@ typedef enum _damageReportLevel {
     DamageReportDeltaRegion,
     DamageReportBoundingBox,
     DamageReportNonEmpty,
-    DamageReportNone
+    DamageReportNone,
+    DamageReportTiled
 } DamageReportLevel;
 
+/* Size of the tiles damage is rounded to with DamageReportTiled */
+#define DAMAGE_TILE_SIZE 64
+
 typedef void (*DamageReportFunc) (DamagePtr pDamage, RegionPtr pRegion,
                                   void *closure);
 typedef void (*DamageDestroyFunc) (DamagePtr pDamage, void *closure);
@@ -49,6 +49,14 @@ typedef struct _damage {
     Bool reportAfter;
     RegionRec pendingDamage;    /* will be flushed post submission at the latest */
     ScreenPtr pScreen;
+
+    /* DamageReportTiled: one bit per DAMAGE_TILE_SIZE square, folded into
+     * damage when the region is asked for */
+    CARD32 *tiles;
+    int tileStride;             /* CARD32 per row of tiles */
+    int tileX, tileY;           /* drawable relative origin of the grid */
+    int tileWidth, tileHeight;  /* grid size in pixels */
+    Bool tilesSet;              /* any bit set in tiles */
 } DamageRec;
 
 typedef struct _damageScrPriv {
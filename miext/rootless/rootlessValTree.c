@@ -513,6 +513,7 @@ RootlessMiValidateTree(WindowPtr pRoot, /* Parent to validate */
                 if (pScreen->ClipNotify)
                     (*pScreen->ClipNotify) (pWin, 0, 0);
                 RegionEmpty(&pWin->borderClip);
+                InvalidateNotClippedByChildren(pWin);
                 pWin->valdata = NULL;
             }
         }
@@ -47,10 +47,20 @@ struct _SyncObject {
     Bool beingDestroyed;        /* in process of going away */
 };
 
+/* Triggers on a counter sharing one kind of test, sorted by test value */
+typedef struct _SyncTriggerIndex {
+    struct _SyncTrigger **triggers;
+    int num;
+    int size;
+} SyncTriggerIndex;
+
+#define SYNC_NUM_TEST_TYPES	4
+
 typedef struct _SyncCounter {
     SyncObject sync;            /* Common sync object data */
     int64_t value;              /* counter value */
     struct _SysCounterInfo *pSysCounterInfo; /* NULL if not a system counter */
+    SyncTriggerIndex index[SYNC_NUM_TEST_TYPES]; /* by XSync test type */
 } SyncCounter;
 
 struct _SyncFence {
@@ -71,6 +81,8 @@ struct _SyncTrigger {
                          int64_t newval);
     void (*TriggerFired)(struct _SyncTrigger *pTrigger);
     void (*CounterDestroyed)(struct _SyncTrigger *pTrigger);
+    int index_type;             /* counter index holding us, -1 if none */
+    int64_t index_value;        /* test_value we are sorted under there */
 };
 
 typedef struct _SyncTriggerList {
@@ -145,6 +145,41 @@ check_timers(void)
     return -1;
 }
 
+/* Log poll and client I/O rates at verbosity 5, at most this often */
+#define POLL_STATS_INTERVAL     (10 * MILLI_PER_SECOND)
+
+static void
+ReportPollStats(void)
+{
+    static struct ospoll_stats last;
+    static ClientIoStatsRec last_io;
+    static CARD32 last_time;
+    struct ospoll_stats stats;
+    CARD32 now = GetTimeInMillis();
+    CARD32 elapsed = now - last_time;
+
+    if (elapsed < POLL_STATS_INTERVAL)
+        return;
+
+    ospoll_get_stats(server_poll, &stats);
+    if (last_time) {
+        LogMessageVerb(X_INFO, 5,
+                       "poll: %lu ctl/s, %lu waits/s, %lu events/s\n",
+                       (stats.ctl - last.ctl) * 1000 / elapsed,
+                       (stats.wait - last.wait) * 1000 / elapsed,
+                       (stats.events - last.events) * 1000 / elapsed);
+        LogMessageVerb(X_INFO, 5,
+                       "client io: %lu reads/s, %lu writes/s, "
+                       "%lu io_uring submits/s\n",
+                       (ClientIoStats.reads - last_io.reads) * 1000 / elapsed,
+                       (ClientIoStats.writes - last_io.writes) * 1000 / elapsed,
+                       (ClientIoStats.submits - last_io.submits) * 1000 / elapsed);
+    }
+    last = stats;
+    last_io = ClientIoStats;
+    last_time = now;
+}
+
 /*****************
  * WaitForSomething:
  *     Make the server suspend until there is
@@ -207,6 +242,8 @@ WaitForSomething(Bool are_ready)
         else
             i = ospoll_wait(server_poll, timeout);
         pollerr = GetErrno();
+        ReadAheadClients();
+        ReportPollStats();
         WakeupHandler(i);
         if (i <= 0) {           /* An error or timeout occurred */
             if (dispatchException)
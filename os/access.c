@@ -1117,15 +1117,12 @@ xtransLocalClient(ClientPtr client)
     return FALSE;
 }
 
-/* Is client on the local host */
-Bool
-ComputeLocalClient(ClientPtr client)
+/* Is the client ssh, forwarding a connection from another host */
+static Bool
+ClientIsForwarded(ClientPtr client)
 {
     const char *cmdname = GetClientCmdName(client);
 
-    if (!xtransLocalClient(client))
-        return FALSE;
-
     /* If the executable name is "ssh", assume that this client connection
      * is forwarded from another host via SSH
      */
@@ -1139,9 +1136,9 @@ ComputeLocalClient(ClientPtr client)
         char *tok = strtok(cmd, ":");
 
 #if !defined(WIN32) || defined(__CYGWIN__)
-        ret = strcmp(basename(tok), "ssh") != 0;
+        ret = strcmp(basename(tok), "ssh") == 0;
 #else
-        ret = strcmp(tok, "ssh") != 0;
+        ret = strcmp(tok, "ssh") == 0;
 #endif
 
         free(cmd);
@@ -1149,7 +1146,33 @@ ComputeLocalClient(ClientPtr client)
         return ret;
     }
 
-    return TRUE;
+    return FALSE;
+}
+
+/* Is client on the local host */
+Bool
+ComputeLocalClient(ClientPtr client)
+{
+    return xtransLocalClient(client);
+}
+
+/*
+ * Is client on the local host, and not forwarded from elsewhere?  The
+ * forwarding check needs the client's executable name, which costs file
+ * I/O on most systems, so it is only done the first time this is asked
+ * rather than for every connection.  Until then client->maybeLocal only
+ * reflects the transport; it is not called "local" any more so that code
+ * still reading the field directly fails to build.
+ */
+Bool
+GetClientLocal(ClientPtr client)
+{
+    if (client->maybeLocal && !client->localChecked) {
+        client->localChecked = TRUE;
+        if (ClientIsForwarded(client))
+            client->maybeLocal = FALSE;
+    }
+    return client->maybeLocal;
 }
 
 /*
@@ -1285,7 +1308,7 @@ AuthorizedClient(ClientPtr client)
     if (rc != Success)
         return rc;
 
-    return client->local ? Success : BadAccess;
+    return GetClientLocal(client) ? Success : BadAccess;
 }
 
 /* Add a host to the access control list.  This is the external interface
@@ -109,9 +109,8 @@ DetermineClientPid(struct _Client * client)
 /**
  * Try to determine a command line string for a client based on its
  * PID. Note that mapping PID to a command hasn't been implemented for
- * some operating systems. This should be called only once when a new
- * client has connected, use GetClientCmdName/Args to determine the
- * string at other times.
+ * some operating systems. Use GetClientCmdName/Args to get the string
+ * for a connected client; they call this the first time they are asked.
  *
  * @param[in]  pid     Process ID of a client.
 
@@ -267,8 +266,35 @@ DetermineClientCmd(pid_t pid, const char **cmdname, const char **cmdargs)
 #endif
 }
 
+/**
+ * Look up the command name and arguments of a client the first time
+ * they are needed. Reading them means file I/O on most systems, which
+ * would otherwise slow down every connection, while only a few clients
+ * ever get asked about.
+ *
+ * @param[in] client Client whose PID has been already cached.
+ */
+static void
+DetermineClientCmdLazily(struct _Client *client)
+{
+    ClientIdPtr ids = client->clientIds;
+
+    if (ids->cmdDetermined)
+        return;
+
+    ids->cmdDetermined = TRUE;
+    if (ids->pid != -1)
+        DetermineClientCmd(ids->pid, &ids->cmdname, &ids->cmdargs);
+
+    DebugF("client(%lx): Determined cmdname(%s) and cmdargs(%s).\n",
+           (unsigned long) client->clientAsMask,
+           ids->cmdname ? ids->cmdname : "NULL",
+           ids->cmdargs ? ids->cmdargs : "NULL");
+}
+
 /**
  * Called when a new client connects. Allocates client ID information.
+ * Only the PID is determined here, see DetermineClientCmdLazily.
  *
  * @param[in] client Recently connected client.
  */
@@ -285,16 +311,9 @@ ReserveClientIds(struct _Client *client)
         return;
 
     client->clientIds->pid = DetermineClientPid(client);
-    if (client->clientIds->pid != -1)
-        DetermineClientCmd(client->clientIds->pid, &client->clientIds->cmdname,
-                           &client->clientIds->cmdargs);
 
     DebugF("client(%lx): Reserved pid(%d).\n",
            (unsigned long) client->clientAsMask, client->clientIds->pid);
-    DebugF("client(%lx): Reserved cmdname(%s) and cmdargs(%s).\n",
-           (unsigned long) client->clientAsMask,
-           client->clientIds->cmdname ? client->clientIds->cmdname : "NULL",
-           client->clientIds->cmdargs ? client->clientIds->cmdargs : "NULL");
 #endif                          /* CLIENTIDS */
 }
 
@@ -353,10 +372,10 @@ GetClientPid(struct _Client *client)
 }
 
 /**
- * Get cached command name string of a client.
+ * Get cached command name string of a client, looking it up on first
+ * use.
  *
- * param[in] client Client whose command line string has been already
- *                  cached.
+ * param[in] client Connected client.
  *
  * @return Cached client command name. Error (NULL) if called:
  *         - before ClientStateInitial client state notification
@@ -375,14 +394,15 @@ GetClientCmdName(struct _Client *client)
     if (!client->clientIds)
         return NULL;
 
+    DetermineClientCmdLazily(client);
     return client->clientIds->cmdname;
 }
 
 /**
- * Get cached command arguments string of a client.
+ * Get cached command arguments string of a client, looking it up on
+ * first use.
  *
- * param[in] client Client whose command line string has been already
- *                  cached.
+ * param[in] client Connected client.
  *
  * @return Cached client command arguments. Error (NULL) if called:
  *         - before ClientStateInitial client state notification
@@ -401,5 +421,6 @@ GetClientCmdArgs(struct _Client *client)
     if (!client->clientIds)
         return NULL;
 
+    DetermineClientCmdLazily(client);
     return client->clientIds->cmdargs;
 }
@@ -106,6 +106,7 @@ SOFTWARE.
 #include "opaque.h"
 #include "dixstruct.h"
 #include "xace.h"
+#include "xserver_poll.h"
 
 #define Pid_t pid_t
 
@@ -145,6 +146,12 @@ set_poll_client(ClientPtr client);
 static void
 set_poll_clients(void);
 
+/* OsCommRecs of recently closed connections, reused for new ones */
+#define OS_COMM_CACHE_SIZE      16
+
+static OsCommPtr os_comm_cache[OS_COMM_CACHE_SIZE];
+static int os_comm_cache_count;
+
 static XtransConnInfo *ListenTransConns = NULL;
 static int *ListenTransFds = NULL;
 static int ListenTransCount;
@@ -279,6 +286,7 @@ CreateWellKnownSockets(void)
         int fd = _XSERVTransGetConnectionNumber(ListenTransConns[i]);
 
         ListenTransFds[i] = fd;
+        _XSERVTransSetOption(ListenTransConns[i], TRANS_NONBLOCKING, 1);
         SetNotifyFd(fd, EstablishNewConnections, X_NOTIFY_READ, NULL);
 
         if (!_XSERVTransIsLocal(ListenTransConns[i]))
@@ -310,6 +318,8 @@ ResetWellKnownSockets(void)
     int i;
 
     ResetOsBuffers();
+    while (os_comm_cache_count)
+        free(os_comm_cache[--os_comm_cache_count]);
 
     for (i = 0; i < ListenTransCount; i++) {
         int status = _XSERVTransResetListener(ListenTransConns[i]);
@@ -335,6 +345,7 @@ ResetWellKnownSockets(void)
                 int newfd = _XSERVTransGetConnectionNumber(ListenTransConns[i]);
 
                 ListenTransFds[i] = newfd;
+                _XSERVTransSetOption(ListenTransConns[i], TRANS_NONBLOCKING, 1);
             }
         }
     }
@@ -599,22 +610,34 @@ ClientReady(int fd, int xevents, void *data)
         CloseDownClient(client);
         return;
     }
-    if (xevents & X_NOTIFY_READ)
+    if (xevents & X_NOTIFY_READ) {
         mark_client_ready(client);
+        QueueReadAhead(client);
+    }
     if (xevents & X_NOTIFY_WRITE) {
         ospoll_mute(server_poll, fd, X_NOTIFY_WRITE);
         NewOutputPending = TRUE;
     }
 }
 
+static void
+FreeOsComm(OsCommPtr oc)
+{
+    if (os_comm_cache_count < OS_COMM_CACHE_SIZE)
+        os_comm_cache[os_comm_cache_count++] = oc;
+    else
+        free(oc);
+}
+
 static ClientPtr
 AllocNewConnection(XtransConnInfo trans_conn, int fd, CARD32 conn_time)
 {
     OsCommPtr oc;
     ClientPtr client;
 
-    oc = malloc(sizeof(OsCommRec));
-    if (!oc)
+    if (os_comm_cache_count)
+        oc = os_comm_cache[--os_comm_cache_count];
+    else if (!(oc = malloc(sizeof(OsCommRec))))
         return NullClient;
     oc->trans_conn = trans_conn;
     oc->fd = fd;
@@ -624,10 +647,10 @@ AllocNewConnection(XtransConnInfo trans_conn, int fd, CARD32 conn_time)
     oc->conn_time = conn_time;
     oc->flags = 0;
     if (!(client = NextAvailableClient((void *) oc))) {
-        free(oc);
+        FreeOsComm(oc);
         return NullClient;
     }
-    client->local = ComputeLocalClient(client);
+    client->maybeLocal = ComputeLocalClient(client);
     ospoll_add(server_poll, fd,
                ospoll_trigger_edge,
                ClientReady,
@@ -649,8 +672,13 @@ AllocNewConnection(XtransConnInfo trans_conn, int fd, CARD32 conn_time)
  * EstablishNewConnections
  *    If anyone is waiting on listened sockets, accept them. Drop pending
  *    connections if they've stuck around for more than one minute.
+ *    The backlog is drained here, up to MaxAcceptBatch connections per
+ *    wakeup to keep existing clients from being starved by a connection
+ *    storm.  Readiness is checked before every further accept, as xtrans
+ *    logs each failed one.
  *****************/
 #define TimeOutValue 60 * MILLI_PER_SECOND
+#define MaxAcceptBatch 32
 static void
 EstablishNewConnections(int curconn, int ready, void *data)
 {
@@ -660,6 +688,7 @@ EstablishNewConnections(int curconn, int ready, void *data)
     ClientPtr client;
     OsCommPtr oc;
     XtransConnInfo trans_conn, new_trans_conn;
+    struct pollfd pfd;
     int status;
 
     connect_time = GetTimeInMillis();
@@ -677,20 +706,29 @@ EstablishNewConnections(int curconn, int ready, void *data)
     if ((trans_conn = lookup_trans_conn(curconn)) == NULL)
         return;
 
-    if ((new_trans_conn = _XSERVTransAccept(trans_conn, &status)) == NULL)
-        return;
+    pfd.fd = curconn;
+    pfd.events = POLLIN;
+    for (i = 0; i < MaxAcceptBatch; i++) {
+        if (i > 0) {
+            pfd.revents = 0;
+            if (xserver_poll(&pfd, 1, 0) <= 0 || !(pfd.revents & POLLIN))
+                return;
+        }
+
+        if ((new_trans_conn = _XSERVTransAccept(trans_conn, &status)) == NULL)
+            return;
 
-    newconn = _XSERVTransGetConnectionNumber(new_trans_conn);
+        newconn = _XSERVTransGetConnectionNumber(new_trans_conn);
 
-    _XSERVTransSetOption(new_trans_conn, TRANS_NONBLOCKING, 1);
+        _XSERVTransSetOption(new_trans_conn, TRANS_NONBLOCKING, 1);
 
-    if (trans_conn->flags & TRANS_NOXAUTH)
-        new_trans_conn->flags = new_trans_conn->flags | TRANS_NOXAUTH;
+        if (trans_conn->flags & TRANS_NOXAUTH)
+            new_trans_conn->flags = new_trans_conn->flags | TRANS_NOXAUTH;
 
-    if (!AllocNewConnection(new_trans_conn, newconn, connect_time)) {
-        ErrorConnMax(new_trans_conn);
+        if (!AllocNewConnection(new_trans_conn, newconn, connect_time)) {
+            ErrorConnMax(new_trans_conn);
+        }
     }
-    return;
 }
 
 #define NOROOM "Maximum number of clients reached"
@@ -782,7 +820,7 @@ CloseDownConnection(ClientPtr client)
 	FlushClient(client, oc, (char *) NULL, 0);
     CloseDownFileDescriptor(oc);
     FreeOsBuffers(oc);
-    free(client->osPrivate);
+    FreeOsComm(oc);
     client->osPrivate = (void *) NULL;
     if (auditTrailLevel > 1)
         AuditF("client %d disconnected\n", client->index);
@@ -946,6 +984,26 @@ AttendClient(ClientPtr client)
     }
 }
 
+/*
+ * Check for data from a client without waiting for the main poll, so a
+ * latency class client can be noticed while another client is running.
+ */
+void
+CheckClientInput(ClientPtr client)
+{
+    OsCommPtr oc = (OsCommPtr) client->osPrivate;
+    struct pollfd pfd;
+
+    if (client->clientGone || oc->fd < 0 || !listen_to_client(client))
+        return;
+
+    pfd.fd = oc->fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    if (xserver_poll(&pfd, 1, 0) > 0 && (pfd.revents & POLLIN))
+        mark_client_ready(client);
+}
+
 /* make client impervious to grabs; assume only executing client calls this */
 
 void
@@ -1025,6 +1083,7 @@ ListenOnOpenFD(int fd, int noxauth)
     ListenTransConns[ListenTransCount] = ciptr;
     ListenTransFds[ListenTransCount] = fd;
 
+    _XSERVTransSetOption(ciptr, TRANS_NONBLOCKING, 1);
     SetNotifyFd(fd, EstablishNewConnections, X_NOTIFY_READ, NULL);
 
     /* Increment the count */
@@ -69,6 +69,7 @@ SOFTWARE.
 #include <errno.h>
 #if !defined(WIN32)
 #include <sys/uio.h>
+#include <sys/socket.h>
 #endif
 #include <X11/X.h>
 #include <X11/Xproto.h>
@@ -100,6 +101,13 @@ typedef struct _connectionOutput {
 
 static ConnectionInputPtr AllocateInputBuffer(void);
 static ConnectionOutputPtr AllocateOutputBuffer(void);
+static void ReleaseOutputBuffer(OsCommPtr oc);
+static int FlushClientOutput(ClientPtr who, OsCommPtr oc,
+                             const void *extraBuf, int extraCount,
+                             Bool callback);
+#ifndef WIN32
+static void FlushClientsBatched(void);
+#endif
 
 static Bool CriticalOutputPending;
 static int timesThisConnection = 0;
@@ -107,6 +115,8 @@ static ConnectionInputPtr FreeInputs = (ConnectionInputPtr) NULL;
 static ConnectionOutputPtr FreeOutputs = (ConnectionOutputPtr) NULL;
 static OsCommPtr AvailableInput = (OsCommPtr) NULL;
 
+ClientIoStatsRec ClientIoStats;
+
 #define get_req_len(req,cli) ((cli)->swapped ? \
 			      bswap_16((req)->length) : (req)->length)
 
@@ -349,6 +359,7 @@ ReadRequestFromClient(ClientPtr client)
             YieldControlDeath();
             return -1;
         }
+        ClientIoStats.reads++;
         result = _XSERVTransRead(oc->trans_conn, oci->buffer + oci->bufcnt,
                                  oci->size - oci->bufcnt);
         if (result <= 0) {
@@ -594,6 +605,221 @@ ResetCurrentRequest(ClientPtr client)
     }
 }
 
+/*****************
+ * Batched transfers
+ *    With -iouring, reads for the clients that one ospoll_wait found
+ *    ready, and the writes of one FlushAllOutput, each go to the kernel
+ *    in a single io_uring submission.  Only the common cases are handled
+ *    here: transfers that fail other than on a full socket, and output
+ *    carrying file descriptors, are left to the plain code above, which
+ *    runs into the same condition and deals with it.
+ *****************/
+
+#ifndef WIN32
+
+#define MAX_RECV_FDS    128     /* as many as xtrans accepts */
+
+typedef struct {
+    ClientPtr client;
+    struct iovec iov;
+    struct msghdr msg;
+#if XTRANS_SEND_FDS
+    union {
+        struct cmsghdr hdr;
+        char buf[CMSG_SPACE(MAX_RECV_FDS * sizeof(int))];
+    } cmsg;
+#endif
+} ClientTransferRec;
+
+static ClientTransferRec client_transfers[IO_URING_BATCH];
+static ClientPtr read_ahead_clients[IO_URING_BATCH];
+static int read_ahead_count;
+static ClientPtr flush_clients[IO_URING_BATCH];
+static int flush_count;
+
+static ClientTransferRec *
+SetupClientTransfer(int n, ClientPtr client, void *buf, size_t len)
+{
+    ClientTransferRec *t = &client_transfers[n];
+
+    t->client = client;
+    t->iov.iov_base = buf;
+    t->iov.iov_len = len;
+    memset(&t->msg, 0, sizeof(t->msg));
+    t->msg.msg_iov = &t->iov;
+    t->msg.msg_iovlen = 1;
+    return t;
+}
+
+/* Called for each client marked ready by ospoll_wait */
+void
+QueueReadAhead(ClientPtr client)
+{
+    OsCommPtr oc = (OsCommPtr) client->osPrivate;
+
+    if ((oc->flags & OS_COMM_READ_AHEAD) ||
+        read_ahead_count == IO_URING_BATCH || !IoUringAvailable())
+        return;
+    oc->flags |= OS_COMM_READ_AHEAD;
+    read_ahead_clients[read_ahead_count++] = client;
+}
+
+void
+ReadAheadClients(void)
+{
+    int results[IO_URING_BATCH];
+    int i, n = 0;
+
+    for (i = 0; i < read_ahead_count; i++) {
+        ClientPtr client = read_ahead_clients[i];
+        OsCommPtr oc = (OsCommPtr) client->osPrivate;
+        ConnectionInputPtr oci = oc->input;
+        ClientTransferRec *t;
+
+        oc->flags &= ~OS_COMM_READ_AHEAD;
+        if (!oc->trans_conn)
+            continue;
+
+        if (!oci) {
+            if ((oci = FreeInputs))
+                FreeInputs = oci->next;
+            else if (!(oci = AllocateInputBuffer()))
+                continue;
+            oc->input = oci;
+        }
+        if (oci->ignoreBytes)
+            continue;
+
+        /* The buffer is about to be filled, don't hand it to someone else */
+        if (AvailableInput == oc)
+            AvailableInput = NULL;
+
+        if (oci->bufptr + oci->lenLastReq == oci->buffer + oci->bufcnt) {
+            oci->bufptr = oci->buffer;
+            oci->bufcnt = 0;
+            oci->lenLastReq = 0;
+        }
+        if (oci->size - oci->bufcnt < sizeof(xReq))
+            continue;
+
+        t = SetupClientTransfer(n++, client, oci->buffer + oci->bufcnt,
+                                oci->size - oci->bufcnt);
+#if XTRANS_SEND_FDS
+        t->msg.msg_control = t->cmsg.buf;
+        t->msg.msg_controllen = sizeof(t->cmsg.buf);
+#endif
+        IoUringQueueMsg(oc->fd, &t->msg, FALSE);
+    }
+    read_ahead_count = 0;
+    if (!n)
+        return;
+
+    ClientIoStats.submits++;
+    IoUringSubmit(results);
+
+    for (i = 0; i < n; i++) {
+        ClientTransferRec *t = &client_transfers[i];
+        OsCommPtr oc = (OsCommPtr) t->client->osPrivate;
+
+        /* end of file and errors are for ReadRequestFromClient to find */
+        if (results[i] <= 0)
+            continue;
+        oc->input->bufcnt += results[i];
+#if XTRANS_SEND_FDS
+        TransConnRecvFds(oc->trans_conn, &t->msg);
+#endif
+    }
+}
+
+static void
+FlushedToClient(ClientPtr who, OsCommPtr oc, int written)
+{
+    ConnectionOutputPtr oco = oc->output;
+
+    if (written < oco->count) {
+        /* the client is not keeping up; send the rest when it drains */
+        oco->count -= written;
+        memmove(oco->buf, oco->buf + written, oco->count);
+        output_pending_mark(who);
+        ospoll_listen(server_poll, oc->fd, X_NOTIFY_WRITE);
+        return;
+    }
+    oco->count = 0;
+    output_pending_clear(who);
+    ReleaseOutputBuffer(oc);
+}
+
+static void
+FlushClientsBatched(void)
+{
+    int results[IO_URING_BATCH];
+    ClientPtr plain[IO_URING_BATCH];
+    int nplain = 0;
+    int i, n = 0;
+
+    /* FlushCallback users may still add output, so run them all before
+     * looking at any buffer
+     */
+    if (FlushCallback)
+        for (i = 0; i < flush_count; i++)
+            CallCallbacks(&FlushCallback, flush_clients[i]);
+
+    for (i = 0; i < flush_count; i++) {
+        ClientPtr who = flush_clients[i];
+        OsCommPtr oc = (OsCommPtr) who->osPrivate;
+        ConnectionOutputPtr oco = oc->output;
+        ClientTransferRec *t;
+
+        if (who->clientGone || !oc->trans_conn || !oco || !oco->count)
+            continue;
+#if XTRANS_SEND_FDS
+        if (TransConnHasSendFds(oc->trans_conn)) {
+            plain[nplain++] = who;
+            continue;
+        }
+#endif
+        t = SetupClientTransfer(n++, who, oco->buf, oco->count);
+        IoUringQueueMsg(oc->fd, &t->msg, TRUE);
+    }
+    flush_count = 0;
+
+    if (n) {
+        ClientIoStats.submits++;
+        IoUringSubmit(results);
+    }
+
+    for (i = 0; i < n; i++) {
+        ClientPtr who = client_transfers[i].client;
+        OsCommPtr oc = (OsCommPtr) who->osPrivate;
+
+        if (results[i] >= 0)
+            FlushedToClient(who, oc, results[i]);
+        else if (ETEST(-results[i]))
+            FlushedToClient(who, oc, 0);
+        else
+            plain[nplain++] = who;
+    }
+
+    /* FlushCallback has already run for these */
+    for (i = 0; i < nplain; i++)
+        (void) FlushClientOutput(plain[i], (OsCommPtr) plain[i]->osPrivate,
+                                 NULL, 0, FALSE);
+}
+
+#else /* WIN32 */
+
+void
+QueueReadAhead(ClientPtr client)
+{
+}
+
+void
+ReadAheadClients(void)
+{
+}
+
+#endif
+
  /********************
  * FlushAllOutput()
  *    Flush all clients with output.  However, if some client still
@@ -627,10 +853,20 @@ FlushAllOutput(void)
             continue;
         if (!client_is_ready(client)) {
             oc = (OsCommPtr) client->osPrivate;
+#ifndef WIN32
+            if (flush_count < IO_URING_BATCH && IoUringAvailable()) {
+                flush_clients[flush_count++] = client;
+                continue;
+            }
+#endif
             (void) FlushClient(client, oc, (char *) NULL, 0);
         } else
             NewOutputPending = TRUE;
     }
+#ifndef WIN32
+    if (flush_count)
+        FlushClientsBatched();
+#endif
 }
 
 void
@@ -822,7 +1058,15 @@ WriteToClient(ClientPtr who, int count, const void *__buf)
  **********************/
 
 int
-FlushClient(ClientPtr who, OsCommPtr oc, const void *__extraBuf, int extraCount)
+FlushClient(ClientPtr who, OsCommPtr oc, const void *extraBuf, int extraCount)
+{
+    return FlushClientOutput(who, oc, extraBuf, extraCount, TRUE);
+}
+
+/* FlushClient(), optionally without running FlushCallback first */
+static int
+FlushClientOutput(ClientPtr who, OsCommPtr oc, const void *__extraBuf,
+                  int extraCount, Bool callback)
 {
     ConnectionOutputPtr oco = oc->output;
     XtransConnInfo trans_conn = oc->trans_conn;
@@ -842,7 +1086,7 @@ FlushClient(ClientPtr who, OsCommPtr oc, const void *__extraBuf, int extraCount)
     if (!notWritten)
         return 0;
 
-    if (FlushCallback)
+    if (callback && FlushCallback)
         CallCallbacks(&FlushCallback, who);
 
     todo = notWritten;
@@ -884,6 +1128,7 @@ FlushClient(ClientPtr who, OsCommPtr oc, const void *__extraBuf, int extraCount)
             InsertIOV(padBuffer, padsize)
 
             errno = 0;
+        ClientIoStats.writes++;
         if (trans_conn && (len = _XSERVTransWritev(trans_conn, iov, i)) >= 0) {
             written += len;
             notWritten -= len;
@@ -959,16 +1204,7 @@ FlushClient(ClientPtr who, OsCommPtr oc, const void *__extraBuf, int extraCount)
     /* everything was flushed out */
     oco->count = 0;
     output_pending_clear(who);
-
-    if (oco->size > BUFWATERMARK) {
-        free(oco->buf);
-        free(oco);
-    }
-    else {
-        oco->next = FreeOutputs;
-        FreeOutputs = oco;
-    }
-    oc->output = (ConnectionOutputPtr) NULL;
+    ReleaseOutputBuffer(oc);
     return extraCount;          /* return only the amount explicitly requested */
 }
 
@@ -1011,6 +1247,23 @@ AllocateOutputBuffer(void)
     return oco;
 }
 
+/* Keep an emptied output buffer for reuse, unless it grew too big */
+static void
+ReleaseOutputBuffer(OsCommPtr oc)
+{
+    ConnectionOutputPtr oco = oc->output;
+
+    if (oco->size > BUFWATERMARK) {
+        free(oco->buf);
+        free(oco);
+    }
+    else {
+        oco->next = FreeOutputs;
+        FreeOutputs = oco;
+    }
+    oc->output = (ConnectionOutputPtr) NULL;
+}
+
 void
 FreeOsBuffers(OsCommPtr oc)
 {
@@ -1019,6 +1272,18 @@ FreeOsBuffers(OsCommPtr oc)
 
     if (AvailableInput == oc)
         AvailableInput = (OsCommPtr) NULL;
+#ifndef WIN32
+    if (oc->flags & OS_COMM_READ_AHEAD) {
+        int i;
+
+        for (i = 0; i < read_ahead_count; i++)
+            if (read_ahead_clients[i]->osPrivate == oc) {
+                read_ahead_clients[i] = read_ahead_clients[--read_ahead_count];
+                break;
+            }
+        oc->flags &= ~OS_COMM_READ_AHEAD;
+    }
+#endif
     if ((oci = oc->input)) {
         if (FreeInputs) {
             free(oci->buffer);
@@ -0,0 +1,276 @@
+/* iouring.c -- Batch client socket transfers through io_uring.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE COPYRIGHT HOLDER(S) OR AUTHOR(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS
+ * SOFTWARE.
+ */
+
+#ifdef HAVE_DIX_CONFIG_H
+#include <dix-config.h>
+#endif
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "misc.h"
+#include "os.h"
+#include "opaque.h"
+#include "osdep.h"
+
+/*
+ * A bare io_uring used in one way only: queue up to IO_URING_BATCH
+ * sendmsg/recvmsg operations, then submit them and wait for all of them
+ * in a single io_uring_enter.  Sockets are non-blocking and every
+ * operation carries MSG_DONTWAIT, so the kernel finishes them inline
+ * and the wait returns at once.  Everything runs on the main thread.
+ *
+ * The kernel is asked which operations it supports before the ring is
+ * used.  Without sendmsg and recvmsg there is no point, and transfers
+ * failing with EINVAL one by one would only be slower than plain calls.
+ */
+
+#if defined(HAVE_LINUX_IO_URING_H) && !defined(WIN32)
+
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter) && \
+    defined(__NR_io_uring_register) && defined(IO_URING_OP_SUPPORTED)
+#define IO_URING        1
+#endif
+
+#endif
+
+#if IO_URING
+
+static int ring_fd = -1;
+static Bool ring_failed;
+
+static unsigned *sq_tail, *sq_mask, *sq_array;
+static unsigned *cq_head, *cq_tail, *cq_mask;
+static struct io_uring_sqe *sqes;
+static struct io_uring_cqe *cqes;
+static unsigned sq_local_tail;
+static int queued;
+
+/* Does the kernel support every operation we queue? */
+static Bool
+IoUringProbe(void)
+{
+    static const int ops[] = { IORING_OP_SENDMSG, IORING_OP_RECVMSG };
+    struct io_uring_probe *probe;
+    Bool ok = TRUE;
+    int i;
+
+    /* The kernel insists on a zeroed buffer */
+    probe = calloc(1, sizeof(*probe) +
+                   IORING_OP_LAST * sizeof(struct io_uring_probe_op));
+    if (!probe)
+        return FALSE;
+
+    if (syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_PROBE,
+                probe, IORING_OP_LAST) < 0)
+        ok = FALSE;
+    for (i = 0; ok && i < ARRAY_SIZE(ops); i++) {
+        if (ops[i] > probe->last_op ||
+            !(probe->ops[ops[i]].flags & IO_URING_OP_SUPPORTED)) {
+            errno = EOPNOTSUPP;
+            ok = FALSE;
+        }
+    }
+    free(probe);
+    return ok;
+}
+
+static Bool
+IoUringSetup(void)
+{
+    struct io_uring_params p;
+    size_t sq_size, cq_size;
+    char *sq, *cq;
+
+    memset(&p, 0, sizeof(p));
+    ring_fd = syscall(__NR_io_uring_setup, IO_URING_BATCH, &p);
+    if (ring_fd < 0)
+        return FALSE;
+    if (!IoUringProbe())
+        goto bail;
+
+    sq_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    cq_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    if (p.features & IORING_FEAT_SINGLE_MMAP)
+        sq_size = cq_size = max(sq_size, cq_size);
+
+    sq = mmap(NULL, sq_size, PROT_READ | PROT_WRITE,
+              MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+    if (sq == MAP_FAILED)
+        goto bail;
+    if (p.features & IORING_FEAT_SINGLE_MMAP)
+        cq = sq;
+    else {
+        cq = mmap(NULL, cq_size, PROT_READ | PROT_WRITE,
+                  MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+        if (cq == MAP_FAILED)
+            goto bail;
+    }
+    sqes = mmap(NULL, p.sq_entries * sizeof(struct io_uring_sqe),
+                PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                ring_fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED)
+        goto bail;
+
+    sq_tail = (unsigned *) (sq + p.sq_off.tail);
+    sq_mask = (unsigned *) (sq + p.sq_off.ring_mask);
+    sq_array = (unsigned *) (sq + p.sq_off.array);
+    cq_head = (unsigned *) (cq + p.cq_off.head);
+    cq_tail = (unsigned *) (cq + p.cq_off.tail);
+    cq_mask = (unsigned *) (cq + p.cq_off.ring_mask);
+    cqes = (struct io_uring_cqe *) (cq + p.cq_off.cqes);
+    sq_local_tail = *sq_tail;
+    return TRUE;
+
+ bail:
+    /* the mappings are dropped with the process; this happens once */
+    close(ring_fd);
+    ring_fd = -1;
+    return FALSE;
+}
+
+Bool
+IoUringAvailable(void)
+{
+    if (!IoUring || ring_failed)
+        return FALSE;
+    if (ring_fd < 0 && !IoUringSetup()) {
+        LogMessage(X_WARNING, "io_uring: not available (%s), "
+                   "using plain socket calls\n", strerror(errno));
+        ring_failed = TRUE;
+        return FALSE;
+    }
+    return TRUE;
+}
+
+void
+IoUringQueueMsg(int fd, struct msghdr *msg, Bool send)
+{
+    unsigned index = sq_local_tail & *sq_mask;
+    struct io_uring_sqe *sqe = &sqes[index];
+
+    BUG_RETURN(queued >= IO_URING_BATCH);
+
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = send ? IORING_OP_SENDMSG : IORING_OP_RECVMSG;
+    sqe->fd = fd;
+    sqe->addr = (unsigned long) msg;
+    sqe->len = 1;
+    sqe->msg_flags = MSG_DONTWAIT | (send ? MSG_NOSIGNAL : 0);
+    sqe->user_data = queued;
+    sq_array[index] = index;
+    sq_local_tail++;
+    queued++;
+}
+
+static int
+IoUringEnter(unsigned submit, unsigned wait)
+{
+    int ret;
+
+    do {
+        ret = syscall(__NR_io_uring_enter, ring_fd, submit, wait,
+                      IORING_ENTER_GETEVENTS, NULL, 0);
+    } while (ret < 0 && errno == EINTR);
+    return ret;
+}
+
+int
+IoUringSubmit(int *results)
+{
+    int submitted, reaped = 0;
+    int i;
+
+    if (!queued)
+        return 0;
+
+    for (i = 0; i < queued; i++)
+        results[i] = -ECANCELED;
+
+    __atomic_store_n(sq_tail, sq_local_tail, __ATOMIC_RELEASE);
+    submitted = IoUringEnter(queued, queued);
+    if (submitted < 0)
+        submitted = 0;
+
+    while (reaped < submitted) {
+        unsigned head = *cq_head;
+        unsigned tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+
+        if (head == tail) {
+            if (IoUringEnter(0, submitted - reaped) < 0)
+                break;
+            continue;
+        }
+        while (head != tail) {
+            struct io_uring_cqe *cqe = &cqes[head & *cq_mask];
+
+            if (cqe->user_data < (unsigned) queued)
+                results[cqe->user_data] = cqe->res;
+            head++;
+            reaped++;
+        }
+        __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+    }
+
+    /*
+     * Whatever the kernel did not take is still in the ring and would
+     * go out with the next batch, long after its buffers have moved.
+     * Don't risk it; let the callers use plain socket calls from now on.
+     */
+    if (submitted < queued || reaped < submitted) {
+        ErrorF("io_uring: only %d of %d transfers completed, disabling\n",
+               reaped, queued);
+        close(ring_fd);
+        ring_fd = -1;
+        ring_failed = TRUE;
+    }
+
+    i = queued;
+    queued = 0;
+    return i;
+}
+
+#else /* IO_URING */
+
+Bool
+IoUringAvailable(void)
+{
+    return FALSE;
+}
+
+void
+IoUringQueueMsg(int fd, struct msghdr *msg, Bool send)
+{
+}
+
+int
+IoUringSubmit(int *results)
+{
+    return 0;
+}
+
+#endif
@@ -89,6 +89,7 @@ OR PERFORMANCE OF THIS SOFTWARE.
 
 #include "input.h"
 #include "opaque.h"
+#include "osdep.h"
 
 #ifdef WIN32
 #include <process.h>
@@ -279,6 +280,10 @@ LogInit(const char *fname, const char *backup)
             fsync(fileno(logFile));
 #endif
         }
+
+        /* Hand further writes to the log thread unless asked to sync */
+        if (!logSync)
+            LogThreadInit(logFileFd);
     }
 
     /*
@@ -330,6 +335,7 @@ LogClose(enum ExitCode error)
 {
     if (logFile) {
         int msgtype = (error == EXIT_NO_ERROR) ? X_INFO : X_ERROR;
+        LogThreadFini();
         LogMessageVerbSigSafe(msgtype, -1,
                 "Server terminated %s (%d). Closing log file.\n",
                 (error == EXIT_NO_ERROR) ? "successfully" : "with error",
@@ -349,6 +355,8 @@ LogSetParameter(LogParameter param, int value)
         return TRUE;
     case XLOG_SYNC:
         logSync = value ? TRUE : FALSE;
+        if (logSync)
+            LogThreadFini();
         return TRUE;
     case XLOG_VERBOSITY:
         logVerbosity = value;
@@ -605,6 +613,8 @@ LogSWrite(int verb, const char *buf, size_t len, Bool end_line)
 
     if (verb < 0 || logFileVerbosity >= verb) {
         if (inSignalContext && logFileFd >= 0) {
+            if (LogThreadWrite(NULL, 0, buf, len))
+                return;
             ret = write(logFileFd, buf, len);
 #ifndef WIN32
             if (logFlush && logSync)
@@ -612,9 +622,16 @@ LogSWrite(int verb, const char *buf, size_t len, Bool end_line)
 #endif
         }
         else if (!inSignalContext && logFile) {
+            char stamp[32];
+            int stamp_len = 0;
+
             if (newline)
-                fprintf(logFile, "[%10.3f] ", GetTimeInMillis() / 1000.0);
+                stamp_len = snprintf(stamp, sizeof(stamp), "[%10.3f] ",
+                                     GetTimeInMillis() / 1000.0);
             newline = end_line;
+            if (LogThreadWrite(stamp, stamp_len, buf, len))
+                return;
+            fwrite(stamp, stamp_len, 1, logFile);
             fwrite(buf, len, 1, logFile);
             if (logFlush) {
                 fflush(logFile);
@@ -986,6 +1003,9 @@ FatalError(const char *f, ...)
     va_list args2;
     static Bool beenhere = FALSE;
 
+    /* Get everything queued so far out, and write the rest directly */
+    LogThreadFini();
+
     if (beenhere)
         ErrorFSigSafe("\nFatalError re-entered, aborting\n");
     else
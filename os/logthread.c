@@ -0,0 +1,377 @@
+/* logthread.c -- Write the log file from a dedicated thread.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE COPYRIGHT HOLDER(S) OR AUTHOR(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS
+ * SOFTWARE.
+ */
+
+#ifdef HAVE_DIX_CONFIG_H
+#include <dix-config.h>
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/uio.h>
+
+#include "misc.h"
+#include "os.h"
+#include "osdep.h"
+
+#if INPUTTHREAD
+
+#include <pthread.h>
+
+/*
+ * Log file writes are appended to a ring of fixed size records and
+ * written out by a writer thread, so that slow storage or very verbose
+ * logging doesn't hold up dispatch.  Writers reserve records with a
+ * compare-and-swap on the head and never block or take locks, which
+ * keeps appending safe from the input thread and from signal handlers.
+ * When the ring is full the message is dropped and counted instead.
+ * Messages too long to reserve at once are queued in several pieces.
+ *
+ * Records are written out strictly in the order they were reserved.
+ * LogThreadFini() waits for the writer thread to stop, drains the ring on
+ * the calling thread and makes all further writes synchronous; it is used
+ * on shutdown and fatal errors.
+ */
+
+#define LOG_RING_RECORDS        1024    /* must be a power of two */
+#define LOG_RECORD_DATA         248
+#define LOG_WRITE_BATCH         64
+#define LOG_MESSAGE_RECORDS     (LOG_RING_RECORDS / 4)
+
+typedef struct {
+    int ready;
+    int len;
+    char data[LOG_RECORD_DATA];
+} LogRecordRec;
+
+static LogRecordRec *log_ring;
+static unsigned log_head;               /* next record to reserve */
+static unsigned log_tail;               /* next record to write out */
+static unsigned log_dropped;
+static int log_active;
+static int log_writer_sleeping;
+static int log_writer_done;
+static pid_t log_writer_pid;            /* process the writer runs in */
+static pthread_t log_writer;
+static int log_fd = -1;
+static int log_pipe[2] = { -1, -1 };
+
+static void
+LogThreadWake(void)
+{
+    char byte = 0;
+    int ret;
+
+    do {
+        ret = write(log_pipe[1], &byte, 1);
+    } while (ret < 0 && errno == EINTR);
+}
+
+/*
+ * Write out ready records.  Only the writer thread does this, until
+ * LogThreadFini() has seen it exit.
+ */
+static void
+LogThreadDrain(Bool skip_unfinished)
+{
+    struct iovec iov[LOG_WRITE_BATCH];
+    unsigned tail = log_tail;
+    unsigned head = __atomic_load_n(&log_head, __ATOMIC_ACQUIRE);
+    unsigned dropped;
+    int ret;
+
+    while (tail != head) {
+        int count = 0, i;
+
+        while (tail + count != head && count < LOG_WRITE_BATCH) {
+            LogRecordRec *rec = &log_ring[(tail + count) % LOG_RING_RECORDS];
+
+            if (!__atomic_load_n(&rec->ready, __ATOMIC_ACQUIRE))
+                break;
+            iov[count].iov_base = rec->data;
+            iov[count].iov_len = rec->len;
+            count++;
+        }
+
+        if (count == 0) {
+            /* Reserved but not filled in yet */
+            if (!skip_unfinished)
+                break;
+            tail++;
+            continue;
+        }
+
+        ret = writev(log_fd, iov, count);
+        (void) ret;
+
+        for (i = 0; i < count; i++)
+            __atomic_store_n(&log_ring[(tail + i) % LOG_RING_RECORDS].ready,
+                             0, __ATOMIC_RELAXED);
+        tail += count;
+        __atomic_store_n(&log_tail, tail, __ATOMIC_RELEASE);
+
+        if (tail == head)
+            head = __atomic_load_n(&log_head, __ATOMIC_ACQUIRE);
+    }
+    __atomic_store_n(&log_tail, tail, __ATOMIC_RELEASE);
+
+    dropped = __atomic_exchange_n(&log_dropped, 0, __ATOMIC_ACQ_REL);
+    if (dropped) {
+        char buf[64];
+        int len = snprintf(buf, sizeof(buf),
+                           "(WW) log ring full, %u messages dropped\n",
+                           dropped);
+
+        ret = write(log_fd, buf, len);
+        (void) ret;
+    }
+}
+
+static void *
+LogThreadDoWork(void *arg)
+{
+    struct pollfd pfd = { .fd = log_pipe[0], .events = POLLIN };
+    sigset_t set;
+    char buf[64];
+    int ret;
+
+    /* Don't handle any signals on this thread */
+    sigfillset(&set);
+    pthread_sigmask(SIG_BLOCK, &set, NULL);
+
+#if defined(HAVE_PTHREAD_SETNAME_NP_WITH_TID)
+    pthread_setname_np (pthread_self(), "LogThread");
+#elif defined(HAVE_PTHREAD_SETNAME_NP_WITHOUT_TID)
+    pthread_setname_np ("LogThread");
+#endif
+
+    for (;;) {
+        int idle = 0;
+
+        LogThreadDrain(FALSE);
+
+        if (!__atomic_load_n(&log_active, __ATOMIC_ACQUIRE))
+            break;
+
+        /* Only ask to be woken up once nothing is left to write */
+        __atomic_store_n(&log_writer_sleeping, 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&log_head, __ATOMIC_SEQ_CST) ==
+            __atomic_load_n(&log_tail, __ATOMIC_SEQ_CST)) {
+            while (poll(&pfd, 1, -1) < 0 && errno == EINTR)
+                ;
+            idle = 1;
+        }
+        __atomic_store_n(&log_writer_sleeping, 0, __ATOMIC_SEQ_CST);
+
+        if (idle)
+            while ((ret = read(log_pipe[0], buf, sizeof(buf))) > 0)
+                ;
+    }
+    __atomic_store_n(&log_writer_done, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+/**
+ * Start writing the log file @fd from a separate thread.  Returns FALSE
+ * when the thread could not be started, in which case the caller keeps
+ * writing synchronously.
+ */
+Bool
+LogThreadInit(int fd)
+{
+    int i;
+
+    if (log_ring)
+        return FALSE;
+
+    log_ring = calloc(LOG_RING_RECORDS, sizeof(LogRecordRec));
+    if (!log_ring)
+        return FALSE;
+
+    if (pipe(log_pipe) < 0) {
+        free(log_ring);
+        log_ring = NULL;
+        return FALSE;
+    }
+    for (i = 0; i < 2; i++) {
+        int flags = fcntl(log_pipe[i], F_GETFD);
+
+        fcntl(log_pipe[i], F_SETFL, O_NONBLOCK);
+        if (flags != -1)
+            (void) fcntl(log_pipe[i], F_SETFD, flags | FD_CLOEXEC);
+    }
+
+    log_fd = fd;
+    log_writer_done = 0;
+    log_writer_pid = getpid();
+    __atomic_store_n(&log_active, 1, __ATOMIC_RELEASE);
+
+    if (pthread_create(&log_writer, NULL, LogThreadDoWork, NULL) != 0) {
+        __atomic_store_n(&log_active, 0, __ATOMIC_RELEASE);
+        close(log_pipe[0]);
+        close(log_pipe[1]);
+        free(log_ring);
+        log_ring = NULL;
+        return FALSE;
+    }
+    pthread_detach(log_writer);
+    return TRUE;
+}
+
+/* Reserve and fill in records for @hdr and @buf; FALSE if the ring is full */
+static Bool
+LogThreadAppend(const char *hdr, size_t hlen, const char *buf, size_t len)
+{
+    unsigned head, n, i;
+
+    n = (hlen + len + LOG_RECORD_DATA - 1) / LOG_RECORD_DATA;
+    if (n == 0)
+        return TRUE;
+
+    head = __atomic_load_n(&log_head, __ATOMIC_RELAXED);
+    do {
+        if (head + n - __atomic_load_n(&log_tail, __ATOMIC_ACQUIRE) >
+            LOG_RING_RECORDS)
+            return FALSE;
+    } while (!__atomic_compare_exchange_n(&log_head, &head, head + n, TRUE,
+                                          __ATOMIC_ACQ_REL,
+                                          __ATOMIC_RELAXED));
+
+    for (i = 0; i < n; i++) {
+        LogRecordRec *rec = &log_ring[(head + i) % LOG_RING_RECORDS];
+        size_t used = 0, chunk;
+
+        if (hlen) {
+            chunk = min(hlen, LOG_RECORD_DATA);
+            memcpy(rec->data, hdr, chunk);
+            hdr += chunk;
+            hlen -= chunk;
+            used = chunk;
+        }
+        chunk = min(len, LOG_RECORD_DATA - used);
+        memcpy(rec->data + used, buf, chunk);
+        buf += chunk;
+        len -= chunk;
+        rec->len = used + chunk;
+        __atomic_store_n(&rec->ready, 1, __ATOMIC_RELEASE);
+    }
+    return TRUE;
+}
+
+/**
+ * Append @hdr followed by @buf to the log ring.  Long messages go in as
+ * several pieces rather than being written around the ring, which would
+ * put them ahead of messages still queued.  Returns FALSE if the writer
+ * thread isn't running and the caller has to write the message itself.
+ * Signal safe.
+ */
+Bool
+LogThreadWrite(const char *hdr, size_t hlen, const char *buf, size_t len)
+{
+    const size_t max = LOG_MESSAGE_RECORDS * LOG_RECORD_DATA;
+
+    if (!__atomic_load_n(&log_active, __ATOMIC_ACQUIRE))
+        return FALSE;
+
+    /* The header is a timestamp, far shorter than a piece */
+    while (hlen + len > max) {
+        size_t chunk = max - hlen;
+
+        if (!LogThreadAppend(hdr, hlen, buf, chunk))
+            goto dropped;
+        hdr = NULL;
+        hlen = 0;
+        buf += chunk;
+        len -= chunk;
+    }
+    if (!LogThreadAppend(hdr, hlen, buf, len))
+        goto dropped;
+
+    if (__atomic_exchange_n(&log_writer_sleeping, 0, __ATOMIC_SEQ_CST))
+        LogThreadWake();
+    return TRUE;
+
+ dropped:
+    /* Whatever pieces made it in are written; the rest is counted */
+    __atomic_add_fetch(&log_dropped, 1, __ATOMIC_RELAXED);
+    if (__atomic_exchange_n(&log_writer_sleeping, 0, __ATOMIC_SEQ_CST))
+        LogThreadWake();
+    return TRUE;
+}
+
+/**
+ * Stop queueing log messages, wait for the writer thread to exit, and
+ * write out whatever is still queued on the calling thread.  Signal safe,
+ * so it can be used on fatal errors.
+ */
+void
+LogThreadFini(void)
+{
+    struct timespec wait = { 0, 1000000 };
+
+    if (!__atomic_exchange_n(&log_active, 0, __ATOMIC_SEQ_CST))
+        return;
+
+    /*
+     * The writer thread exits once it sees log_active cleared.  It may be
+     * in the middle of a write to slow storage, and the ring can only be
+     * drained by one thread at a time, so wait for it however long that
+     * takes.  pthread_join() isn't signal safe, hence the polling.  A
+     * forked child has no writer thread to wait for, and the writer
+     * itself, failing fatally, would wait for itself forever; both just
+     * drain the ring here.
+     */
+    if (getpid() != log_writer_pid || pthread_equal(pthread_self(), log_writer)) {
+        LogThreadDrain(TRUE);
+        return;
+    }
+
+    LogThreadWake();
+    while (!__atomic_load_n(&log_writer_done, __ATOMIC_ACQUIRE))
+        nanosleep(&wait, NULL);
+
+    LogThreadDrain(TRUE);
+}
+
+#else /* INPUTTHREAD */
+
+Bool
+LogThreadInit(int fd)
+{
+    return FALSE;
+}
+
+Bool
+LogThreadWrite(const char *hdr, size_t hlen, const char *buf, size_t len)
+{
+    return FALSE;
+}
+
+void
+LogThreadFini(void)
+{
+}
+
+#endif
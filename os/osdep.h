@@ -123,6 +123,7 @@ typedef struct _osComm {
 
 #define OS_COMM_GRAB_IMPERVIOUS 1
 #define OS_COMM_IGNORED         2
+#define OS_COMM_READ_AHEAD      4       /* queued for ReadAheadClients */
 
 extern int FlushClient(ClientPtr /*who */ ,
                        OsCommPtr /*oc */ ,
@@ -146,11 +147,43 @@ listen_to_client(ClientPtr client);
 
 extern Bool NewOutputPending;
 
+/* Socket calls made for client input and output */
+typedef struct {
+    unsigned long reads;
+    unsigned long writes;
+    unsigned long submits;      /* io_uring submissions */
+} ClientIoStatsRec;
+
+extern ClientIoStatsRec ClientIoStats;
+
+extern void QueueReadAhead(ClientPtr client);
+extern void ReadAheadClients(void);
+
 extern WorkQueuePtr workQueue;
 
 /* in access.c */
 extern Bool ComputeLocalClient(ClientPtr client);
 
+/* in iouring.c */
+#define IO_URING_BATCH  64
+
+struct msghdr;
+
+extern Bool IoUringAvailable(void);
+extern void IoUringQueueMsg(int fd, struct msghdr *msg, Bool send);
+extern int IoUringSubmit(int *results);
+
+/* in xstrans.c */
+extern Bool TransConnHasSendFds(struct _XtransConnInfo *ciptr);
+extern void TransConnRecvFds(struct _XtransConnInfo *ciptr,
+                             struct msghdr *msg);
+
+/* in logthread.c */
+extern Bool LogThreadInit(int fd);
+extern Bool LogThreadWrite(const char *hdr, size_t hlen,
+                           const char *buf, size_t len);
+extern void LogThreadFini(void);
+
 /* in auth.c */
 extern void GenerateRandomData(int len, char *buf);
 
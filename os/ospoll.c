@@ -74,20 +74,32 @@ struct ospoll {
     struct ospollfd     *fds;
     int                 num;
     int                 size;
+    struct ospoll_stats stats;
 };
 
 #endif
 
 #if EPOLL || PORT
 
-/* epoll-based implementation */
+/* epoll-based implementation
+ *
+ * With epoll, muting an fd doesn't touch the kernel; the events stay
+ * registered until they next show up unwanted, and only then are they
+ * removed.  Clients flipping between blocked and ready thus rarely cost
+ * an epoll_ctl call.  For edge-triggered fds, readable data seen is
+ * remembered until ospoll_reset_events, and listening again reports it
+ * from that instead of asking the kernel to poll the fd once more.
+ */
 struct ospollfd {
     int                 fd;
-    int                 xevents;
+    int                 xevents;        /* events wanted by the caller */
+    int                 kevents;        /* events registered in the kernel */
+    int                 ready;          /* edge events not yet reset */
     enum ospoll_trigger trigger;
     void                (*callback)(int fd, int xevents, void *data);
     void                *data;
     struct xorg_list    deleted;
+    struct xorg_list    pending;
 };
 
 struct ospoll {
@@ -96,6 +108,8 @@ struct ospoll {
     int                 num;
     int                 size;
     struct xorg_list    deleted;
+    struct xorg_list    pending;        /* ready fds to report from userspace */
+    struct ospoll_stats stats;
 };
 
 #endif
@@ -116,6 +130,7 @@ struct ospoll {
     int                 num;
     int                 size;
     Bool                changed;
+    struct ospoll_stats stats;
 };
 
 #endif
@@ -231,6 +246,7 @@ ospoll_create(void)
         return NULL;
     }
     xorg_list_init(&ospoll->deleted);
+    xorg_list_init(&ospoll->pending);
     return ospoll;
 #endif
 #if POLL
@@ -362,12 +378,16 @@ ospoll_add(struct ospoll *ospoll, int fd,
         ev.data.ptr = osfd;
         if (trigger == ospoll_trigger_edge)
             ev.events |= EPOLLET;
+        ospoll->stats.ctl++;
         if (epoll_ctl(ospoll->epoll_fd, EPOLL_CTL_ADD, fd, &ev) == -1) {
             free(osfd);
             return FALSE;
         }
         osfd->fd = fd;
         osfd->xevents = 0;
+        osfd->kevents = 0;
+        osfd->ready = 0;
+        xorg_list_init(&osfd->pending);
 
         pos = -pos - 1;
         array_insert(ospoll->fds, ospoll->num, sizeof (ospoll->fds[0]), pos);
@@ -426,6 +446,7 @@ ospoll_remove(struct ospoll *ospoll, int fd)
         struct ospollfd *osfd = &ospoll->fds[pos];
         struct poll_ctl ctl = { .cmd = PS_DELETE, .fd = fd };
         pollset_ctl(ospoll->ps, &ctl, 1);
+        ospoll->stats.ctl++;
 
         array_delete(ospoll->fds, ospoll->num, sizeof (ospoll->fds[0]), pos);
         ospoll->num--;
@@ -433,6 +454,7 @@ ospoll_remove(struct ospoll *ospoll, int fd)
 #if PORT
         struct ospollfd *osfd = ospoll->fds[pos];
         port_dissociate(ospoll->epoll_fd, PORT_SOURCE_FD, fd);
+        ospoll->stats.ctl++;
 
         array_delete(ospoll->fds, ospoll->num, sizeof (ospoll->fds[0]), pos);
         ospoll->num--;
@@ -446,11 +468,13 @@ ospoll_remove(struct ospoll *ospoll, int fd)
         ev.events = 0;
         ev.data.ptr = osfd;
         (void) epoll_ctl(ospoll->epoll_fd, EPOLL_CTL_DEL, fd, &ev);
+        ospoll->stats.ctl++;
 
         array_delete(ospoll->fds, ospoll->num, sizeof (ospoll->fds[0]), pos);
         ospoll->num--;
         osfd->callback = NULL;
         osfd->data = NULL;
+        xorg_list_del(&osfd->pending);
         xorg_list_add(&osfd->deleted, &ospoll->deleted);
 #endif
 #if POLL
@@ -472,6 +496,7 @@ epoll_mod(struct ospoll *ospoll, struct ospollfd *osfd)
     if (osfd->xevents & X_NOTIFY_WRITE)
         events |= POLLOUT;
     port_associate(ospoll->epoll_fd, PORT_SOURCE_FD, osfd->fd, events, osfd);
+    ospoll->stats.ctl++;
 }
 #endif
 
@@ -489,6 +514,8 @@ epoll_mod(struct ospoll *ospoll, struct ospollfd *osfd)
         ev.events |= EPOLLET;
     ev.data.ptr = osfd;
     (void) epoll_ctl(ospoll->epoll_fd, EPOLL_CTL_MOD, osfd->fd, &ev);
+    osfd->kevents = osfd->xevents;
+    ospoll->stats.ctl++;
 }
 #endif
 
@@ -509,13 +536,27 @@ ospoll_listen(struct ospoll *ospoll, int fd, int xevents)
             ospoll->fds[pos].revents &= ~POLLOUT;
         }
         pollset_ctl(ospoll->ps, &ctl, 1);
+        ospoll->stats.ctl++;
         ospoll->fds[pos].xevents |= xevents;
 #endif
-#if EPOLL || PORT
+#if PORT
         struct ospollfd *osfd = ospoll->fds[pos];
         osfd->xevents |= xevents;
         epoll_mod(ospoll, osfd);
 #endif
+#if EPOLL
+        struct ospollfd *osfd = ospoll->fds[pos];
+        osfd->xevents |= xevents;
+        /* Re-registering makes the kernel report current readiness;
+         * when nothing changes, report what is known to be ready
+         * ourselves.
+         */
+        if (osfd->xevents & ~osfd->kevents)
+            epoll_mod(ospoll, osfd);
+        else if (osfd->ready & xevents &&
+                 xorg_list_is_empty(&osfd->pending))
+            xorg_list_append(&osfd->pending, &ospoll->pending);
+#endif
 #if POLL
         if (xevents & X_NOTIFY_READ) {
             ospoll->fds[pos].events |= POLLIN;
@@ -540,6 +581,7 @@ ospoll_mute(struct ospoll *ospoll, int fd, int xevents)
         osfd->xevents &= ~xevents;
         struct poll_ctl ctl = { .cmd = PS_DELETE, .fd = fd };
         pollset_ctl(ospoll->ps, &ctl, 1);
+        ospoll->stats.ctl++;
         if (osfd->xevents) {
             ctl.cmd = PS_ADD;
             if (osfd->xevents & X_NOTIFY_READ) {
@@ -549,13 +591,18 @@ ospoll_mute(struct ospoll *ospoll, int fd, int xevents)
                 ctl.events |= POLLOUT;
             }
             pollset_ctl(ospoll->ps, &ctl, 1);
+            ospoll->stats.ctl++;
         }
 #endif
-#if EPOLL || PORT
+#if PORT
         struct ospollfd *osfd = ospoll->fds[pos];
         osfd->xevents &= ~xevents;
         epoll_mod(ospoll, osfd);
 #endif
+#if EPOLL
+        /* Left registered; dropped in ospoll_wait if it shows up */
+        ospoll->fds[pos]->xevents &= ~xevents;
+#endif
 #if POLL
         if (xevents & X_NOTIFY_READ)
             ospoll->fds[pos].events &= ~POLLIN;
@@ -575,6 +622,7 @@ ospoll_wait(struct ospoll *ospoll, int timeout)
     struct pollfd events[MAX_EVENTS];
 
     nready = pollset_poll(ospoll->ps, events, MAX_EVENTS, timeout);
+    ospoll->stats.wait++;
     for (int i = 0; i < nready; i++) {
         struct pollfd *ev = &events[i];
         int pos = ospoll_find(ospoll, ev->fd);
@@ -593,6 +641,7 @@ ospoll_wait(struct ospoll *ospoll, int timeout)
                 xevents |= X_NOTIFY_WRITE;
             if (revents & (~(POLLIN|POLLOUT)))
                 xevents |= X_NOTIFY_ERROR;
+            ospoll->stats.events++;
             osfd->callback(osfd->fd, xevents, osfd->data);
         }
     }
@@ -607,6 +656,7 @@ ospoll_wait(struct ospoll *ospoll, int timeout)
     };
 
     nready = 0;
+    ospoll->stats.wait++;
     if (port_getn(ospoll->epoll_fd, events, MAX_EVENTS, &nget, &port_timeout)
         == 0) {
         nready = nget;
@@ -624,8 +674,10 @@ ospoll_wait(struct ospoll *ospoll, int timeout)
         if (revents & (~(POLLIN|POLLOUT)))
             xevents |= X_NOTIFY_ERROR;
 
-        if (osfd->callback)
+        if (osfd->callback) {
+            ospoll->stats.events++;
             osfd->callback(osfd->fd, xevents, osfd->data);
+        }
 
         if (osfd->trigger == ospoll_trigger_level &&
             !xorg_list_is_empty(&osfd->deleted)) {
@@ -637,15 +689,21 @@ ospoll_wait(struct ospoll *ospoll, int timeout)
 #if EPOLL
 #define MAX_EVENTS      256
     struct epoll_event events[MAX_EVENTS];
+    struct xorg_list pending;
+    struct ospollfd *osfd;
     int i;
 
+    if (!xorg_list_is_empty(&ospoll->pending))
+        timeout = 0;
+
     nready = epoll_wait(ospoll->epoll_fd, events, MAX_EVENTS, timeout);
+    ospoll->stats.wait++;
     for (i = 0; i < nready; i++) {
         struct epoll_event *ev = &events[i];
-        struct ospollfd *osfd = ev->data.ptr;
         uint32_t revents = ev->events;
         int xevents = 0;
 
+        osfd = ev->data.ptr;
         if (revents & EPOLLIN)
             xevents |= X_NOTIFY_READ;
         if (revents & EPOLLOUT)
@@ -653,13 +711,51 @@ ospoll_wait(struct ospoll *ospoll, int timeout)
         if (revents & (~(EPOLLIN|EPOLLOUT)))
             xevents |= X_NOTIFY_ERROR;
 
-        if (osfd->callback)
+        if (!osfd->callback)
+            continue;
+
+        if (osfd->trigger == ospoll_trigger_edge)
+            osfd->ready |= xevents & X_NOTIFY_READ;
+
+        /* Stop the kernel reporting events muted since they were
+         * registered
+         */
+        if (xevents & ~osfd->xevents & (X_NOTIFY_READ|X_NOTIFY_WRITE)) {
+            epoll_mod(ospoll, osfd);
+            xevents &= osfd->xevents | X_NOTIFY_ERROR;
+        }
+
+        if (xevents) {
+            ospoll->stats.events++;
             osfd->callback(osfd->fd, xevents, osfd->data);
+        }
+    }
+
+    /* Callbacks may queue their fd again, so work from a copy */
+    xorg_list_init(&pending);
+    while (!xorg_list_is_empty(&ospoll->pending)) {
+        osfd = xorg_list_first_entry(&ospoll->pending, struct ospollfd, pending);
+        xorg_list_del(&osfd->pending);
+        xorg_list_append(&osfd->pending, &pending);
+    }
+    while (!xorg_list_is_empty(&pending)) {
+        int xevents;
+
+        osfd = xorg_list_first_entry(&pending, struct ospollfd, pending);
+        xorg_list_del(&osfd->pending);
+
+        xevents = osfd->ready & osfd->xevents;
+        if (xevents) {
+            ospoll->stats.events++;
+            osfd->callback(osfd->fd, xevents, osfd->data);
+            nready = max(nready, 0) + 1;
+        }
     }
     ospoll_clean_deleted(ospoll);
 #endif
 #if POLL
     nready = xserver_poll(ospoll->fds, ospoll->num, timeout);
+    ospoll->stats.wait++;
     ospoll->changed = FALSE;
     if (nready > 0) {
         int f;
@@ -678,6 +774,7 @@ ospoll_wait(struct ospoll *ospoll, int timeout)
                     xevents |= X_NOTIFY_WRITE;
                 if (revents & (~(POLLIN|POLLOUT)))
                     xevents |= X_NOTIFY_ERROR;
+                ospoll->stats.events++;
                 ospoll->osfds[f].callback(ospoll->fds[f].fd, xevents,
                                           ospoll->osfds[f].data);
 
@@ -712,6 +809,14 @@ ospoll_reset_events(struct ospoll *ospoll, int fd)
 
     epoll_mod(ospoll, ospoll->fds[pos]);
 #endif
+#if EPOLL
+    int pos = ospoll_find(ospoll, fd);
+
+    if (pos < 0)
+        return;
+
+    ospoll->fds[pos]->ready = 0;
+#endif
 #if POLL
     int pos = ospoll_find(ospoll, fd);
 
@@ -739,3 +844,9 @@ ospoll_data(struct ospoll *ospoll, int fd)
     return ospoll->osfds[pos].data;
 #endif
 }
+
+void
+ospoll_get_stats(struct ospoll *ospoll, struct ospoll_stats *stats)
+{
+    *stats = ospoll->stats;
+}
@@ -41,6 +41,19 @@ enum ospoll_trigger {
     ospoll_trigger_level
 };
 
+/**
+ * ospoll activity counters
+ *
+ * @ctl        Calls changing the set of events watched by the kernel
+ * @wait       Calls waiting for events
+ * @events     Callbacks made
+ */
+struct ospoll_stats {
+    unsigned long       ctl;
+    unsigned long       wait;
+    unsigned long       events;
+};
+
 /**
  * Create a new ospoll structure
  */
@@ -95,6 +108,9 @@ ospoll_listen(struct ospoll *ospoll, int fd, int xevents);
  * @param       ospoll          ospoll monitoring fd
  * @param       fd              File descriptor to change
  * @param       events          events to stop triggering on
+ *
+ * The kernel may keep reporting muted events until they next
+ * show up; they are not passed to the callback.
  */
 void
 ospoll_mute(struct ospoll *ospoll, int fd, int xevents);
@@ -139,4 +155,13 @@ ospoll_reset_events(struct ospoll *ospoll, int fd);
 void *
 ospoll_data(struct ospoll *ospoll, int fd);
 
+/**
+ * Fetch the activity counters
+ *
+ * @param       ospoll          ospoll to query
+ * @param       stats           filled with counts since ospoll_create
+ */
+void
+ospoll_get_stats(struct ospoll *ospoll, struct ospoll_stats *stats);
+
 #endif /* _OSPOLL_H_ */
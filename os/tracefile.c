@@ -0,0 +1,233 @@
+/* tracefile.c -- Binary protocol trace written to a memory mapped file.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE COPYRIGHT HOLDER(S) OR AUTHOR(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS
+ * SOFTWARE.
+ */
+
+#ifdef HAVE_DIX_CONFIG_H
+#include <dix-config.h>
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include <X11/X.h>
+#include <X11/Xproto.h>
+#include "misc.h"
+#include "os.h"
+#include "dixstruct.h"
+#include "opaque.h"
+#include "tracefile.h"
+
+/*
+ * With -tracefile, every request, reply, event and error is recorded
+ * as a TraceRecordRec in a ring mapped from the trace file, so traffic
+ * can be looked at after the fact without a RECORD client.  Only the
+ * main thread writes records, and the header's head is updated last so
+ * that readers of a live trace never see a record being filled in.
+ *
+ * Replies and events are picked up through ReplyCallback and
+ * EventCallback, so nothing but the check in Dispatch is left when
+ * tracing is off.
+ */
+
+#define TRACE_DEFAULT_RECORDS   (1 << 20)
+
+Bool TraceActive;
+
+static TraceHeaderRec *trace_header;
+static TraceRecordRec *trace_ring;
+
+static TraceRecordRec *
+TraceNext(ClientPtr client, int kind)
+{
+    TraceRecordRec *rec;
+
+    rec = &trace_ring[trace_header->head & (trace_header->nrecords - 1)];
+    memset(rec, 0, sizeof(*rec));
+    rec->time = GetTimeInMicros();
+    rec->client = client->index;
+    rec->sequence = client->sequence;
+    rec->kind = kind;
+    return rec;
+}
+
+static void
+TraceCommit(void)
+{
+    __atomic_store_n(&trace_header->head, trace_header->head + 1,
+                     __ATOMIC_RELEASE);
+}
+
+void
+TraceRequest(ClientPtr client, int result, CARD64 start)
+{
+    TraceRecordRec *rec = TraceNext(client, TRACE_REQUEST);
+
+    rec->duration = rec->time - start;
+    rec->time = start;
+    rec->major = client->majorOp;
+    rec->minor = client->minorOp;
+    rec->length = client->req_len << 2;
+    rec->result = result;
+    TraceCommit();
+}
+
+static void
+TraceReply(CallbackListPtr *pcbl, void *unused, void *calldata)
+{
+    ReplyInfoRec *info = calldata;
+    TraceRecordRec *rec;
+
+    if (!info->startOfReply)
+        return;
+
+    rec = TraceNext(info->client, TRACE_REPLY);
+    rec->major = info->client->majorOp;
+    rec->minor = info->client->minorOp;
+    rec->length = info->dataLenBytes + info->bytesRemaining;
+    TraceCommit();
+}
+
+static void
+TraceEvents(CallbackListPtr *pcbl, void *unused, void *calldata)
+{
+    EventInfoRec *info = calldata;
+    int i;
+
+    for (i = 0; i < info->count; i++) {
+        xEvent *ev = &info->events[i];
+        TraceRecordRec *rec;
+
+        if (ev->u.u.type == X_Error) {
+            xError *err = (xError *) ev;
+
+            rec = TraceNext(info->client, TRACE_ERROR);
+            rec->major = err->majorCode;
+            rec->minor = err->minorCode;
+            rec->result = err->errorCode;
+            rec->length = sizeof(xError);
+        }
+        else {
+            rec = TraceNext(info->client, TRACE_EVENT);
+            rec->major = ev->u.u.type;
+            rec->length = sizeof(xEvent);
+            if ((ev->u.u.type & 0x7f) == GenericEvent) {
+                xGenericEvent *ge = (xGenericEvent *) ev;
+
+                rec->minor = ge->evtype;
+                rec->result = ge->extension;
+                rec->length += ge->length << 2;
+            }
+        }
+        TraceCommit();
+    }
+}
+
+/*
+ * Allocate the whole file up front.  A sparse file would turn running
+ * out of disk space into SIGBUS on some later store to the mapping.
+ */
+static int
+TraceAllocate(int fd, off_t size)
+{
+    int ret;
+
+#ifdef HAVE_POSIX_FALLOCATE
+    /* posix_fallocate rolls back on EINTR, so keep SIGALRM out */
+    OsBlockSignals();
+    do {
+        ret = posix_fallocate(fd, 0, size);
+    } while (ret == EINTR);
+    OsReleaseSignals();
+
+    if (ret != 0) {
+        errno = ret;
+        return -1;
+    }
+#else
+    do {
+        ret = ftruncate(fd, size);
+    } while (ret == -1 && errno == EINTR);
+#endif
+    return ret;
+}
+
+static Bool
+TraceOpen(void)
+{
+    size_t size = sizeof(TraceHeaderRec) +
+        TRACE_DEFAULT_RECORDS * sizeof(TraceRecordRec);
+    void *map;
+    int fd;
+
+    fd = open(TraceFile, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC | O_NOFOLLOW,
+              0600);
+    if (fd < 0) {
+        ErrorF("trace: cannot open \"%s\": %s\n", TraceFile, strerror(errno));
+        return FALSE;
+    }
+    if (TraceAllocate(fd, size) < 0) {
+        ErrorF("trace: cannot allocate %zu bytes for \"%s\": %s\n",
+               size, TraceFile, strerror(errno));
+        close(fd);
+        unlink(TraceFile);
+        return FALSE;
+    }
+    map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        ErrorF("trace: cannot map \"%s\": %s\n", TraceFile, strerror(errno));
+        return FALSE;
+    }
+
+    trace_header = map;
+    trace_header->magic = TRACE_MAGIC;
+    trace_header->version = TRACE_VERSION;
+    trace_header->header_size = sizeof(TraceHeaderRec);
+    trace_header->record_size = sizeof(TraceRecordRec);
+    trace_header->nrecords = TRACE_DEFAULT_RECORDS;
+    trace_header->head = 0;
+    trace_ring = (TraceRecordRec *) (trace_header + 1);
+    return TRUE;
+}
+
+/*
+ * Called once per server generation, after the callback lists have
+ * been reset.  The trace file itself is kept across generations.
+ */
+void
+TraceInit(void)
+{
+    if (!TraceFile)
+        return;
+
+    if (!trace_header && !TraceOpen()) {
+        TraceFile = NULL;
+        return;
+    }
+
+    if (!AddCallback(&ReplyCallback, TraceReply, NULL) ||
+        !AddCallback(&EventCallback, TraceEvents, NULL))
+        FatalError("trace: cannot register callbacks\n");
+
+    TraceActive = TRUE;
+}
@@ -185,6 +185,18 @@ Bool noGEExtension = FALSE;
 
 Bool CoreDump;
 
+Bool CompressMotionEvents = FALSE;
+
+int DamageCoalesceRects = 0;
+
+int FakeScreenRefresh = 0;
+
+int WorkerThreads = 0;
+
+char *TraceFile = NULL;
+
+Bool IoUring = FALSE;
+
 Bool enableIndirectGLX = FALSE;
 
 #ifdef PANORAMIX
@@ -518,8 +530,10 @@ UseMsg(void)
     ErrorF("-c                     turns off key-click\n");
     ErrorF("c #                    key-click volume (0-100)\n");
     ErrorF("-cc int                default color visual class\n");
+    ErrorF("-compressmotion        merge queued motion events of a device\n");
     ErrorF("-nocursor              disable the cursor\n");
     ErrorF("-core                  generate core dump on fatal error\n");
+    ErrorF("-damagecoalesce int    batch DamageNotify events, up to int rectangles\n");
     ErrorF("-displayfd fd          file descriptor to write display number to when ready to connect\n");
     ErrorF("-dpi int               screen resolution in dots per inch\n");
 #ifdef DPMSExtension
@@ -528,11 +542,13 @@ UseMsg(void)
     ErrorF
         ("-deferglyphs [none|all|16] defer loading of [no|all|16-bit] glyphs\n");
     ErrorF("-f #                   bell base (0-100)\n");
+    ErrorF("-fakerefresh int       refresh rate (Hz) of the emulated Present vblank clock\n");
     ErrorF("-fp string             default font path\n");
     ErrorF("-help                  prints message with these options\n");
     ErrorF("+iglx                  Allow creating indirect GLX contexts\n");
     ErrorF("-iglx                  Prohibit creating indirect GLX contexts (default)\n");
     ErrorF("-I                     ignore all remaining arguments\n");
+    ErrorF("-iouring               batch client socket I/O with io_uring (experimental)\n");
 #ifdef RLIMIT_DATA
     ErrorF("-ld int                limit data space to N Kb\n");
 #endif
@@ -562,6 +578,7 @@ UseMsg(void)
     ErrorF("-seat string           seat to run on\n");
     ErrorF("-t #                   default pointer threshold (pixels/t)\n");
     ErrorF("-terminate [delay]     terminate at server reset (optional delay in sec)\n");
+    ErrorF("-tracefile file        record a binary protocol trace in file\n");
     ErrorF("-tst                   disable testing extensions\n");
     ErrorF("ttyxx                  server started from init on /dev/ttyxx\n");
     ErrorF("v                      video blanking for screen-saver\n");
@@ -575,6 +592,7 @@ UseMsg(void)
     ErrorF
         ("-dumbSched             Disable smart scheduling and threaded input, enable old behavior\n");
     ErrorF("-schedInterval int     Set scheduler interval in msec\n");
+    ErrorF("-workerthreads int     Threads for large rendering operations (experimental)\n");
     ErrorF("-sigstop               Enable SIGSTOP based startup\n");
     ErrorF("+extension name        Enable extension\n");
     ErrorF("-extension name        Disable extension\n");
@@ -730,6 +748,9 @@ ProcessCommandLine(int argc, char *argv[])
             else
                 UseMsg();
         }
+        else if (strcmp(argv[i], "-compressmotion") == 0) {
+            CompressMotionEvents = TRUE;
+        }
         else if (strcmp(argv[i], "-core") == 0) {
 #if !defined(WIN32) || !defined(__MINGW32__)
             struct rlimit core_limit;
@@ -740,6 +761,12 @@ ProcessCommandLine(int argc, char *argv[])
 #endif
             CoreDump = TRUE;
         }
+        else if (strcmp(argv[i], "-damagecoalesce") == 0) {
+            if (++i < argc)
+                DamageCoalesceRects = atoi(argv[i]);
+            else
+                UseMsg();
+        }
         else if (strcmp(argv[i], "-nocursor") == 0) {
             EnableCursor = FALSE;
         }
@@ -775,6 +802,15 @@ ProcessCommandLine(int argc, char *argv[])
             else
                 UseMsg();
         }
+        else if (strcmp(argv[i], "-fakerefresh") == 0) {
+            if (++i < argc) {
+                FakeScreenRefresh = atoi(argv[i]);
+                if (FakeScreenRefresh < 1 || FakeScreenRefresh > 1000)
+                    FatalError("fakerefresh must be between 1 and 1000\n");
+            }
+            else
+                UseMsg();
+        }
         else if (strcmp(argv[i], "-fp") == 0) {
             if (++i < argc) {
                 defaultFontPath = argv[i];
@@ -922,6 +958,16 @@ ProcessCommandLine(int argc, char *argv[])
                terminateDelay = atoi(argv[++i]);
             terminateDelay = max(0, terminateDelay);
         }
+        else if (strcmp(argv[i], "-tracefile") == 0) {
+            if (++i < argc) {
+                if (PrivsElevated())
+                    FatalError("\nInvalid argument -tracefile "
+                               "with elevated privileges\n");
+                TraceFile = argv[i];
+            }
+            else
+                UseMsg();
+        }
         else if (strcmp(argv[i], "-tst") == 0) {
             noTestExtensions = TRUE;
         }
@@ -999,6 +1045,18 @@ ProcessCommandLine(int argc, char *argv[])
             else
                 UseMsg();
         }
+        else if (strcmp(argv[i], "-iouring") == 0) {
+            IoUring = TRUE;
+        }
+        else if (strcmp(argv[i], "-workerthreads") == 0) {
+            if (++i < argc) {
+                WorkerThreads = atoi(argv[i]);
+                if (WorkerThreads < 1 || WorkerThreads > 64)
+                    FatalError("workerthreads must be between 1 and 64\n");
+            }
+            else
+                UseMsg();
+        }
         else if (strcmp(argv[i], "-render") == 0) {
             if (++i < argc) {
                 int policy = PictureParseCmapPolicy(argv[i]);
@@ -0,0 +1,172 @@
+/* workthread.c -- Spread large software rendering operations over threads.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE COPYRIGHT HOLDER(S) OR AUTHOR(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS
+ * SOFTWARE.
+ */
+
+#ifdef HAVE_DIX_CONFIG_H
+#include <dix-config.h>
+#endif
+
+#include <signal.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#include "misc.h"
+#include "os.h"
+#include "opaque.h"
+
+/*
+ * Request dispatch stays on the main thread; only the pixel loops of
+ * big operations, which touch nothing but the memory they are handed,
+ * are split into bands of rows.  The main thread works on bands too and
+ * returns once all of them are done, so callers need no locking.
+ */
+
+/* Don't bother below this many bytes, nor split bands smaller than it */
+#define WORKER_MIN_BYTES        (256 * 1024)
+
+#if INPUTTHREAD
+
+typedef struct {
+    WorkerBandProcPtr proc;
+    void *closure;
+    int y1, y2;
+    int nbands;
+    int next;                   /* next band to hand out */
+    int pending;                /* bands not finished yet */
+} WorkerJobRec;
+
+static pthread_mutex_t worker_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t worker_cond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t worker_done = PTHREAD_COND_INITIALIZER;
+static WorkerJobRec worker_job;
+static int worker_count;
+static Bool worker_failed;
+
+/* Called and returns with worker_mutex held */
+static void
+WorkerRunJob(void)
+{
+    while (worker_job.next < worker_job.nbands) {
+        WorkerBandProcPtr proc = worker_job.proc;
+        void *closure = worker_job.closure;
+        int band = worker_job.next++;
+        int rows = worker_job.y2 - worker_job.y1;
+        int y1 = worker_job.y1 + rows * band / worker_job.nbands;
+        int y2 = worker_job.y1 + rows * (band + 1) / worker_job.nbands;
+
+        pthread_mutex_unlock(&worker_mutex);
+        (*proc) (closure, y1, y2);
+        pthread_mutex_lock(&worker_mutex);
+
+        if (--worker_job.pending == 0)
+            pthread_cond_signal(&worker_done);
+    }
+}
+
+static void *
+WorkerThreadDoWork(void *arg)
+{
+    sigset_t set;
+
+    /* Don't handle any signals on this thread */
+    sigfillset(&set);
+    pthread_sigmask(SIG_BLOCK, &set, NULL);
+
+#if defined(HAVE_PTHREAD_SETNAME_NP_WITH_TID)
+    pthread_setname_np (pthread_self(), "WorkerThread");
+#elif defined(HAVE_PTHREAD_SETNAME_NP_WITHOUT_TID)
+    pthread_setname_np ("WorkerThread");
+#endif
+
+    pthread_mutex_lock(&worker_mutex);
+    for (;;) {
+        while (worker_job.next >= worker_job.nbands)
+            pthread_cond_wait(&worker_cond, &worker_mutex);
+        WorkerRunJob();
+    }
+    return NULL;
+}
+
+/* Start worker threads on first use; the main thread counts as one */
+static int
+WorkerThreadsStart(void)
+{
+    pthread_t thread;
+
+    while (!worker_failed && worker_count < WorkerThreads - 1) {
+        if (pthread_create(&thread, NULL, WorkerThreadDoWork, NULL) != 0) {
+            ErrorF("worker-thread: only %d of %d threads started\n",
+                   worker_count + 1, WorkerThreads);
+            worker_failed = TRUE;
+            break;
+        }
+        pthread_detach(thread);
+        worker_count++;
+    }
+    return worker_count + 1;
+}
+
+void
+WorkerRunBands(int y1, int y2, size_t bytes, WorkerBandProcPtr proc,
+               void *closure)
+{
+    int nbands;
+
+    if (WorkerThreads <= 1 || bytes < 2 * WORKER_MIN_BYTES || y2 - y1 < 2) {
+        (*proc) (closure, y1, y2);
+        return;
+    }
+
+    nbands = WorkerThreadsStart();
+    if (nbands > (int) (bytes / WORKER_MIN_BYTES))
+        nbands = bytes / WORKER_MIN_BYTES;
+    if (nbands > y2 - y1)
+        nbands = y2 - y1;
+    if (nbands <= 1) {
+        (*proc) (closure, y1, y2);
+        return;
+    }
+
+    pthread_mutex_lock(&worker_mutex);
+    worker_job.proc = proc;
+    worker_job.closure = closure;
+    worker_job.y1 = y1;
+    worker_job.y2 = y2;
+    worker_job.nbands = nbands;
+    worker_job.next = 0;
+    worker_job.pending = nbands;
+    pthread_cond_broadcast(&worker_cond);
+
+    WorkerRunJob();
+    while (worker_job.pending)
+        pthread_cond_wait(&worker_done, &worker_mutex);
+    pthread_mutex_unlock(&worker_mutex);
+}
+
+#else /* INPUTTHREAD */
+
+void
+WorkerRunBands(int y1, int y2, size_t bytes, WorkerBandProcPtr proc,
+               void *closure)
+{
+    (*proc) (closure, y1, y2);
+}
+
+#endif
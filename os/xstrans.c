@@ -15,3 +15,34 @@ _X_ATTRIBUTE_PRINTF(1, 2);
 #define TRANS_SERVER
 #define XSERV_t
 #include <X11/Xtrans/transport.c>
+
+#if XTRANS_SEND_FDS
+
+#include "osdep.h"
+
+/* For io.c, which may move the bytes itself when batching transfers */
+
+Bool
+TransConnHasSendFds(XtransConnInfo ciptr)
+{
+    return ciptr->send_fds != NULL;
+}
+
+void
+TransConnRecvFds(XtransConnInfo ciptr, struct msghdr *msg)
+{
+    struct cmsghdr *hdr;
+
+    for (hdr = CMSG_FIRSTHDR(msg); hdr; hdr = CMSG_NXTHDR(msg, hdr)) {
+        if (hdr->cmsg_level == SOL_SOCKET && hdr->cmsg_type == SCM_RIGHTS) {
+            int nfd = (hdr->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            int *fd = (int *) CMSG_DATA(hdr);
+            int i;
+
+            for (i = 0; i < nfd; i++)
+                appendFd(&ciptr->recv_fds, fd[i], 0);
+        }
+    }
+}
+
+#endif
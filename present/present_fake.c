@@ -23,13 +23,20 @@
 #include "present_priv.h"
 #include "list.h"
 
-static struct xorg_list fake_vblank_queue;
+#include "opaque.h"
+
+/*
+ * Emulated vblank for screens (or CRTC-less windows) without a vblank
+ * source of their own.  All waiting requests of a screen are driven by
+ * a single timer which fires once per MSC that someone is waiting for,
+ * notifying every request due at that MSC together, and which stops
+ * when nothing is waiting.
+ */
 
 typedef struct present_fake_vblank {
     struct xorg_list            list;
     uint64_t                    event_id;
-    OsTimerPtr                  timer;
-    ScreenPtr                   screen;
+    uint64_t                    msc;
 } present_fake_vblank_rec, *present_fake_vblank_ptr;
 
 int
@@ -42,13 +49,29 @@ present_fake_get_ust_msc(ScreenPtr screen, uint64_t *ust, uint64_t *msc)
     return Success;
 }
 
-static void
-present_fake_notify(ScreenPtr screen, uint64_t event_id)
+/*
+ * Milliseconds until the earliest waiting MSC, 0 if none are waiting
+ */
+static CARD32
+present_fake_next_delay(ScreenPtr screen)
 {
-    uint64_t                    ust, msc;
+    present_screen_priv_ptr     screen_priv = present_screen_priv(screen);
+    present_fake_vblank_ptr     fake_vblank;
+    uint64_t                    msc = UINT64_MAX;
+    uint64_t                    ust, now;
 
-    present_fake_get_ust_msc(screen, &ust, &msc);
-    present_event_notify(event_id, ust, msc);
+    xorg_list_for_each_entry(fake_vblank, &screen_priv->fake_queue, list)
+        if (fake_vblank->msc < msc)
+            msc = fake_vblank->msc;
+
+    if (msc == UINT64_MAX)
+        return 0;
+
+    ust = msc * screen_priv->fake_interval;
+    now = GetTimeInMicros();
+    if (ust <= now)
+        return 1;
+    return (ust - now + 999) / 1000;
 }
 
 static CARD32
@@ -56,28 +79,48 @@ present_fake_do_timer(OsTimerPtr timer,
                       CARD32 time,
                       void *arg)
 {
-    present_fake_vblank_ptr     fake_vblank = arg;
+    ScreenPtr                   screen = arg;
+    present_screen_priv_ptr     screen_priv = present_screen_priv(screen);
+    present_fake_vblank_ptr     fake_vblank, tmp;
+    struct xorg_list            due;
+    uint64_t                    ust, msc;
+
+    present_fake_get_ust_msc(screen, &ust, &msc);
 
-    present_fake_notify(fake_vblank->screen, fake_vblank->event_id);
-    xorg_list_del(&fake_vblank->list);
-    TimerFree(fake_vblank->timer);
-    free(fake_vblank);
-    return 0;
+    /* Pull everything due first, notifying may queue new requests */
+    xorg_list_init(&due);
+    xorg_list_for_each_entry_safe(fake_vblank, tmp, &screen_priv->fake_queue, list) {
+        if (fake_vblank->msc <= msc) {
+            xorg_list_del(&fake_vblank->list);
+            xorg_list_append(&fake_vblank->list, &due);
+        }
+    }
+
+    xorg_list_for_each_entry_safe(fake_vblank, tmp, &due, list) {
+        xorg_list_del(&fake_vblank->list);
+        present_event_notify(fake_vblank->event_id, ust, msc);
+        free(fake_vblank);
+    }
+
+    return present_fake_next_delay(screen);
 }
 
 void
 present_fake_abort_vblank(ScreenPtr screen, uint64_t event_id, uint64_t msc)
 {
+    present_screen_priv_ptr     screen_priv = present_screen_priv(screen);
     present_fake_vblank_ptr     fake_vblank, tmp;
 
-    xorg_list_for_each_entry_safe(fake_vblank, tmp, &fake_vblank_queue, list) {
+    xorg_list_for_each_entry_safe(fake_vblank, tmp, &screen_priv->fake_queue, list) {
         if (fake_vblank->event_id == event_id) {
-            TimerFree(fake_vblank->timer); /* TimerFree will call TimerCancel() */
             xorg_list_del(&fake_vblank->list);
             free (fake_vblank);
             break;
         }
     }
+
+    if (xorg_list_is_empty(&screen_priv->fake_queue))
+        TimerCancel(screen_priv->fake_timer);
 }
 
 int
@@ -90,9 +133,13 @@ present_fake_queue_vblank(ScreenPtr     screen,
     uint64_t                    now = GetTimeInMicros();
     INT32                       delay = ((int64_t) (ust - now)) / 1000;
     present_fake_vblank_ptr     fake_vblank;
+    OsTimerPtr                  timer;
 
     if (delay <= 0) {
-        present_fake_notify(screen, event_id);
+        uint64_t                cur_ust, cur_msc;
+
+        present_fake_get_ust_msc(screen, &cur_ust, &cur_msc);
+        present_event_notify(event_id, cur_ust, cur_msc);
         return Success;
     }
 
@@ -100,15 +147,20 @@ present_fake_queue_vblank(ScreenPtr     screen,
     if (!fake_vblank)
         return BadAlloc;
 
-    fake_vblank->screen = screen;
     fake_vblank->event_id = event_id;
-    fake_vblank->timer = TimerSet(NULL, 0, delay, present_fake_do_timer, fake_vblank);
-    if (!fake_vblank->timer) {
+    fake_vblank->msc = msc;
+    xorg_list_append(&fake_vblank->list, &screen_priv->fake_queue);
+
+    /* Aim the screen's clock at the earliest waiting MSC */
+    timer = TimerSet(screen_priv->fake_timer, 0,
+                     present_fake_next_delay(screen),
+                     present_fake_do_timer, screen);
+    if (!timer) {
+        xorg_list_del(&fake_vblank->list);
         free(fake_vblank);
         return BadAlloc;
     }
-
-    xorg_list_add(&fake_vblank->list, &fake_vblank_queue);
+    screen_priv->fake_timer = timer;
 
     return Success;
 }
@@ -122,16 +174,28 @@ present_fake_screen_init(ScreenPtr screen)
      * will be used for off-screen windows and while screens are blanked,
      * in which case we want a slow interval here
      *
-     * Otherwise, pretend that the screen runs at 60Hz
+     * Otherwise, pretend that the screen runs at the -fakerefresh rate,
+     * 60Hz by default
      */
     if (screen_priv->info && screen_priv->info->get_crtc)
         screen_priv->fake_interval = 1000000;
+    else if (FakeScreenRefresh > 0)
+        screen_priv->fake_interval = max(1000000 / FakeScreenRefresh, 1);
     else
         screen_priv->fake_interval = 16667;
 }
 
 void
-present_fake_queue_init(void)
+present_fake_screen_fini(ScreenPtr screen)
 {
-    xorg_list_init(&fake_vblank_queue);
+    present_screen_priv_ptr     screen_priv = present_screen_priv(screen);
+    present_fake_vblank_ptr     fake_vblank, tmp;
+
+    xorg_list_for_each_entry_safe(fake_vblank, tmp, &screen_priv->fake_queue, list) {
+        xorg_list_del(&fake_vblank->list);
+        free(fake_vblank);
+    }
+
+    TimerFree(screen_priv->fake_timer);
+    screen_priv->fake_timer = NULL;
 }
@@ -154,6 +154,8 @@ struct present_screen_priv {
     uint64_t                    unflip_event_id;
 
     uint32_t                    fake_interval;
+    struct xorg_list            fake_queue;     /* waiting fake vblanks */
+    OsTimerPtr                  fake_timer;     /* ticks while fake_queue is non-empty */
 
     /* Currently active flipped pixmap and fence */
     RRCrtcPtr                   flip_crtc;
@@ -230,6 +232,10 @@ struct present_window_priv {
 
     present_vblank_ptr     flip_pending;
     present_vblank_ptr     flip_active;
+
+    /* Used for pixmap exchange on redirected windows (scmd) */
+    present_vblank_ptr     exchange_active;
+    unsigned int           exchange_refcnt;
 };
 
 #define PresentCrtcNeverSet     ((RRCrtcPtr) 1)
@@ -365,7 +371,7 @@ void
 present_fake_screen_init(ScreenPtr screen);
 
 void
-present_fake_queue_init(void);
+present_fake_screen_fini(ScreenPtr screen);
 
 /*
  * present_fence.c
@@ -439,6 +445,9 @@ present_restore_screen_pixmap(ScreenPtr screen);
 void
 present_set_abort_flip(ScreenPtr screen);
 
+void
+present_release_exchange(WindowPtr window, Bool restore);
+
 Bool
 present_init(void);
 
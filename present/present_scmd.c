@@ -430,6 +430,18 @@ present_check_flip_window (WindowPtr window)
     if (!window_priv)
         return;
 
+    /* An exchanged pixmap only stays while it is still the window
+     * pixmap and the window is not clipped by children
+     */
+    if (window_priv->exchange_active) {
+        PixmapPtr exchanged = window_priv->exchange_active->pixmap;
+
+        if ((*screen->GetWindowPixmap)(window) != exchanged)
+            present_release_exchange(window, FALSE);
+        else if (!RegionEqual(&window->clipList, &window->winSize))
+            present_release_exchange(window, TRUE);
+    }
+
     if (screen_priv->unflip_event_id)
         return;
 
@@ -501,6 +513,162 @@ present_scmd_can_window_flip(WindowPtr window)
     return TRUE;
 }
 
+/*
+ * Pixmap exchange
+ *
+ * A composite-redirected window already has a pixmap of its own, so
+ * when a present covers that pixmap exactly there is no need to copy:
+ * the presented pixmap simply becomes the window pixmap, much like a
+ * window flip in wnmd. The presented pixmap then stays busy until it
+ * is replaced by the next exchange or the window gets a backing pixmap
+ * of its own back, at which point it is reported idle.
+ *
+ * This is only done while nobody else holds a reference to the window
+ * pixmap (e.g. a compositor which named it), as they would keep
+ * looking at the old one.
+ */
+static Bool
+present_scmd_can_exchange(present_vblank_ptr vblank)
+{
+#ifdef COMPOSITE
+    WindowPtr                   window = vblank->window;
+    ScreenPtr                   screen = window->drawable.pScreen;
+    present_window_priv_ptr     window_priv = present_window_priv(window);
+    present_vblank_ptr          active = window_priv->exchange_active;
+    PixmapPtr                   pixmap = vblank->pixmap;
+    PixmapPtr                   window_pixmap;
+
+    if (window->redirectDraw == RedirectDrawNone)
+        return FALSE;
+
+    window_pixmap = (*screen->GetWindowPixmap)(window);
+    if (window_pixmap == pixmap)
+        return FALSE;
+
+    /* No one but composite (or us) may be holding the window pixmap */
+    if (active && active->pixmap == window_pixmap) {
+        if (window_pixmap->refcnt != window_priv->exchange_refcnt)
+            return FALSE;
+    } else if (window_pixmap->refcnt != 1)
+        return FALSE;
+
+    /* The presented pixmap must replace all of the window contents */
+    if (vblank->x_off || vblank->y_off || vblank->valid || vblank->update)
+        return FALSE;
+
+    if (window->borderWidth ||
+        pixmap->drawable.width != window->drawable.width ||
+        pixmap->drawable.height != window->drawable.height ||
+        pixmap->drawable.width != window_pixmap->drawable.width ||
+        pixmap->drawable.height != window_pixmap->drawable.height ||
+        pixmap->drawable.depth != window_pixmap->drawable.depth ||
+        pixmap->drawable.bitsPerPixel != window_pixmap->drawable.bitsPerPixel)
+        return FALSE;
+
+    /* Children would lose whatever they drew into the window pixmap */
+    if (!RegionEqual(&window->clipList, &window->winSize))
+        return FALSE;
+
+    return TRUE;
+#else
+    return FALSE;
+#endif
+}
+
+static void
+present_scmd_exchange(present_vblank_ptr vblank, uint64_t ust, uint64_t crtc_msc)
+{
+    WindowPtr                   window = vblank->window;
+    ScreenPtr                   screen = window->drawable.pScreen;
+    present_screen_priv_ptr     screen_priv = present_screen_priv(screen);
+    present_window_priv_ptr     window_priv = present_window_priv(window);
+    present_vblank_ptr          active = window_priv->exchange_active;
+    PixmapPtr                   old_pixmap = (*screen->GetWindowPixmap)(window);
+
+    DebugPresent(("\tx %" PRIu64 " %p %" PRIu64 ": %08" PRIx32 " -> %08" PRIx32 "\n",
+                  vblank->event_id, vblank, crtc_msc,
+                  vblank->pixmap->drawable.id, window->drawable.id));
+
+    /* Replace window pixmap with the presented pixmap */
+#ifdef COMPOSITE
+    vblank->pixmap->screen_x = old_pixmap->screen_x;
+    vblank->pixmap->screen_y = old_pixmap->screen_y;
+#endif
+    present_set_tree_pixmap(window, old_pixmap, vblank->pixmap);
+    vblank->pixmap->refcnt++;
+    dixDestroyPixmap(old_pixmap, old_pixmap->drawable.id);
+
+    window_priv->exchange_active = vblank;
+    window_priv->exchange_refcnt = vblank->pixmap->refcnt;
+
+    /* The previously exchanged pixmap is no longer in use */
+    if (active) {
+        present_pixmap_idle(active->pixmap, active->window, active->serial, active->idle_fence);
+        present_vblank_destroy(active);
+    }
+
+    DamageDamageRegion(&window->drawable, &window->clipList);
+    screen_priv->flush(window);
+
+    present_vblank_notify(vblank, vblank->kind, PresentCompleteModeFlip, ust, crtc_msc);
+}
+
+/*
+ * Stop using an exchanged pixmap for 'window' and report it idle. With
+ * 'restore', a window still showing it gets a copy in a new backing
+ * pixmap of its own; otherwise whoever replaced or is tearing down the
+ * window pixmap has already taken care of that.
+ *
+ * The window keeps the exchanged pixmap if anybody else took a reference
+ * to it, e.g. a compositor naming the window pixmap, as they would keep
+ * looking at a pixmap that is no longer the window's. The same goes when
+ * no backing pixmap can be allocated. Copies then land in the exchanged
+ * pixmap, which stays busy; the release is tried again on the next copy
+ * present or clip change and happens for good once composite replaces
+ * the window pixmap or the window is destroyed.
+ */
+void
+present_release_exchange(WindowPtr window, Bool restore)
+{
+    ScreenPtr                   screen = window->drawable.pScreen;
+    present_window_priv_ptr     window_priv = present_window_priv(window);
+    present_vblank_ptr          vblank;
+    PixmapPtr                   pixmap;
+
+    if (!window_priv || !window_priv->exchange_active)
+        return;
+
+    vblank = window_priv->exchange_active;
+    pixmap = vblank->pixmap;
+
+    if (restore && (*screen->GetWindowPixmap)(window) == pixmap) {
+        PixmapPtr backing;
+
+        if (pixmap->refcnt > window_priv->exchange_refcnt)
+            return;
+
+        backing = (*screen->CreatePixmap)(screen,
+                                          pixmap->drawable.width,
+                                          pixmap->drawable.height,
+                                          pixmap->drawable.depth,
+                                          CREATE_PIXMAP_USAGE_BACKING_PIXMAP);
+        if (!backing)
+            return;
+
+        present_copy_region(&backing->drawable, pixmap, NULL, 0, 0);
+#ifdef COMPOSITE
+        backing->screen_x = pixmap->screen_x;
+        backing->screen_y = pixmap->screen_y;
+#endif
+        present_set_tree_pixmap(window, pixmap, backing);
+        dixDestroyPixmap(pixmap, pixmap->drawable.id);
+    }
+
+    window_priv->exchange_active = NULL;
+    present_pixmap_idle(pixmap, vblank->window, vblank->serial, vblank->idle_fence);
+    present_vblank_destroy(vblank);
+}
+
 /*
  * Once the required MSC has been reached, execute the pending request.
  *
@@ -605,6 +773,13 @@ present_execute(present_vblank_ptr vblank, uint64_t ust, uint64_t crtc_msc)
                 present_unflip(screen);
         }
 
+        if (vblank->exec_msc != crtc_msc + 1 &&
+            present_scmd_can_exchange(vblank)) {
+            present_scmd_exchange(vblank, ust, crtc_msc);
+            return;
+        }
+        present_release_exchange(window, TRUE);
+
         present_execute_copy(vblank, crtc_msc);
 
         if (vblank->queued) {
@@ -833,6 +1008,5 @@ present_init(void)
 {
     xorg_list_init(&present_exec_queue);
     xorg_list_init(&present_flip_queue);
-    present_fake_queue_init();
     return TRUE;
 }
@@ -63,6 +63,8 @@ present_close_screen(ScreenPtr screen)
     if (screen_priv->flip_destroy)
         screen_priv->flip_destroy(screen);
 
+    present_fake_screen_fini(screen);
+
     unwrap(screen_priv, screen, CloseScreen);
     (*screen->CloseScreen) (screen);
     free(screen_priv);
@@ -104,6 +106,7 @@ present_clear_window_flip(WindowPtr window)
         present_restore_screen_pixmap(screen);
         screen_priv->flip_window = NULL;
     }
+    present_release_exchange(window, FALSE);
 }
 
 static void
@@ -228,6 +231,8 @@ present_screen_priv_init(ScreenPtr screen)
     wrap(screen_priv, screen, ConfigNotify, present_config_notify);
     wrap(screen_priv, screen, ClipNotify, present_clip_notify);
 
+    xorg_list_init(&screen_priv->fake_queue);
+
     dixSetPrivate(&screen->devPrivates, &present_screen_private_key, screen_priv);
 
     return screen_priv;
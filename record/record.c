@@ -61,9 +61,10 @@ and Jim Haggerty of Metheus.
 static RESTYPE RTContext;       /* internal resource type for Record contexts */
 
 /* How many bytes of protocol data to buffer in a context. Don't set to less
- * than 32.
+ * than 32.  Consecutive elements from the same client and category share
+ * one reply, so a larger buffer means fewer, larger writes.
  */
-#define REPLY_BUF_SIZE 1024
+#define REPLY_BUF_SIZE 8192
 
 /* Record Context structure */
 
@@ -93,6 +94,13 @@ typedef union {
     } major;
 } RecordMinorOpRec, *RecordMinorOpPtr;
 
+/*  RecordMinorBits - flattened minor opcode selections for one extension
+ *  major opcode.  Extension minor opcodes are CARD16 on the wire, but the
+ *  ones in use fit in a byte; larger ones are checked against the sets.
+ */
+
+typedef CARD32 RecordMinorBits[8];
+
 /*  RecordClientsAndProtocolRec, nicknamed RCAP - holds all the client and
  *  protocol selections passed in a single CreateContext or RegisterClients.
  *  Generally, a context will have one of these from the create and an
@@ -116,14 +124,31 @@ typedef struct _RecordClientsAndProtocolRec {
     unsigned int clientStarted:1;       /* record new client connections? */
     unsigned int clientDied:1;  /* record client disconnections? */
     unsigned int clientIDsSeparatelyAllocated:1;        /* pClientIDs malloced? */
+
+    /* the sets above flattened to bitmaps, so that the recording hooks
+     * can test membership with a single bit test
+     */
+    CARD32 requestBits[8];      /* pRequestMajorOpSet */
+    CARD32 replyBits[8];        /* pReplyMajorOpSet */
+    CARD32 deliveredEventBits[4];       /* pDeliveredEventSet */
+    CARD32 errorBits[8];        /* pErrorSet */
+    RecordMinorBits *pRequestMinorBits; /* per extension major, or NULL */
+    RecordMinorBits *pReplyMinorBits;   /* per extension major, or NULL */
 } RecordClientsAndProtocolRec, *RecordClientsAndProtocolPtr;
 
+#define RecordBitIsSet(_bits, _i) ((_bits)[(_i) >> 5] & (1U << ((_i) & 31)))
+
 /* how much bigger to make pRCAP->pClientIDs when reallocing */
 #define CLIENT_ARRAY_GROWTH_INCREMENT 4
 
 /* counts the total number of RCAPs belonging to enabled contexts. */
 static int numEnabledRCAPs;
 
+/* Bumped whenever enabled contexts or the clients on their RCAPs change,
+ * making every client's RecordClientFilterRec stale.
+ */
+static unsigned int recordFilterGeneration = 1;
+
 /*  void VERIFY_CONTEXT(RecordContextPtr, XID, ClientPtr)
  *  In the spirit of the VERIFY_* macros in dix.h, this macro fills in
  *  the context pointer if the given ID is a valid Record Context, else it
@@ -171,6 +196,26 @@ static DevPrivateKeyRec RecordClientPrivateKeyRec;
  */
 #define RecordClientPrivate(_pClient) (RecordClientPrivatePtr) \
     dixLookupPrivate(&(_pClient)->devPrivates, RecordClientPrivateKey)
+
+/* Record client filter.  Every client has one; it caches the RCAPs the
+ * client is registered on, one per enabled context it is recorded by, so
+ * the recording hooks don't have to search the contexts for each element.
+ */
+typedef struct {
+    RecordContextPtr pContext;
+    RecordClientsAndProtocolPtr pRCAP;
+} RecordClientContextRec, *RecordClientContextPtr;
+
+typedef struct {
+    unsigned int generation;    /* recordFilterGeneration when computed */
+    int numContexts;            /* number of entries in pContexts */
+    int sizeContexts;           /* size of pContexts array */
+    RecordClientContextPtr pContexts;
+} RecordClientFilterRec, *RecordClientFilterPtr;
+
+static DevPrivateKeyRec RecordClientFilterKeyRec;
+
+#define RecordClientFilterKey (&RecordClientFilterKeyRec)
 
 /***************************************************************************/
 
@@ -432,6 +477,91 @@ RecordFindClientOnContext(RecordContextPtr pContext,
     return NULL;
 }                               /* RecordFindClientOnContext */
 
+/* RecordGetClientFilter
+ *
+ * Arguments:
+ *	pClient is the client whose protocol may be recorded.
+ *
+ * Returns:
+ *	The client's filter, listing the enabled contexts that record the
+ *	client and the RCAP the client is on for each, in the order of
+ *	ppAllContexts.  Returns NULL if memory for the list runs out.
+ *
+ * Side Effects:
+ *	If the filter is stale, it is recomputed.
+ */
+static RecordClientFilterPtr
+RecordGetClientFilter(ClientPtr pClient)
+{
+    RecordClientFilterPtr pFilter =
+        dixGetPrivateAddr(&pClient->devPrivates, RecordClientFilterKey);
+    int eci;
+
+    if (pFilter->generation == recordFilterGeneration)
+        return pFilter;
+
+    if (pFilter->sizeContexts < numEnabledContexts) {
+        RecordClientContextPtr pNew =
+            reallocarray(pFilter->pContexts, numEnabledContexts,
+                         sizeof(RecordClientContextRec));
+
+        if (!pNew)
+            return NULL;
+        pFilter->pContexts = pNew;
+        pFilter->sizeContexts = numEnabledContexts;
+    }
+
+    pFilter->numContexts = 0;
+    for (eci = 0; eci < numEnabledContexts; eci++) {
+        RecordContextPtr pContext = ppAllContexts[eci];
+        RecordClientsAndProtocolPtr pRCAP;
+
+        pRCAP = RecordFindClientOnContext(pContext, pClient->clientAsMask,
+                                          NULL);
+        if (pRCAP) {
+            pFilter->pContexts[pFilter->numContexts].pContext = pContext;
+            pFilter->pContexts[pFilter->numContexts].pRCAP = pRCAP;
+            pFilter->numContexts++;
+        }
+    }
+    pFilter->generation = recordFilterGeneration;
+    return pFilter;
+}                               /* RecordGetClientFilter */
+
+/* RecordIsMemberOfMinorOps
+ *
+ * Arguments:
+ *	pMinorOpInfo is the extension request or reply selection of an RCAP.
+ *	pMinorBits is the flattened form of pMinorOpInfo.
+ *	majorop and minorop identify the extension request.
+ *
+ * Returns: non-zero if the request or reply is selected.
+ *
+ * Side Effects: none.
+ */
+static int
+RecordIsMemberOfMinorOps(RecordMinorOpPtr pMinorOpInfo,
+                         RecordMinorBits *pMinorBits, int majorop,
+                         int minorop)
+{
+    int numMinOpInfo;
+
+    assert(pMinorOpInfo);
+    if (minorop < 256)
+        return RecordBitIsSet(pMinorBits[majorop - 128], minorop);
+
+    numMinOpInfo = pMinorOpInfo->count;
+    pMinorOpInfo++;
+    assert(numMinOpInfo);
+    for (; numMinOpInfo; numMinOpInfo--, pMinorOpInfo++) {
+        if (majorop >= pMinorOpInfo->major.first &&
+            majorop <= pMinorOpInfo->major.last &&
+            RecordIsMemberOfSet(pMinorOpInfo->major.pMinOpSet, minorop))
+            return 1;
+    }
+    return 0;
+}                               /* RecordIsMemberOfMinorOps */
+
 /* RecordABigRequest
  *
  * Arguments:
@@ -501,6 +631,7 @@ RecordARequest(ClientPtr client)
 {
     RecordContextPtr pContext;
     RecordClientsAndProtocolPtr pRCAP;
+    RecordClientFilterPtr pFilter;
     int i;
     RecordClientPrivatePtr pClientPriv;
 
@@ -508,47 +639,24 @@ RecordARequest(ClientPtr client)
     int majorop;
 
     majorop = stuff->reqType;
-    for (i = 0; i < numEnabledContexts; i++) {
-        pContext = ppAllContexts[i];
-        pRCAP = RecordFindClientOnContext(pContext, client->clientAsMask, NULL);
-        if (pRCAP && pRCAP->pRequestMajorOpSet &&
-            RecordIsMemberOfSet(pRCAP->pRequestMajorOpSet, majorop)) {
-            if (majorop <= 127) {       /* core request */
-
-                if (stuff->length == 0)
-                    RecordABigRequest(pContext, client, stuff);
-                else
-                    RecordAProtocolElement(pContext, client, XRecordFromClient,
-                                           (void *) stuff,
-                                           client->req_len << 2, 0, 0);
-            }
-            else {              /* extension, check minor opcode */
-
-                int minorop = client->minorOp;
-                int numMinOpInfo;
-                RecordMinorOpPtr pMinorOpInfo = pRCAP->pRequestMinOpInfo;
-
-                assert(pMinorOpInfo);
-                numMinOpInfo = pMinorOpInfo->count;
-                pMinorOpInfo++;
-                assert(numMinOpInfo);
-                for (; numMinOpInfo; numMinOpInfo--, pMinorOpInfo++) {
-                    if (majorop >= pMinorOpInfo->major.first &&
-                        majorop <= pMinorOpInfo->major.last &&
-                        RecordIsMemberOfSet(pMinorOpInfo->major.pMinOpSet,
-                                            minorop)) {
-                        if (stuff->length == 0)
-                            RecordABigRequest(pContext, client, stuff);
-                        else
-                            RecordAProtocolElement(pContext, client,
-                                                   XRecordFromClient,
-                                                   (void *) stuff,
-                                                   client->req_len << 2, 0, 0);
-                        break;
-                    }
-                }               /* end for each minor op info */
-            }                   /* end extension request */
-        }                       /* end this RCAP wants this major opcode */
+    pFilter = RecordGetClientFilter(client);
+    for (i = 0; pFilter && i < pFilter->numContexts; i++) {
+        pContext = pFilter->pContexts[i].pContext;
+        pRCAP = pFilter->pContexts[i].pRCAP;
+        if (!RecordBitIsSet(pRCAP->requestBits, majorop))
+            continue;
+        /* extension, check minor opcode */
+        if (majorop > 127 &&
+            !RecordIsMemberOfMinorOps(pRCAP->pRequestMinOpInfo,
+                                      pRCAP->pRequestMinorBits, majorop,
+                                      client->minorOp))
+            continue;
+
+        if (stuff->length == 0)
+            RecordABigRequest(pContext, client, stuff);
+        else
+            RecordAProtocolElement(pContext, client, XRecordFromClient,
+                                   (void *) stuff, client->req_len << 2, 0, 0);
     }                           /* end for each context */
     pClientPriv = RecordClientPrivate(client);
     assert(pClientPriv);
@@ -579,62 +687,38 @@ RecordAReply(CallbackListPtr *pcbl, void *nulldata, void *calldata)
 {
     RecordContextPtr pContext;
     RecordClientsAndProtocolPtr pRCAP;
+    RecordClientFilterPtr pFilter;
     int eci;
     ReplyInfoRec *pri = (ReplyInfoRec *) calldata;
     ClientPtr client = pri->client;
 
-    for (eci = 0; eci < numEnabledContexts; eci++) {
-        pContext = ppAllContexts[eci];
-        pRCAP = RecordFindClientOnContext(pContext, client->clientAsMask, NULL);
-        if (pRCAP) {
-            int majorop = client->majorOp;
-
-            if (pContext->continuedReply) {
-                RecordAProtocolElement(pContext, client, XRecordFromServer,
-                                       (void *) pri->replyData,
-                                       pri->dataLenBytes, pri->padBytes,
-                                       /* continuation */ -1);
-                if (!pri->bytesRemaining)
-                    pContext->continuedReply = 0;
-            }
-            else if (pri->startOfReply && pRCAP->pReplyMajorOpSet &&
-                     RecordIsMemberOfSet(pRCAP->pReplyMajorOpSet, majorop)) {
-                if (majorop <= 127) {   /* core reply */
-                    RecordAProtocolElement(pContext, client, XRecordFromServer,
-                                           (void *) pri->replyData,
-                                           pri->dataLenBytes, 0,
-                                           pri->bytesRemaining);
-                    if (pri->bytesRemaining)
-                        pContext->continuedReply = 1;
-                }
-                else {          /* extension, check minor opcode */
-
-                    int minorop = client->minorOp;
-                    int numMinOpInfo;
-                    RecordMinorOpPtr pMinorOpInfo = pRCAP->pReplyMinOpInfo;
-
-                    assert(pMinorOpInfo);
-                    numMinOpInfo = pMinorOpInfo->count;
-                    pMinorOpInfo++;
-                    assert(numMinOpInfo);
-                    for (; numMinOpInfo; numMinOpInfo--, pMinorOpInfo++) {
-                        if (majorop >= pMinorOpInfo->major.first &&
-                            majorop <= pMinorOpInfo->major.last &&
-                            RecordIsMemberOfSet(pMinorOpInfo->major.pMinOpSet,
-                                                minorop)) {
-                            RecordAProtocolElement(pContext, client,
-                                                   XRecordFromServer,
-                                                   (void *) pri->replyData,
-                                                   pri->dataLenBytes, 0,
-                                                   pri->bytesRemaining);
-                            if (pri->bytesRemaining)
-                                pContext->continuedReply = 1;
-                            break;
-                        }
-                    }           /* end for each minor op info */
-                }               /* end extension reply */
-            }                   /* end continued reply vs. start of reply */
-        }                       /* end client is registered on this context */
+    pFilter = RecordGetClientFilter(client);
+    for (eci = 0; pFilter && eci < pFilter->numContexts; eci++) {
+        int majorop = client->majorOp;
+
+        pContext = pFilter->pContexts[eci].pContext;
+        pRCAP = pFilter->pContexts[eci].pRCAP;
+        if (pContext->continuedReply) {
+            RecordAProtocolElement(pContext, client, XRecordFromServer,
+                                   (void *) pri->replyData,
+                                   pri->dataLenBytes, pri->padBytes,
+                                   /* continuation */ -1);
+            if (!pri->bytesRemaining)
+                pContext->continuedReply = 0;
+        }
+        else if (pri->startOfReply &&
+                 RecordBitIsSet(pRCAP->replyBits, majorop) &&
+                 (majorop <= 127 ||     /* core reply */
+                  RecordIsMemberOfMinorOps(pRCAP->pReplyMinOpInfo,
+                                           pRCAP->pReplyMinorBits, majorop,
+                                           client->minorOp))) {
+            RecordAProtocolElement(pContext, client, XRecordFromServer,
+                                   (void *) pri->replyData,
+                                   pri->dataLenBytes, 0,
+                                   pri->bytesRemaining);
+            if (pri->bytesRemaining)
+                pContext->continuedReply = 1;
+        }                       /* end continued reply vs. start of reply */
     }                           /* end for each context */
 }                               /* RecordAReply */
 
@@ -660,14 +744,15 @@ RecordADeliveredEventOrError(CallbackListPtr *pcbl, void *nulldata,
     EventInfoRec *pei = (EventInfoRec *) calldata;
     RecordContextPtr pContext;
     RecordClientsAndProtocolPtr pRCAP;
-    int eci;                    /* enabled context index */
+    RecordClientFilterPtr pFilter;
+    int eci;                    /* index into the client's contexts */
     ClientPtr pClient = pei->client;
 
-    for (eci = 0; eci < numEnabledContexts; eci++) {
-        pContext = ppAllContexts[eci];
-        pRCAP = RecordFindClientOnContext(pContext, pClient->clientAsMask,
-                                          NULL);
-        if (pRCAP && (pRCAP->pDeliveredEventSet || pRCAP->pErrorSet)) {
+    pFilter = RecordGetClientFilter(pClient);
+    for (eci = 0; pFilter && eci < pFilter->numContexts; eci++) {
+        pContext = pFilter->pContexts[eci].pContext;
+        pRCAP = pFilter->pContexts[eci].pRCAP;
+        if (pRCAP->pDeliveredEventSet || pRCAP->pErrorSet) {
             int ev;             /* event index */
             xEvent *pev = pei->events;
 
@@ -675,13 +760,12 @@ RecordADeliveredEventOrError(CallbackListPtr *pcbl, void *nulldata,
                 int recordit = 0;
 
                 if (pRCAP->pErrorSet) {
-                    recordit = RecordIsMemberOfSet(pRCAP->pErrorSet,
-                                                   ((xError *) (pev))->
-                                                   errorCode);
+                    recordit = RecordBitIsSet(pRCAP->errorBits,
+                                              ((xError *) (pev))->errorCode);
                 }
                 else if (pRCAP->pDeliveredEventSet) {
-                    recordit = RecordIsMemberOfSet(pRCAP->pDeliveredEventSet,
-                                                   pev->u.u.type & 0177);
+                    recordit = RecordBitIsSet(pRCAP->deliveredEventBits,
+                                              pev->u.u.type & 0177);
                 }
                 if (recordit) {
                     xEvent swappedEvent;
@@ -1030,6 +1114,7 @@ RecordDeleteClientFromRCAP(RecordClientsAndProtocolPtr pRCAP, int position)
 {
     if (pRCAP->pContext->pRecordingClient)
         RecordUninstallHooks(pRCAP, pRCAP->pClientIDs[position]);
+    recordFilterGeneration++;
     if (position != pRCAP->numClients - 1)
         pRCAP->pClientIDs[position] = pRCAP->pClientIDs[pRCAP->numClients - 1];
     if (--pRCAP->numClients == 0) {     /* no more clients; remove RCAP from context's list */
@@ -1096,6 +1181,7 @@ RecordAddClientToRCAP(RecordClientsAndProtocolPtr pRCAP, XID clientspec)
         }
     }
     pRCAP->pClientIDs[pRCAP->numClients++] = clientspec;
+    recordFilterGeneration++;
     if (pRCAP->pContext->pRecordingClient)
         RecordInstallHooks(pRCAP, clientspec);
 }                               /* RecordDeleteClientFromRCAP */
@@ -1508,6 +1594,67 @@ RecordConvertRangesToIntervals(SetInfoPtr psi,
 #define offset_of(_structure, _field) \
     ((char *)(& (_structure . _field)) - (char *)(&_structure))
 
+/* RecordSetToBits
+ *
+ * Arguments:
+ *	pSet is the set to flatten, or NULL.
+ *	bits is an array of nbits bits.
+ *
+ * Returns: nothing.
+ *
+ * Side Effects:
+ *	bits is set to the members of pSet below nbits.
+ */
+static void
+RecordSetToBits(RecordSetPtr pSet, CARD32 *bits, int nbits)
+{
+    RecordSetIteratePtr pIter = NULL;
+    RecordSetInterval interval;
+
+    memset(bits, 0, nbits / 8);
+    if (!pSet)
+        return;
+    while ((pIter = RecordIterateSet(pSet, pIter, &interval))) {
+        unsigned int j;
+
+        for (j = interval.first; j <= interval.last && j < nbits; j++)
+            bits[j >> 5] |= 1U << (j & 31);
+    }
+}                               /* RecordSetToBits */
+
+/* RecordMinorOpsToBits
+ *
+ * Arguments:
+ *	pMinorOpInfo is an extension request or reply selection.
+ *	pMinorBits is an array of 128 RecordMinorBits, one per extension
+ *	  major opcode.
+ *
+ * Returns: nothing.
+ *
+ * Side Effects:
+ *	pMinorBits is set to the minor opcodes below 256 that pMinorOpInfo
+ *	selects for each major opcode.
+ */
+static void
+RecordMinorOpsToBits(RecordMinorOpPtr pMinorOpInfo,
+                     RecordMinorBits *pMinorBits)
+{
+    int numMinOpInfo = pMinorOpInfo->count;
+
+    memset(pMinorBits, 0, 128 * sizeof(RecordMinorBits));
+    for (pMinorOpInfo++; numMinOpInfo; numMinOpInfo--, pMinorOpInfo++) {
+        RecordMinorBits bits;
+        int major, j;
+
+        RecordSetToBits(pMinorOpInfo->major.pMinOpSet, bits, 256);
+        for (major = max(pMinorOpInfo->major.first, 128);
+             major <= min(pMinorOpInfo->major.last, 255); major++) {
+            for (j = 0; j < 8; j++)
+                pMinorBits[major - 128][j] |= bits[j];
+        }
+    }
+}                               /* RecordMinorOpsToBits */
+
 /* RecordRegisterClients
  *
  * Arguments:
@@ -1540,6 +1687,8 @@ RecordRegisterClients(RecordContextPtr pContext, ClientPtr client,
     int nExtRepSets = 0;
     int extReqSetsOffset = 0;
     int extRepSetsOffset = 0;
+    int extReqBitsOffset = 0;
+    int extRepBitsOffset = 0;
     SetInfoPtr pExtReqSets, pExtRepSets;
     int clientListOffset;
     XID *pCanonClients;
@@ -1673,6 +1822,18 @@ RecordRegisterClients(RecordContextPtr pContext, ClientPtr client,
         totRCAPsize += pad + (nExtRepSets + 1) * sizeof(RecordMinorOpRec);
     }
 
+    /* flattened minor opcodes for extension majors 128..255 */
+    if (nExtReqSets) {
+        pad = RecordPadAlign(totRCAPsize, sizeof(CARD32));
+        extReqBitsOffset = totRCAPsize + pad;
+        totRCAPsize += pad + 128 * sizeof(RecordMinorBits);
+    }
+    if (nExtRepSets) {
+        pad = RecordPadAlign(totRCAPsize, sizeof(CARD32));
+        extRepBitsOffset = totRCAPsize + pad;
+        totRCAPsize += pad + 128 * sizeof(RecordMinorBits);
+    }
+
     for (i = 0; i < maxSets; i++) {
         if (si[i].nintervals) {
             si[i].size =
@@ -1790,10 +1951,33 @@ RecordRegisterClients(RecordContextPtr pContext, ClientPtr client,
     pRCAP->clientStarted = clientStarted;
     pRCAP->clientDied = clientDied;
 
+    /* flatten the sets for the recording hooks */
+
+    RecordSetToBits(pRCAP->pRequestMajorOpSet, pRCAP->requestBits, 256);
+    RecordSetToBits(pRCAP->pReplyMajorOpSet, pRCAP->replyBits, 256);
+    RecordSetToBits(pRCAP->pDeliveredEventSet, pRCAP->deliveredEventBits, 128);
+    RecordSetToBits(pRCAP->pErrorSet, pRCAP->errorBits, 256);
+    if (nExtReqSets) {
+        pRCAP->pRequestMinorBits = (RecordMinorBits *)
+            ((char *) pRCAP + extReqBitsOffset);
+        RecordMinorOpsToBits(pRCAP->pRequestMinOpInfo,
+                             pRCAP->pRequestMinorBits);
+    }
+    else
+        pRCAP->pRequestMinorBits = NULL;
+    if (nExtRepSets) {
+        pRCAP->pReplyMinorBits = (RecordMinorBits *)
+            ((char *) pRCAP + extRepBitsOffset);
+        RecordMinorOpsToBits(pRCAP->pReplyMinOpInfo, pRCAP->pReplyMinorBits);
+    }
+    else
+        pRCAP->pReplyMinorBits = NULL;
+
     /* link the RCAP onto the context */
 
     pRCAP->pNextRCAP = pContext->pListOfRCAP;
     pContext->pListOfRCAP = pRCAP;
+    recordFilterGeneration++;
 
     if (pContext->pRecordingClient)     /* context enabled */
         RecordInstallHooks(pRCAP, 0);
@@ -2328,6 +2512,7 @@ ProcRecordEnableContext(ClientPtr client)
 
     ++numEnabledContexts;
     assert(numEnabledContexts > 0);
+    recordFilterGeneration++;
 
     /* send StartOfData */
     RecordAProtocolElement(pContext, NULL, XRecordStartOfData, NULL, 0, 0, 0);
@@ -2384,6 +2569,7 @@ RecordDisableContext(RecordContextPtr pContext)
     }
     --numEnabledContexts;
     assert(numEnabledContexts >= 0);
+    recordFilterGeneration++;
 }                               /* RecordDisableContext */
 
 static int
@@ -2708,6 +2894,7 @@ RecordAClientStateChange(CallbackListPtr *pcbl, void *nulldata,
     ClientPtr pClient = pci->client;
     RecordContextPtr *ppAllContextsCopy = NULL;
     int numContextsCopy = 0;
+    RecordClientFilterPtr pFilter;
 
     switch (pClient->clientState) {
     case ClientStateRunning:   /* new client */
@@ -2728,6 +2915,13 @@ RecordAClientStateChange(CallbackListPtr *pcbl, void *nulldata,
     case ClientStateGone:
     case ClientStateRetained:  /* client disconnected */
 
+        pFilter = dixGetPrivateAddr(&pClient->devPrivates,
+                                    RecordClientFilterKey);
+        free(pFilter->pContexts);
+        pFilter->pContexts = NULL;
+        pFilter->numContexts = pFilter->sizeContexts = 0;
+        pFilter->generation = 0;
+
         /* RecordDisableContext modifies contents of ppAllContexts. */
         if (!(numContextsCopy = numContexts))
             break;
@@ -2800,6 +2994,10 @@ RecordExtensionInit(void)
     if (!dixRegisterPrivateKey(RecordClientPrivateKey, PRIVATE_CLIENT, 0))
         return;
 
+    if (!dixRegisterPrivateKey(RecordClientFilterKey, PRIVATE_CLIENT,
+                               sizeof(RecordClientFilterRec)))
+        return;
+
     ppAllContexts = NULL;
     numContexts = numEnabledContexts = numEnabledRCAPs = 0;
 
@@ -0,0 +1,199 @@
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ * Contents of an automatically redirected window across resizes.
+ * A NorthWest-gravity window is filled with a pattern, then grown,
+ * shrunk and grown again while moving.  Every step reallocates the
+ * backing pixmap, which is seeded from the old one, so the surviving
+ * part of the pattern must stay put and the newly exposed part must
+ * show the window background, both in the window itself and in what
+ * the automatic composite pass leaves in the parent.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <xcb/xcb.h>
+#include <xcb/composite.h>
+
+#define BACKGROUND 0x202020
+#define PARENT_BACKGROUND 0x000080
+
+static const uint32_t quadrant[4] = { 0xff0000, 0x00ff00, 0x0000ff, 0xffff00 };
+
+/* Width and height of the area that still holds the original pattern */
+static int pattern_w = 100, pattern_h = 100;
+
+static uint32_t
+expected_pixel(int x, int y)
+{
+    if (x >= pattern_w || y >= pattern_h)
+        return BACKGROUND;
+    return quadrant[(x >= 50) + 2 * (y >= 50)];
+}
+
+/*
+ * Compare a w x h area of drawable at (x, y) with the expected window
+ * contents; ox, oy is where the window's origin lies in that drawable.
+ */
+static int
+check_area(xcb_connection_t *c, xcb_drawable_t drawable,
+           int x, int y, int w, int h, int ox, int oy, int report)
+{
+    xcb_get_image_reply_t *image;
+    uint32_t *data;
+    int i, j, bad = 0;
+
+    image = xcb_get_image_reply(c,
+            xcb_get_image(c, XCB_IMAGE_FORMAT_Z_PIXMAP, drawable,
+                          x, y, w, h, ~0), NULL);
+    if (!image) {
+        printf("GetImage failed\n");
+        exit(1);
+    }
+
+    data = (uint32_t *) xcb_get_image_data(image);
+    for (j = 0; j < h && !bad; j++) {
+        for (i = 0; i < w; i++) {
+            uint32_t got = data[j * w + i] & 0xffffff;
+            uint32_t want = expected_pixel(x + i - ox, y + j - oy);
+
+            if (got != want) {
+                if (report)
+                    printf("pixel %d,%d: got 0x%06x, expected 0x%06x\n",
+                           x + i - ox, y + j - oy, got, want);
+                bad = 1;
+                break;
+            }
+        }
+    }
+
+    free(image);
+    return !bad;
+}
+
+static void
+resize(xcb_connection_t *c, xcb_window_t parent, xcb_window_t window,
+       int x, int y, int w, int h)
+{
+    uint32_t values[4] = { x, y, w, h };
+    int tries;
+
+    xcb_configure_window(c, window,
+                         XCB_CONFIG_WINDOW_X | XCB_CONFIG_WINDOW_Y |
+                         XCB_CONFIG_WINDOW_WIDTH | XCB_CONFIG_WINDOW_HEIGHT,
+                         values);
+
+    if (!check_area(c, window, 0, 0, w, h, 0, 0, 1)) {
+        printf("Window contents wrong after resize to %dx%d\n", w, h);
+        exit(1);
+    }
+
+    /*
+     * The automatic composite pass runs from the block handler, which
+     * may come after our reply has been flushed; give it a few turns.
+     */
+    for (tries = 0; tries < 50; tries++) {
+        if (check_area(c, parent, x, y, w, h, x, y, 0))
+            return;
+        usleep(10000);
+    }
+    check_area(c, parent, x, y, w, h, x, y, 1);
+    printf("Parent contents wrong after resize to %dx%d\n", w, h);
+    exit(1);
+}
+
+int main(int argc, char **argv)
+{
+    int screen_num;
+    xcb_connection_t *c = xcb_connect(NULL, &screen_num);
+    const xcb_query_extension_reply_t *ext =
+        xcb_get_extension_data(c, &xcb_composite_id);
+    xcb_screen_t *screen;
+    xcb_window_t parent, window;
+    xcb_gcontext_t gc;
+    uint32_t values[2];
+    int i;
+
+    if (!ext->present) {
+        printf("No Composite present\n");
+        exit(77);
+    }
+
+    free(xcb_composite_query_version_reply(c,
+            xcb_composite_query_version(c, 0, 4), NULL));
+
+    screen = xcb_setup_roots_iterator(xcb_get_setup(c)).data;
+    if (screen->root_depth != 24) {
+        printf("Root depth %d, need 24\n", screen->root_depth);
+        exit(77);
+    }
+
+    values[0] = PARENT_BACKGROUND;
+    parent = xcb_generate_id(c);
+    xcb_create_window(c, XCB_COPY_FROM_PARENT, parent, screen->root,
+                      0, 0, 400, 300, 0, XCB_WINDOW_CLASS_INPUT_OUTPUT,
+                      screen->root_visual, XCB_CW_BACK_PIXEL, values);
+    xcb_composite_redirect_subwindows(c, parent,
+                                      XCB_COMPOSITE_REDIRECT_AUTOMATIC);
+
+    values[0] = BACKGROUND;
+    values[1] = XCB_GRAVITY_NORTH_WEST;
+    window = xcb_generate_id(c);
+    xcb_create_window(c, XCB_COPY_FROM_PARENT, window, parent,
+                      20, 20, 100, 100, 0, XCB_WINDOW_CLASS_INPUT_OUTPUT,
+                      screen->root_visual,
+                      XCB_CW_BACK_PIXEL | XCB_CW_BIT_GRAVITY, values);
+    xcb_map_window(c, window);
+    xcb_map_window(c, parent);
+
+    gc = xcb_generate_id(c);
+    xcb_create_gc(c, gc, window, 0, NULL);
+    for (i = 0; i < 4; i++) {
+        xcb_rectangle_t rect = { 50 * (i & 1), 50 * (i >> 1), 50, 50 };
+
+        xcb_change_gc(c, gc, XCB_GC_FOREGROUND, &quadrant[i]);
+        xcb_poly_fill_rectangle(c, window, gc, 1, &rect);
+    }
+
+    resize(c, parent, window, 20, 20, 100, 100);
+
+    /* Grow: the pattern stays, the new strips get the background */
+    resize(c, parent, window, 20, 20, 160, 140);
+
+    /* Shrink: only the top-left of the pattern survives */
+    pattern_w = 60;
+    pattern_h = 50;
+    resize(c, parent, window, 20, 20, 60, 50);
+
+    /* Grow while moving, so the old and new pixmaps are offset */
+    resize(c, parent, window, 70, 40, 200, 180);
+
+    /* Shrink while moving */
+    pattern_w = 40;
+    pattern_h = 30;
+    resize(c, parent, window, 90, 10, 40, 30);
+
+    xcb_disconnect(c);
+    exit(0);
+}
@@ -0,0 +1,123 @@
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ * Resize storm against automatically redirected windows: a stack of
+ * overlapping redirected windows is resized the way an interactive
+ * drag would, while the windows keep drawing into themselves.  Every
+ * resize reallocates the backing pixmap and every draw goes through
+ * the automatic composite pass.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <xcb/xcb.h>
+#include <xcb/composite.h>
+
+#define NUM_WINDOWS 8
+#define NUM_STEPS 2000
+
+static double
+now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char **argv)
+{
+    int screen_num;
+    xcb_connection_t *c = xcb_connect(NULL, &screen_num);
+    const xcb_query_extension_reply_t *ext =
+        xcb_get_extension_data(c, &xcb_composite_id);
+    xcb_screen_t *screen;
+    xcb_window_t parent, windows[NUM_WINDOWS];
+    xcb_gcontext_t gc;
+    xcb_generic_error_t *error;
+    double start, elapsed;
+    int i, step;
+
+    if (!ext->present) {
+        printf("No Composite present\n");
+        exit(77);
+    }
+
+    free(xcb_composite_query_version_reply(c,
+            xcb_composite_query_version(c, 0, 4), NULL));
+
+    screen = xcb_setup_roots_iterator(xcb_get_setup(c)).data;
+
+    parent = xcb_generate_id(c);
+    xcb_create_window(c, XCB_COPY_FROM_PARENT, parent, screen->root,
+                      0, 0, 800, 600, 0, XCB_WINDOW_CLASS_INPUT_OUTPUT,
+                      screen->root_visual, 0, NULL);
+    xcb_composite_redirect_subwindows(c, parent,
+                                      XCB_COMPOSITE_REDIRECT_AUTOMATIC);
+
+    for (i = 0; i < NUM_WINDOWS; i++) {
+        uint32_t bg = screen->white_pixel;
+
+        windows[i] = xcb_generate_id(c);
+        xcb_create_window(c, XCB_COPY_FROM_PARENT, windows[i], parent,
+                          20 * i, 20 * i, 200, 150, 0,
+                          XCB_WINDOW_CLASS_INPUT_OUTPUT,
+                          screen->root_visual, XCB_CW_BACK_PIXEL, &bg);
+        xcb_map_window(c, windows[i]);
+    }
+    xcb_map_window(c, parent);
+
+    gc = xcb_generate_id(c);
+    xcb_create_gc(c, gc, parent, 0, NULL);
+
+    start = now();
+    for (step = 0; step < NUM_STEPS; step++) {
+        for (i = 0; i < NUM_WINDOWS; i++) {
+            uint32_t size[2] = {
+                200 + (step * (i + 1)) % 300,
+                150 + (step * (i + 2)) % 200,
+            };
+            xcb_rectangle_t rect = { step % 100, step % 80, 32, 32 };
+
+            xcb_configure_window(c, windows[i],
+                                 XCB_CONFIG_WINDOW_WIDTH |
+                                 XCB_CONFIG_WINDOW_HEIGHT, size);
+            xcb_poly_fill_rectangle(c, windows[i], gc, 1, &rect);
+        }
+    }
+    error = xcb_request_check(c, xcb_map_window_checked(c, parent));
+    elapsed = now() - start;
+
+    if (error) {
+        printf("Resize storm failed with error %d\n", error->error_code);
+        free(error);
+        exit(1);
+    }
+
+    printf("%d resizes of %d redirected windows: %.3f s (%.1f us/resize)\n",
+           NUM_STEPS * NUM_WINDOWS, NUM_WINDOWS, elapsed,
+           elapsed * 1e6 / (NUM_STEPS * NUM_WINDOWS));
+
+    xcb_disconnect(c);
+    exit(0);
+}
@@ -0,0 +1,279 @@
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ * File descriptor passing under batched client I/O.  Several clients
+ * each queue a run of MIT-SHM AttachFd, ShmPutImage and GetImage
+ * requests before reading any replies, so the server reads requests and
+ * descriptors for many clients at once and writes more reply data than
+ * the sockets take in one go.  Every image is checked against what was
+ * put into its segment.  Then each client has the server create a
+ * segment and send its descriptor back, and checks ShmGetImage through
+ * it.  Run it both with and without -iouring.
+ */
+
+#define _GNU_SOURCE
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <xcb/xcb.h>
+#include <xcb/shm.h>
+
+#define NUM_CLIENTS 8
+#define NUM_ROUNDS 32
+#define WIDTH 128
+#define HEIGHT 128
+#define SIZE (WIDTH * HEIGHT * 4)
+
+typedef struct {
+    xcb_connection_t *c;
+    xcb_pixmap_t pixmap;
+    xcb_gcontext_t gc;
+    xcb_get_image_cookie_t cookie[NUM_ROUNDS];
+} TestClient;
+
+static uint32_t
+pattern(unsigned seed, unsigned i)
+{
+    return (seed * 2654435761u + i) & 0xffffff;
+}
+
+static void
+fill(uint32_t *pixels, unsigned seed)
+{
+    unsigned i;
+
+    for (i = 0; i < WIDTH * HEIGHT; i++)
+        pixels[i] = pattern(seed, i);
+}
+
+static int
+check(const uint32_t *pixels, unsigned seed, const char *what, int client)
+{
+    unsigned i;
+
+    for (i = 0; i < WIDTH * HEIGHT; i++) {
+        if ((pixels[i] & 0xffffff) != pattern(seed, i)) {
+            fprintf(stderr, "client %d: %s pixel %u is %06x, expected %06x\n",
+                    client, what, i, pixels[i] & 0xffffff, pattern(seed, i));
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* A segment for AttachFd holding the pattern for seed */
+static int
+make_segment(unsigned seed)
+{
+    void *map;
+    int fd;
+
+    fd = memfd_create("client-fds", MFD_CLOEXEC);
+    if (fd < 0 || ftruncate(fd, SIZE) < 0)
+        return -1;
+    map = mmap(NULL, SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        close(fd);
+        return -1;
+    }
+    fill(map, seed);
+    munmap(map, SIZE);
+    return fd;
+}
+
+static int
+setup_client(TestClient *t)
+{
+    xcb_screen_t *screen;
+
+    t->c = xcb_connect(NULL, NULL);
+    if (!t->c || xcb_connection_has_error(t->c))
+        return 0;
+    screen = xcb_setup_roots_iterator(xcb_get_setup(t->c)).data;
+    if (screen->root_depth != 24)
+        return 0;
+    t->pixmap = xcb_generate_id(t->c);
+    xcb_create_pixmap(t->c, 24, t->pixmap, screen->root, WIDTH, HEIGHT);
+    t->gc = xcb_generate_id(t->c);
+    xcb_create_gc(t->c, t->gc, t->pixmap, 0, NULL);
+    return 1;
+}
+
+/* Descriptors from the client to the server, and large batched replies */
+static int
+attach_rounds(TestClient *clients)
+{
+    int i, r;
+
+    for (i = 0; i < NUM_CLIENTS; i++) {
+        TestClient *t = &clients[i];
+
+        for (r = 0; r < NUM_ROUNDS; r++) {
+            xcb_shm_seg_t seg = xcb_generate_id(t->c);
+            int fd = make_segment(i * NUM_ROUNDS + r);
+
+            if (fd < 0) {
+                perror("memfd");
+                return 0;
+            }
+            /* xcb closes fd once it is sent */
+            xcb_shm_attach_fd(t->c, seg, fd, 1);
+            xcb_shm_put_image(t->c, t->pixmap, t->gc, WIDTH, HEIGHT, 0, 0,
+                              WIDTH, HEIGHT, 0, 0, 24,
+                              XCB_IMAGE_FORMAT_Z_PIXMAP, 0, seg, 0);
+            t->cookie[r] = xcb_get_image(t->c, XCB_IMAGE_FORMAT_Z_PIXMAP,
+                                         t->pixmap, 0, 0, WIDTH, HEIGHT, ~0);
+            xcb_shm_detach(t->c, seg);
+        }
+        xcb_flush(t->c);
+    }
+
+    /* Let the server run into full sockets before anybody reads */
+    usleep(100000);
+
+    for (i = 0; i < NUM_CLIENTS; i++) {
+        TestClient *t = &clients[i];
+
+        for (r = 0; r < NUM_ROUNDS; r++) {
+            xcb_generic_error_t *error = NULL;
+            xcb_get_image_reply_t *reply =
+                xcb_get_image_reply(t->c, t->cookie[r], &error);
+            int ok;
+
+            if (!reply) {
+                fprintf(stderr, "client %d: GetImage %d failed (%d)\n", i, r,
+                        error ? error->error_code : -1);
+                return 0;
+            }
+            ok = xcb_get_image_data_length(reply) == SIZE &&
+                check((uint32_t *) xcb_get_image_data(reply),
+                      i * NUM_ROUNDS + r, "GetImage", i);
+            free(reply);
+            if (!ok)
+                return 0;
+        }
+    }
+    return 1;
+}
+
+/* Descriptors from the server to the client */
+static int
+create_segments(TestClient *clients)
+{
+    xcb_shm_seg_t seg[NUM_CLIENTS];
+    xcb_shm_create_segment_cookie_t create[NUM_CLIENTS];
+    xcb_shm_get_image_cookie_t get[NUM_CLIENTS];
+    void *map[NUM_CLIENTS];
+    int i, ok = 1;
+
+    for (i = 0; i < NUM_CLIENTS; i++) {
+        seg[i] = xcb_generate_id(clients[i].c);
+        create[i] = xcb_shm_create_segment(clients[i].c, seg[i], SIZE, 0);
+        xcb_flush(clients[i].c);
+    }
+
+    for (i = 0; i < NUM_CLIENTS; i++) {
+        xcb_connection_t *c = clients[i].c;
+        xcb_shm_create_segment_reply_t *reply =
+            xcb_shm_create_segment_reply(c, create[i], NULL);
+
+        if (!reply || reply->nfd != 1) {
+            fprintf(stderr, "client %d: CreateSegment failed\n", i);
+            return 0;
+        }
+        map[i] = mmap(NULL, SIZE, PROT_READ | PROT_WRITE, MAP_SHARED,
+                      xcb_shm_create_segment_reply_fds(c, reply)[0], 0);
+        close(xcb_shm_create_segment_reply_fds(c, reply)[0]);
+        free(reply);
+        if (map[i] == MAP_FAILED) {
+            perror("mmap");
+            return 0;
+        }
+        get[i] = xcb_shm_get_image(c, clients[i].pixmap, 0, 0, WIDTH, HEIGHT,
+                                   ~0, XCB_IMAGE_FORMAT_Z_PIXMAP, seg[i], 0);
+        xcb_flush(c);
+    }
+
+    for (i = 0; i < NUM_CLIENTS; i++) {
+        xcb_shm_get_image_reply_t *reply =
+            xcb_shm_get_image_reply(clients[i].c, get[i], NULL);
+
+        if (!reply) {
+            fprintf(stderr, "client %d: ShmGetImage failed\n", i);
+            ok = 0;
+        }
+        else if (!check(map[i], i * NUM_ROUNDS + NUM_ROUNDS - 1,
+                        "ShmGetImage", i))
+            ok = 0;
+        free(reply);
+        xcb_shm_detach(clients[i].c, seg[i]);
+        munmap(map[i], SIZE);
+    }
+    return ok;
+}
+
+int
+main(void)
+{
+    TestClient clients[NUM_CLIENTS];
+    const xcb_query_extension_reply_t *ext;
+    xcb_shm_query_version_reply_t *version;
+    int i, fd_passing;
+
+    for (i = 0; i < NUM_CLIENTS; i++) {
+        if (!setup_client(&clients[i])) {
+            fprintf(stderr, "cannot set up client %d\n", i);
+            return 1;
+        }
+    }
+
+    ext = xcb_get_extension_data(clients[0].c, &xcb_shm_id);
+    if (!ext || !ext->present) {
+        fprintf(stderr, "MIT-SHM not present, skipping\n");
+        return 77;
+    }
+    version = xcb_shm_query_version_reply(clients[0].c,
+                                          xcb_shm_query_version(clients[0].c),
+                                          NULL);
+    fd_passing = version && (version->major_version > 1 ||
+                             version->minor_version >= 2);
+    free(version);
+    if (!fd_passing) {
+        fprintf(stderr, "MIT-SHM without fd passing, skipping\n");
+        return 77;
+    }
+
+    if (!attach_rounds(clients) || !create_segments(clients))
+        return 1;
+
+    for (i = 0; i < NUM_CLIENTS; i++) {
+        if (xcb_connection_has_error(clients[i].c)) {
+            fprintf(stderr, "client %d: connection error\n", i);
+            return 1;
+        }
+        xcb_disconnect(clients[i].c);
+    }
+    return 0;
+}
@@ -0,0 +1,91 @@
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ * Client I/O throughput: many clients each send a few round trips at
+ * once, so every server wakeup finds most of them ready.  Reports
+ * requests per second.  Run the server with -verbose 5 to have it log
+ * the socket calls it made per second alongside.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <xcb/xcb.h>
+
+#define NUM_CLIENTS 64
+#define NUM_ROUNDS 500
+#define PIPELINE 8
+
+static double
+now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int
+main(void)
+{
+    xcb_connection_t *c[NUM_CLIENTS];
+    xcb_get_input_focus_cookie_t cookie[NUM_CLIENTS][PIPELINE];
+    double start, elapsed;
+    int i, j, round;
+
+    for (i = 0; i < NUM_CLIENTS; i++) {
+        c[i] = xcb_connect(NULL, NULL);
+        if (!c[i] || xcb_connection_has_error(c[i])) {
+            fprintf(stderr, "cannot connect client %d\n", i);
+            return 1;
+        }
+    }
+
+    start = now();
+    for (round = 0; round < NUM_ROUNDS; round++) {
+        for (i = 0; i < NUM_CLIENTS; i++) {
+            for (j = 0; j < PIPELINE; j++)
+                cookie[i][j] = xcb_get_input_focus(c[i]);
+            xcb_flush(c[i]);
+        }
+        for (i = 0; i < NUM_CLIENTS; i++) {
+            for (j = 0; j < PIPELINE; j++) {
+                xcb_get_input_focus_reply_t *reply =
+                    xcb_get_input_focus_reply(c[i], cookie[i][j], NULL);
+
+                if (!reply) {
+                    fprintf(stderr, "client %d lost a reply\n", i);
+                    return 1;
+                }
+                free(reply);
+            }
+        }
+    }
+    elapsed = now() - start;
+
+    for (i = 0; i < NUM_CLIENTS; i++)
+        xcb_disconnect(c[i]);
+
+    printf("%d clients: %.0f requests/s\n", NUM_CLIENTS,
+           (double) NUM_CLIENTS * PIPELINE * NUM_ROUNDS / elapsed);
+    return 0;
+}
@@ -0,0 +1,169 @@
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ * Connection rate: open connections in bursts, so that the listen
+ * backlog fills up between two server wakeups, complete connection
+ * setup on each and close them again.  Reports connections per second.
+ *
+ * This talks to the local socket directly rather than through xcb, as
+ * xcb_connect would wait for each setup reply before the next connect.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define NUM_ROUNDS 200
+#define BURST 64
+
+static double
+now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int
+open_display(const char *path)
+{
+    struct sockaddr_un addr;
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if (fd < 0)
+        return -1;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", path);
+    if (connect(fd, (struct sockaddr *) &addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int
+read_all(int fd, void *buf, size_t len)
+{
+    char *p = buf;
+
+    while (len) {
+        ssize_t n = read(fd, p, len);
+
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return -1;
+        p += n;
+        len -= n;
+    }
+    return 0;
+}
+
+/* Send the connection setup prefix without authorization */
+static int
+send_setup(int fd)
+{
+    static const uint16_t one = 1;
+    uint8_t prefix[12] = { 0 };
+    uint16_t major = 11;
+
+    prefix[0] = *(const uint8_t *) &one ? 'l' : 'B';
+    memcpy(&prefix[2], &major, sizeof(major));
+    return write(fd, prefix, sizeof(prefix)) == sizeof(prefix) ? 0 : -1;
+}
+
+/* Read the whole setup reply; returns 0 if the connection was accepted */
+static int
+read_setup(int fd)
+{
+    uint8_t reply[8];
+    uint16_t length;
+    char *rest;
+    int ret;
+
+    if (read_all(fd, reply, sizeof(reply)) < 0)
+        return -1;
+    memcpy(&length, &reply[6], sizeof(length));
+    rest = malloc(length * 4 + 1);
+    if (!rest)
+        return -1;
+    ret = read_all(fd, rest, length * 4);
+    free(rest);
+    return ret < 0 || reply[0] != 1 ? -1 : 0;
+}
+
+int main(int argc, char **argv)
+{
+    int rounds = argc > 1 ? atoi(argv[1]) : NUM_ROUNDS;
+    const char *display = getenv("DISPLAY");
+    const char *colon;
+    char path[108];
+    int fds[BURST];
+    int r, i, done = 0, failed = 0;
+    double start, elapsed;
+
+    if (rounds <= 0)
+        rounds = NUM_ROUNDS;
+    if (!display || !(colon = strrchr(display, ':'))) {
+        fprintf(stderr, "DISPLAY not set\n");
+        return 1;
+    }
+    snprintf(path, sizeof(path), "/tmp/.X11-unix/X%d", atoi(colon + 1));
+
+    start = now();
+    for (r = 0; r < rounds; r++) {
+        for (i = 0; i < BURST; i++) {
+            fds[i] = open_display(path);
+            if (fds[i] >= 0 && send_setup(fds[i]) < 0) {
+                close(fds[i]);
+                fds[i] = -1;
+            }
+        }
+        for (i = 0; i < BURST; i++) {
+            if (fds[i] < 0 || read_setup(fds[i]) < 0)
+                failed++;
+            else
+                done++;
+            if (fds[i] >= 0)
+                close(fds[i]);
+        }
+    }
+    elapsed = now() - start;
+
+    printf("%d connections in %d bursts of %d in %.2fs: %.0f/s\n",
+           done, rounds, BURST, elapsed, done / elapsed);
+
+    if (failed) {
+        fprintf(stderr, "%d of %d connections failed\n", failed,
+                rounds * BURST);
+        return 1;
+    }
+    return 0;
+}
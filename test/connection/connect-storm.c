@@ -0,0 +1,144 @@
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ * Connection storm: many short-lived processes each open a connection,
+ * do one round trip and exit, the way scripted xdotool or xprop loops
+ * do.  Reports connection setup latency and connections per second.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <xcb/xcb.h>
+
+#define NUM_CONNECTIONS 1000
+#define PARALLEL 8
+
+static double
+now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int
+compare_double(const void *a, const void *b)
+{
+    double x = *(const double *) a, y = *(const double *) b;
+
+    return x < y ? -1 : x > y;
+}
+
+/* Connect, do a round trip, report how long it took */
+static void
+short_lived_client(int result)
+{
+    double start = now(), elapsed;
+    xcb_connection_t *c = xcb_connect(NULL, NULL);
+    xcb_get_input_focus_reply_t *reply;
+
+    if (!c || xcb_connection_has_error(c))
+        _exit(1);
+
+    reply = xcb_get_input_focus_reply(c, xcb_get_input_focus(c), NULL);
+    if (!reply)
+        _exit(1);
+    free(reply);
+
+    elapsed = now() - start;
+    xcb_disconnect(c);
+    if (write(result, &elapsed, sizeof(elapsed)) != sizeof(elapsed))
+        _exit(1);
+    _exit(0);
+}
+
+int main(int argc, char **argv)
+{
+    int count = argc > 1 ? atoi(argv[1]) : NUM_CONNECTIONS;
+    int result[2];
+    double *latency, start, elapsed;
+    int started = 0, running = 0, done = 0, failed = 0;
+
+    if (count <= 0)
+        count = NUM_CONNECTIONS;
+
+    latency = calloc(count, sizeof(double));
+    if (!latency || pipe(result) < 0) {
+        fprintf(stderr, "setup failed\n");
+        return 1;
+    }
+
+    start = now();
+    while (done + failed < count) {
+        int status;
+
+        while (running < PARALLEL && started < count) {
+            pid_t pid = fork();
+
+            if (pid < 0) {
+                perror("fork");
+                return 1;
+            }
+            if (pid == 0) {
+                close(result[0]);
+                short_lived_client(result[1]);
+            }
+            started++;
+            running++;
+        }
+
+        if (wait(&status) < 0) {
+            perror("wait");
+            return 1;
+        }
+        running--;
+        if (!WIFEXITED(status) || WEXITSTATUS(status)) {
+            failed++;
+            continue;
+        }
+        if (read(result[0], &latency[done], sizeof(double)) != sizeof(double)) {
+            failed++;
+            continue;
+        }
+        done++;
+    }
+    elapsed = now() - start;
+
+    if (done) {
+        qsort(latency, done, sizeof(double), compare_double);
+        printf("%d connections in %.2fs: %.0f/s, setup median %.2fms "
+               "p99 %.2fms max %.2fms\n", done, elapsed, done / elapsed,
+               latency[done / 2] * 1000, latency[done * 99 / 100] * 1000,
+               latency[done - 1] * 1000);
+    }
+    free(latency);
+
+    if (failed) {
+        fprintf(stderr, "%d of %d connections failed\n", failed, count);
+        return 1;
+    }
+    return 0;
+}
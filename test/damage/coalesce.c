@@ -0,0 +1,141 @@
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ * With -damagecoalesce, the damage of many small drawing requests handled
+ * in one dispatch cycle must arrive as a few DamageNotify events that
+ * still cover every pixel drawn.  Runs with a cap of MAX_RECTS.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <xcb/xcb.h>
+#include <xcb/damage.h>
+
+#define NUM_FILLS 32
+#define MAX_RECTS 8
+#define SIZE 64
+
+static void
+round_trip(xcb_connection_t *c)
+{
+    free(xcb_get_input_focus_reply(c, xcb_get_input_focus(c), NULL));
+}
+
+int
+main(void)
+{
+    xcb_connection_t *c;
+    const xcb_query_extension_reply_t *ext;
+    xcb_screen_t *screen;
+    xcb_generic_event_t *ev;
+    xcb_pixmap_t pixmap;
+    xcb_gc_t gc;
+    xcb_damage_damage_t raw, bbox;
+    unsigned char covered[SIZE][SIZE];
+    int raw_events = 0, bbox_events = 0;
+    xcb_rectangle_t bbox_area = { 0 };
+    int i, x, y;
+
+    c = xcb_connect(NULL, NULL);
+    if (!c || xcb_connection_has_error(c)) {
+        fprintf(stderr, "cannot connect\n");
+        return 1;
+    }
+
+    ext = xcb_get_extension_data(c, &xcb_damage_id);
+    if (!ext || !ext->present) {
+        fprintf(stderr, "DAMAGE not present, skipping\n");
+        return 77;
+    }
+    free(xcb_damage_query_version_reply(c, xcb_damage_query_version(c, 1, 1),
+                                        NULL));
+
+    screen = xcb_setup_roots_iterator(xcb_get_setup(c)).data;
+    pixmap = xcb_generate_id(c);
+    xcb_create_pixmap(c, screen->root_depth, pixmap, screen->root,
+                      SIZE, SIZE);
+    gc = xcb_generate_id(c);
+    xcb_create_gc(c, gc, pixmap, 0, NULL);
+
+    raw = xcb_generate_id(c);
+    xcb_damage_create(c, raw, pixmap, XCB_DAMAGE_REPORT_LEVEL_RAW_RECTANGLES);
+    bbox = xcb_generate_id(c);
+    xcb_damage_create(c, bbox, pixmap, XCB_DAMAGE_REPORT_LEVEL_BOUNDING_BOX);
+    round_trip(c);
+
+    /* one request per pixel, none of them touching */
+    for (i = 0; i < NUM_FILLS; i++) {
+        xcb_rectangle_t rect = { 4 + 7 * (i % 8), 4 + 9 * (i / 8), 1, 1 };
+
+        xcb_poly_fill_rectangle(c, pixmap, gc, 1, &rect);
+    }
+    /* the events are sent before the server next waits for input, the
+     * second round trip makes sure that happened */
+    round_trip(c);
+    round_trip(c);
+
+    memset(covered, 0, sizeof(covered));
+    while ((ev = xcb_poll_for_event(c))) {
+        xcb_damage_notify_event_t *notify = (xcb_damage_notify_event_t *) ev;
+
+        if ((ev->response_type & 0x7f) != ext->first_event) {
+            fprintf(stderr, "unexpected event %d\n", ev->response_type);
+            return 1;
+        }
+        if (notify->damage == raw) {
+            raw_events++;
+            for (y = notify->area.y; y < notify->area.y + notify->area.height; y++)
+                for (x = notify->area.x; x < notify->area.x + notify->area.width; x++)
+                    covered[y][x] = 1;
+        }
+        else if (notify->damage == bbox) {
+            bbox_events++;
+            bbox_area = notify->area;
+        }
+        free(ev);
+    }
+
+    printf("%d fills: %d raw rectangle events, %d bounding box events\n",
+           NUM_FILLS, raw_events, bbox_events);
+
+    if (raw_events < 1 || raw_events > MAX_RECTS) {
+        fprintf(stderr, "expected 1 to %d raw rectangle events\n", MAX_RECTS);
+        return 1;
+    }
+    for (i = 0; i < NUM_FILLS; i++) {
+        if (!covered[4 + 9 * (i / 8)][4 + 7 * (i % 8)]) {
+            fprintf(stderr, "fill %d not reported\n", i);
+            return 1;
+        }
+    }
+
+    if (bbox_events != 1 ||
+        bbox_area.x != 4 || bbox_area.y != 4 ||
+        bbox_area.width != 7 * 7 + 1 || bbox_area.height != 3 * 9 + 1) {
+        fprintf(stderr, "expected one bounding box event covering all fills\n");
+        return 1;
+    }
+
+    xcb_disconnect(c);
+    return 0;
+}
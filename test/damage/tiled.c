@@ -0,0 +1,123 @@
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ * CPU cost of accumulating damage per rectangle into an exact region
+ * versus DamageReportTiled.  A terminal-style workload reports glyph
+ * sized boxes scattered over a large pixmap, and a consumer picks up
+ * the damage region every few frames.  Reports the CPU time and the
+ * number of rectangles handed to the consumer for both levels.
+ */
+
+#ifdef HAVE_DIX_CONFIG_H
+#include <dix-config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "misc.h"
+#include "scrnintstr.h"
+#include "pixmapstr.h"
+#include "damagestr.h"
+
+#define FRAMES 2000
+#define COLS 240
+#define ROWS 67
+#define GLYPH_W 8
+#define GLYPH_H 16
+#define PICKUP_FRAMES 4
+
+static double
+cpu_time(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void
+run(DamageReportLevel level, const char *name)
+{
+    DamageRec damage;
+    PixmapRec pixmap;
+    unsigned long boxes = 0, rects = 0;
+    double start, elapsed;
+    int frame, row, col;
+
+    memset(&pixmap, 0, sizeof(pixmap));
+    pixmap.drawable.type = DRAWABLE_PIXMAP;
+    pixmap.drawable.width = COLS * GLYPH_W;
+    pixmap.drawable.height = ROWS * GLYPH_H;
+
+    memset(&damage, 0, sizeof(damage));
+    RegionNull(&damage.damage);
+    RegionNull(&damage.pendingDamage);
+    damage.damageLevel = level;
+    damage.pDrawable = &pixmap.drawable;
+
+    start = cpu_time();
+    for (frame = 0; frame < FRAMES; frame++) {
+        for (row = 0; row < ROWS; row++) {
+            for (col = 0; col < COLS; col++) {
+                BoxRec box;
+                RegionRec glyph;
+
+                if ((col * 7 + row * 13 + frame) % 5)
+                    continue;
+
+                box.x1 = col * GLYPH_W;
+                box.y1 = row * GLYPH_H;
+                box.x2 = box.x1 + GLYPH_W;
+                box.y2 = box.y1 + GLYPH_H;
+                RegionInit(&glyph, &box, 1);
+                DamageReportDamage(&damage, &glyph);
+                RegionUninit(&glyph);
+                boxes++;
+            }
+        }
+
+        if (frame % PICKUP_FRAMES == PICKUP_FRAMES - 1) {
+            rects += RegionNumRects(DamageRegion(&damage));
+            DamageEmpty(&damage);
+        }
+    }
+    elapsed = cpu_time() - start;
+
+    printf("%-6s %lu boxes in %.3f s CPU (%.1f ns/box), "
+           "%lu rectangles picked up\n",
+           name, boxes, elapsed, elapsed * 1e9 / boxes, rects);
+
+    free(damage.tiles);
+    RegionUninit(&damage.damage);
+    RegionUninit(&damage.pendingDamage);
+}
+
+int
+main(int argc, char **argv)
+{
+    run(DamageReportNone, "exact");
+    run(DamageReportTiled, "tiled");
+
+    return 0;
+}
@@ -344,6 +344,157 @@ fixes_pointer_barrier_clamp_test(void)
     assert(cy == barrier.y1);
 }
 
+/* nearest blocking barrier the way a linear scan of all barriers finds it */
+static double
+fixes_nearest_barrier_linear(struct PointerBarrier *barriers, int nbarriers,
+                             int x1, int y1, int x2, int y2)
+{
+    double min_distance = INT_MAX;
+    int dir = barrier_get_direction(x1, y1, x2, y2);
+    int i;
+
+    for (i = 0; i < nbarriers; i++) {
+        double distance;
+
+        if (!barrier_is_blocking_direction(&barriers[i], dir))
+            continue;
+        if (barrier_is_blocking(&barriers[i], x1, y1, x2, y2, &distance) &&
+            distance < min_distance)
+            min_distance = distance;
+    }
+
+    return min_distance;
+}
+
+/* barrier filter skipping every barrier with directions set */
+static BOOL
+fixes_barrier_no_directions(struct PointerBarrier *barrier, void *closure)
+{
+    int *calls = closure;
+
+    (*calls)++;
+    return barrier->directions == 0;
+}
+
+/**
+ * Look up movements against 1000 barriers through the barrier index and
+ * compare the result with a linear scan over all barriers.
+ */
+static void
+fixes_pointer_barrier_index_test(void)
+{
+    const int nbarriers = 1000;
+    const int nmotions = 100000;
+    struct PointerBarrier *barriers;
+    struct PointerBarrierIndex vertical = { 0 }, horizontal = { 0 };
+    struct PointerBarrier *nearest;
+    int i, calls;
+
+    barriers = calloc(nbarriers, sizeof(*barriers));
+    assert(barriers);
+
+    srand(0);
+    for (i = 0; i < nbarriers; i++) {
+        struct PointerBarrier *b = &barriers[i];
+        int pos = rand() % 4096;
+        int from = rand() % 4096;
+        int to = from + 1 + rand() % 256;
+
+        b->directions = (i % 3 == 0) ? BarrierPositiveX | BarrierPositiveY : 0;
+
+        if (i % 2) {
+            b->x1 = b->x2 = pos;
+            b->y1 = from;
+            b->y2 = to;
+            assert(barrier_index_insert(&vertical, b));
+        }
+        else {
+            b->y1 = b->y2 = pos;
+            b->x1 = from;
+            b->x2 = to;
+            assert(barrier_index_insert(&horizontal, b));
+        }
+    }
+
+    assert(vertical.num + horizontal.num == nbarriers);
+    for (i = 1; i < vertical.num; i++)
+        assert(barrier_index_position(vertical.barriers[i - 1]) <=
+               barrier_index_position(vertical.barriers[i]));
+    for (i = 1; i < horizontal.num; i++)
+        assert(barrier_index_position(horizontal.barriers[i - 1]) <=
+               barrier_index_position(horizontal.barriers[i]));
+
+    for (i = 0; i < nmotions; i++) {
+        int x1 = rand() % 4096, y1 = rand() % 4096;
+        int x2 = x1 + rand() % 64 - 32, y2 = y1 + rand() % 64 - 32;
+        int dir = barrier_get_direction(x1, y1, x2, y2);
+        double linear, distance;
+
+        linear = fixes_nearest_barrier_linear(barriers, nbarriers,
+                                              x1, y1, x2, y2);
+        nearest = barrier_find_nearest(&vertical, &horizontal, dir,
+                                       x1, y1, x2, y2, NULL, NULL);
+
+        /* several barriers may be at the same distance, so compare that */
+        if (linear == INT_MAX)
+            assert(nearest == NULL);
+        else {
+            assert(nearest);
+            assert(barrier_is_blocking(nearest, x1, y1, x2, y2, &distance));
+            assert(distance == linear);
+        }
+    }
+
+    /* the filter only sees blocking barriers in range and can veto them */
+    barrier_index_remove(&vertical, &barriers[1]);
+    barrier_index_remove(&vertical, &barriers[3]);
+    barriers[1].x1 = barriers[1].x2 = 5000;
+    barriers[1].y1 = 5000;
+    barriers[1].y2 = 5100;
+    barriers[1].directions = 0;
+    barriers[3].x1 = barriers[3].x2 = 5010;
+    barriers[3].y1 = 5000;
+    barriers[3].y2 = 5100;
+    barriers[3].directions = BarrierPositiveX;
+    assert(barrier_index_insert(&vertical, &barriers[1]));
+    assert(barrier_index_insert(&vertical, &barriers[3]));
+
+    nearest = barrier_find_nearest(&vertical, &horizontal, BarrierPositiveX,
+                                   4990, 5050, 5020, 5050, NULL, NULL);
+    assert(nearest == &barriers[1]);
+    calls = 0;
+    nearest = barrier_find_nearest(&vertical, &horizontal, BarrierPositiveX,
+                                   4990, 5050, 5020, 5050,
+                                   fixes_barrier_no_directions, &calls);
+    assert(nearest == &barriers[1]);
+    assert(calls == 1);
+    /* barriers[3] only lets positive x motion through */
+    nearest = barrier_find_nearest(&vertical, &horizontal, BarrierNegativeX,
+                                   5020, 5050, 4990, 5050, NULL, NULL);
+    assert(nearest == &barriers[3]);
+    calls = 0;
+    nearest = barrier_find_nearest(&vertical, &horizontal, BarrierNegativeX,
+                                   5020, 5050, 4990, 5050,
+                                   fixes_barrier_no_directions, &calls);
+    assert(nearest == &barriers[1]);
+    assert(calls == 2);
+
+    /* removing keeps the others in order */
+    for (i = 0; i < nbarriers; i += 2)
+        barrier_index_remove(&horizontal, &barriers[i]);
+    assert(horizontal.num == 0);
+    for (i = 1; i < nbarriers; i += 4)
+        barrier_index_remove(&vertical, &barriers[i]);
+    assert(vertical.num == nbarriers / 4);
+    for (i = 1; i < vertical.num; i++)
+        assert(barrier_index_position(vertical.barriers[i - 1]) <=
+               barrier_index_position(vertical.barriers[i]));
+
+    free(vertical.barriers);
+    free(horizontal.barriers);
+    free(barriers);
+}
+
 int
 fixes_test(void)
 {
@@ -351,6 +502,7 @@ fixes_test(void)
     fixes_pointer_barriers_test();
     fixes_pointer_barrier_direction_test();
     fixes_pointer_barrier_clamp_test();
+    fixes_pointer_barrier_index_test();
 
     return 0;
 }
@@ -40,7 +40,9 @@
 #include "dixgrabs.h"
 #include "eventstr.h"
 #include "inpututils.h"
+#include "ptrveloc.h"
 #include "mi.h"
+#include "opaque.h"
 #include "assert.h"
 
 #include "tests-common.h"
@@ -1759,6 +1761,85 @@ dix_double_fp_conversion(void)
     }
 }
 
+/**
+ * Feed linear motion into the velocity trackers and make sure the estimate
+ * is unaffected by the accumulated motion being rebased.
+ */
+static void
+dix_velocity_trackers(void)
+{
+    DeviceVelocityRec vel;
+    int i, t = 0;
+
+    InitVelocityData(&vel);
+
+    /* 5 units every 10ms is 5 units per 10ms with the default corr_mul */
+    for (i = 0; i < 20; i++) {
+        t += 10;
+        ProcessVelocityData2D(&vel, 5, 0, t);
+    }
+    assert(fabs(vel.velocity - 5.0) < 1e-6);
+
+    /* push the accumulated motion past the rebase limit */
+    for (i = 0; i < 40; i++) {
+        t += 10;
+        ProcessVelocityData2D(&vel, 1 << 16, 1 << 16, t);
+    }
+    assert(fabs(vel.motion_x) <= (1 << 20));
+    assert(fabs(vel.motion_y) <= (1 << 20));
+
+    for (i = 0; i < 20; i++) {
+        t += 10;
+        ProcessVelocityData2D(&vel, 0, -5, t);
+    }
+    assert(fabs(vel.velocity - 5.0) < 1e-6);
+
+    FreeVelocityData(&vel);
+}
+
+/**
+ * Trackers started before a change of direction must no longer contribute
+ * to the estimate, neither must trackers older than an idle period.
+ */
+static void
+dix_velocity_direction(void)
+{
+    DeviceVelocityRec vel;
+    int i, t = 0;
+
+    InitVelocityData(&vel);
+
+    for (i = 0; i < 20; i++) {
+        t += 10;
+        ProcessVelocityData2D(&vel, 5, 0, t);
+    }
+    assert(fabs(vel.velocity - 5.0) < 1e-6);
+
+    /* reversing leaves only the trackers of the new direction */
+    for (i = 0; i < 2; i++) {
+        t += 10;
+        ProcessVelocityData2D(&vel, -2, 0, t);
+    }
+    assert(fabs(vel.velocity - 2.0) < 1e-6);
+
+    /* diagonal motion of 3/4 is 5 units per event */
+    for (i = 0; i < 2; i++) {
+        t += 10;
+        ProcessVelocityData2D(&vel, 3, 4, t);
+    }
+    assert(fabs(vel.velocity - 5.0) < 1e-6);
+
+    /* after an idle second the old trackers are too old to be used */
+    t += 1000;
+    ProcessVelocityData2D(&vel, 3, 4, t);
+    assert(vel.velocity == 0.0);
+    t += 10;
+    ProcessVelocityData2D(&vel, 3, 4, t);
+    assert(fabs(vel.velocity - 5.0) < 1e-6);
+
+    FreeVelocityData(&vel);
+}
+
 /* The mieq test verifies that events added to the queue come out in the same
  * order that they went in.
  */
@@ -1842,6 +1923,120 @@ mieq_test(void)
     mieqFini();
 }
 
+/* Motion compression test: a run of motion events from one device must
+ * collapse into the last one while every raw event is still delivered. */
+static int mieq_compress_nmotion;
+static int mieq_compress_nraw;
+static InternalEvent mieq_compress_last;
+
+static void
+mieq_compress_process_input_proc(InternalEvent *ev, DeviceIntPtr device)
+{
+    if (ev->any.type == ET_RawMotion)
+        mieq_compress_nraw++;
+    else if (ev->any.type == ET_Motion) {
+        mieq_compress_nmotion++;
+        mieq_compress_last = *ev;
+    }
+}
+
+static void
+mieq_compress_enqueue(DeviceIntPtr dev, int type, int axis, double value)
+{
+    InternalEvent ev;
+
+    memset(&ev, 0, sizeof(ev));
+    ev.any.header = ET_Internal;
+    ev.any.type = type;
+    ev.any.time = GetTimeInMillis();
+
+    if (type == ET_RawMotion) {
+        ev.any.length = sizeof(RawDeviceEvent);
+        SetBit(ev.raw_event.valuators.mask, axis);
+        ev.raw_event.valuators.data[axis] = value;
+    }
+    else {
+        ev.any.length = sizeof(DeviceEvent);
+        SetBit(ev.device_event.valuators.mask, axis);
+        SetBit(ev.device_event.valuators.mode, axis);
+        ev.device_event.valuators.data[axis] = value;
+    }
+
+    mieqEnqueue(dev, &ev);
+}
+
+static void
+mieq_motion_compression_test(void)
+{
+    DeviceIntRec dev, other;
+    SpriteInfoRec spriteInfo;
+    SpriteRec sprite;
+    unsigned long compressed;
+    int i;
+
+    memset(&dev, 0, sizeof(dev));
+    memset(&spriteInfo, 0, sizeof(spriteInfo));
+    memset(&sprite, 0, sizeof(sprite));
+    dev.id = 2;
+    dev.type = SLAVE;
+    dev.enabled = TRUE;
+    dev.spriteInfo = &spriteInfo;
+    spriteInfo.sprite = &sprite;
+    dev.public.processInputProc = mieq_compress_process_input_proc;
+    other = dev;
+    other.id = 3;
+
+    mieqInit();
+    compressed = mieqGetCompressedMotionCount();
+
+    /* disabled: every motion event is processed */
+    CompressMotionEvents = FALSE;
+    mieq_compress_nmotion = mieq_compress_nraw = 0;
+    for (i = 0; i < 10; i++) {
+        mieq_compress_enqueue(&dev, ET_RawMotion, 0, i);
+        mieq_compress_enqueue(&dev, ET_Motion, 0, i);
+    }
+    mieqProcessInputEvents();
+    assert(mieq_compress_nraw == 10);
+    assert(mieq_compress_nmotion == 10);
+    assert(mieqGetCompressedMotionCount() == compressed);
+
+    /* enabled: only the last motion event is left, raw events stay */
+    CompressMotionEvents = TRUE;
+    mieq_compress_nmotion = mieq_compress_nraw = 0;
+    mieq_compress_enqueue(&dev, ET_RawMotion, 2, 0);
+    mieq_compress_enqueue(&dev, ET_Motion, 2, 50);
+    for (i = 0; i < 10; i++) {
+        mieq_compress_enqueue(&dev, ET_RawMotion, 0, i);
+        mieq_compress_enqueue(&dev, ET_Motion, 0, i);
+    }
+    mieqProcessInputEvents();
+    assert(mieq_compress_nraw == 11);
+    assert(mieq_compress_nmotion == 1);
+    assert(mieqGetCompressedMotionCount() == compressed + 10);
+    /* valuators of the dropped events are carried over */
+    assert(BitIsOn(mieq_compress_last.device_event.valuators.mask, 0));
+    assert(BitIsOn(mieq_compress_last.device_event.valuators.mask, 2));
+    assert(mieq_compress_last.device_event.valuators.data[0] == 9);
+    assert(mieq_compress_last.device_event.valuators.data[2] == 50);
+
+    /* events from another device are a state change */
+    compressed = mieqGetCompressedMotionCount();
+    mieq_compress_nmotion = mieq_compress_nraw = 0;
+    mieq_compress_enqueue(&dev, ET_RawMotion, 0, 1);
+    mieq_compress_enqueue(&dev, ET_Motion, 0, 1);
+    mieq_compress_enqueue(&other, ET_RawMotion, 0, 1);
+    mieq_compress_enqueue(&dev, ET_RawMotion, 0, 2);
+    mieq_compress_enqueue(&dev, ET_Motion, 0, 2);
+    mieqProcessInputEvents();
+    assert(mieq_compress_nraw == 3);
+    assert(mieq_compress_nmotion == 2);
+    assert(mieqGetCompressedMotionCount() == compressed);
+
+    CompressMotionEvents = FALSE;
+    mieqFini();
+}
+
 /* Simple check that we're replaying events in-order */
 static void
 process_input_proc(InternalEvent *ev, DeviceIntPtr device)
@@ -1928,6 +2123,9 @@ input_test(void)
     dix_get_master();
     input_option_test();
     mieq_test();
+    mieq_motion_compression_test();
+    dix_velocity_trackers();
+    dix_velocity_direction();
 
     return 0;
 }
@@ -0,0 +1,154 @@
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ * Key event throughput: inject key presses and releases with XTest and
+ * report how many the server processes per second.  Plain keys take the
+ * path for keys without actions; the second run holds Shift, so every
+ * key also passes through the active SetMods filter, and the third
+ * presses Shift itself each time, starting a new filter per key.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <xcb/xcb.h>
+#include <xcb/xtest.h>
+
+#define NUM_KEYS 100000
+#define BATCH 250
+
+#define XK_a            0x0061
+#define XK_Shift_L      0xffe1
+
+static double
+now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* First keycode producing keysym in any column, or 0 */
+static xcb_keycode_t
+find_keycode(xcb_connection_t *c, xcb_keysym_t keysym)
+{
+    const xcb_setup_t *setup = xcb_get_setup(c);
+    xcb_get_keyboard_mapping_reply_t *map;
+    xcb_keysym_t *syms;
+    xcb_keycode_t key = 0;
+    int i, n;
+
+    map = xcb_get_keyboard_mapping_reply(c,
+        xcb_get_keyboard_mapping(c, setup->min_keycode,
+                                 setup->max_keycode - setup->min_keycode + 1),
+        NULL);
+    if (!map)
+        return 0;
+    syms = xcb_get_keyboard_mapping_keysyms(map);
+    n = xcb_get_keyboard_mapping_keysyms_length(map);
+    for (i = 0; i < n; i++) {
+        if (syms[i] == keysym) {
+            key = setup->min_keycode + i / map->keysyms_per_keycode;
+            break;
+        }
+    }
+    free(map);
+    return key;
+}
+
+static void
+fake_key(xcb_connection_t *c, uint8_t type, xcb_keycode_t key)
+{
+    xcb_test_fake_input(c, type, key, XCB_CURRENT_TIME, XCB_NONE, 0, 0, 0);
+}
+
+static int
+run(xcb_connection_t *c, xcb_keycode_t key, xcb_keycode_t hold,
+    xcb_keycode_t each, const char *name)
+{
+    double start, elapsed;
+    int i, j;
+
+    if (hold)
+        fake_key(c, XCB_KEY_PRESS, hold);
+
+    start = now();
+    for (i = 0; i < NUM_KEYS / BATCH; i++) {
+        for (j = 0; j < BATCH; j++) {
+            if (each)
+                fake_key(c, XCB_KEY_PRESS, each);
+            fake_key(c, XCB_KEY_PRESS, key);
+            fake_key(c, XCB_KEY_RELEASE, key);
+            if (each)
+                fake_key(c, XCB_KEY_RELEASE, each);
+        }
+        /* The server has processed the batch once this returns */
+        free(xcb_get_input_focus_reply(c, xcb_get_input_focus(c), NULL));
+    }
+    elapsed = now() - start;
+
+    if (hold)
+        fake_key(c, XCB_KEY_RELEASE, hold);
+
+    if (xcb_connection_has_error(c)) {
+        fprintf(stderr, "%s: connection error\n", name);
+        return 1;
+    }
+    printf("%s: %.0f key presses/s\n", name, NUM_KEYS / elapsed);
+    return 0;
+}
+
+int
+main(void)
+{
+    xcb_connection_t *c;
+    const xcb_query_extension_reply_t *ext;
+    xcb_keycode_t key, shift;
+
+    c = xcb_connect(NULL, NULL);
+    if (!c || xcb_connection_has_error(c)) {
+        fprintf(stderr, "Failed to connect to X server\n");
+        return 1;
+    }
+
+    ext = xcb_get_extension_data(c, &xcb_test_id);
+    if (!ext || !ext->present) {
+        fprintf(stderr, "XTEST not present, skipping\n");
+        return 77;
+    }
+    key = find_keycode(c, XK_a);
+    shift = find_keycode(c, XK_Shift_L);
+    if (!key || !shift) {
+        fprintf(stderr, "no keycode for a or Shift_L, skipping\n");
+        return 77;
+    }
+
+    /* Nobody selects key events, so this is input processing only */
+    if (run(c, key, 0, 0, "plain keys") ||
+        run(c, key, shift, 0, "with Shift held") ||
+        run(c, key, 0, shift, "with Shift pressed each time"))
+        return 1;
+
+    xcb_disconnect(c);
+    return 0;
+}
@@ -0,0 +1,132 @@
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ * Pointer event throughput: inject relative and absolute motion with
+ * XTest, which the server turns into events with GetPointerEvents(), and
+ * report how many it processes per second.  The same events are then
+ * delivered to a window selecting motion, which adds the cost of event
+ * delivery.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <xcb/xcb.h>
+#include <xcb/xtest.h>
+
+#define NUM_EVENTS 200000
+#define BATCH 500
+
+static double
+now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Discard whatever events were delivered so far */
+static void
+drain_events(xcb_connection_t *c)
+{
+    xcb_generic_event_t *ev;
+
+    while ((ev = xcb_poll_for_event(c)))
+        free(ev);
+}
+
+static int
+run(xcb_connection_t *c, xcb_screen_t *screen, int relative,
+    const char *name)
+{
+    double start, elapsed;
+    int i, j;
+
+    start = now();
+    for (i = 0; i < NUM_EVENTS / BATCH; i++) {
+        for (j = 0; j < BATCH; j++) {
+            if (relative)
+                xcb_test_fake_input(c, XCB_MOTION_NOTIFY, 1, XCB_CURRENT_TIME,
+                                    XCB_NONE, (j & 1) ? 3 : -3,
+                                    (j & 2) ? 2 : -2, 0);
+            else
+                xcb_test_fake_input(c, XCB_MOTION_NOTIFY, 0, XCB_CURRENT_TIME,
+                                    screen->root,
+                                    j % screen->width_in_pixels,
+                                    (j * 7) % screen->height_in_pixels, 0);
+        }
+        /* The server has processed the batch once this returns */
+        free(xcb_get_input_focus_reply(c, xcb_get_input_focus(c), NULL));
+        drain_events(c);
+    }
+    elapsed = now() - start;
+
+    if (xcb_connection_has_error(c)) {
+        fprintf(stderr, "%s: connection error\n", name);
+        return 1;
+    }
+    printf("%s: %.0f events/s\n", name, NUM_EVENTS / elapsed);
+    return 0;
+}
+
+int
+main(void)
+{
+    xcb_connection_t *c;
+    xcb_screen_t *screen;
+    xcb_window_t window;
+    const xcb_query_extension_reply_t *ext;
+    uint32_t mask = XCB_EVENT_MASK_POINTER_MOTION;
+
+    c = xcb_connect(NULL, NULL);
+    if (!c || xcb_connection_has_error(c)) {
+        fprintf(stderr, "Failed to connect to X server\n");
+        return 1;
+    }
+
+    ext = xcb_get_extension_data(c, &xcb_test_id);
+    if (!ext || !ext->present) {
+        fprintf(stderr, "XTEST not present, skipping\n");
+        return 77;
+    }
+    screen = xcb_setup_roots_iterator(xcb_get_setup(c)).data;
+
+    if (run(c, screen, 1, "relative motion") ||
+        run(c, screen, 0, "absolute motion"))
+        return 1;
+
+    /* A window covering the screen that takes all the motion */
+    window = xcb_generate_id(c);
+    xcb_create_window(c, XCB_COPY_FROM_PARENT, window, screen->root, 0, 0,
+                      screen->width_in_pixels, screen->height_in_pixels, 0,
+                      XCB_WINDOW_CLASS_INPUT_ONLY, XCB_COPY_FROM_PARENT,
+                      XCB_CW_EVENT_MASK, &mask);
+    xcb_map_window(c, window);
+
+    if (run(c, screen, 1, "relative motion, delivered") ||
+        run(c, screen, 0, "absolute motion, delivered"))
+        return 1;
+
+    xcb_disconnect(c);
+    return 0;
+}
@@ -30,6 +30,9 @@
 #include "scrnintstr.h"
 #include "dix.h"
 #include "dixstruct.h"
+#include "pixmapstr.h"
+#include "windowstr.h"
+#include "damagestr.h"
 
 #include "tests-common.h"
 
@@ -220,6 +223,180 @@ bswap_test(void)
     assert(result_64 == expect_64);
 }
 
+/**
+ * Accumulate glyph sized damage the way a terminal redrawing changed cells
+ * would, once with exact regions and once with DamageReportTiled. The tiled
+ * region must be exactly the tiles the exact region touches.
+ */
+static void
+miext_damage_tiled(void)
+{
+    const int frames = 200, cols = 160, rows = 60;
+    const int glyph_w = 8, glyph_h = 16;
+    DamageReportLevel levels[] = { DamageReportNone, DamageReportTiled };
+    DamageRec damage[ARRAY_SIZE(levels)];
+    PixmapRec pixmap;
+    RegionRec expected;
+    BoxPtr pBox;
+    int i, n, frame, col, row;
+
+    memset(&pixmap, 0, sizeof(pixmap));
+    pixmap.drawable.type = DRAWABLE_PIXMAP;
+    pixmap.drawable.width = cols * glyph_w;
+    pixmap.drawable.height = rows * glyph_h;
+
+    for (i = 0; i < ARRAY_SIZE(levels); i++) {
+        DamagePtr pDamage = &damage[i];
+
+        memset(pDamage, 0, sizeof(*pDamage));
+        RegionNull(&pDamage->damage);
+        RegionNull(&pDamage->pendingDamage);
+        pDamage->damageLevel = levels[i];
+        pDamage->pDrawable = &pixmap.drawable;
+
+        for (frame = 0; frame < frames; frame++) {
+            for (row = 0; row < rows; row++) {
+                for (col = 0; col < cols; col++) {
+                    BoxRec box;
+                    RegionRec glyph;
+
+                    if ((col * 7 + row * 13 + frame) % 5)
+                        continue;
+
+                    box.x1 = col * glyph_w;
+                    box.y1 = row * glyph_h;
+                    box.x2 = box.x1 + glyph_w;
+                    box.y2 = box.y1 + glyph_h;
+                    RegionInit(&glyph, &box, 1);
+                    DamageReportDamage(pDamage, &glyph);
+                    RegionUninit(&glyph);
+                }
+            }
+            /* a consumer picking up the damage every tenth frame */
+            if (frame % 10 == 9 && frame != frames - 1) {
+                assert(RegionNotEmpty(DamageRegion(pDamage)));
+                DamageEmpty(pDamage);
+            }
+        }
+    }
+
+    /* the exact damage rounded out to the tile grid */
+    RegionNull(&expected);
+    pBox = RegionRects(DamageRegion(&damage[0]));
+    n = RegionNumRects(DamageRegion(&damage[0]));
+    assert(n > 0);
+    for (i = 0; i < n; i++) {
+        BoxRec box;
+        RegionRec tiles;
+
+        box.x1 = pBox[i].x1 / DAMAGE_TILE_SIZE * DAMAGE_TILE_SIZE;
+        box.y1 = pBox[i].y1 / DAMAGE_TILE_SIZE * DAMAGE_TILE_SIZE;
+        box.x2 = min((pBox[i].x2 + DAMAGE_TILE_SIZE - 1) /
+                     DAMAGE_TILE_SIZE * DAMAGE_TILE_SIZE,
+                     pixmap.drawable.width);
+        box.y2 = min((pBox[i].y2 + DAMAGE_TILE_SIZE - 1) /
+                     DAMAGE_TILE_SIZE * DAMAGE_TILE_SIZE,
+                     pixmap.drawable.height);
+        RegionInit(&tiles, &box, 1);
+        RegionUnion(&expected, &expected, &tiles);
+        RegionUninit(&tiles);
+    }
+    assert(RegionEqual(&expected, DamageRegion(&damage[1])));
+    RegionUninit(&expected);
+
+    assert(RegionNumRects(DamageRegion(&damage[1])) <=
+           RegionNumRects(DamageRegion(&damage[0])));
+
+    /* subtracting a tile leaves the rest of the tiled damage alone */
+    {
+        BoxRec box = { 0, 0, DAMAGE_TILE_SIZE, DAMAGE_TILE_SIZE };
+        RegionRec tile;
+
+        RegionInit(&tile, &box, 1);
+        assert(DamageSubtract(&damage[1], &tile));
+        assert(RegionContainsRect(DamageRegion(&damage[1]), &box) == rgnOUT);
+        RegionUninit(&tile);
+    }
+
+    for (i = 0; i < ARRAY_SIZE(levels); i++) {
+        DamageEmpty(&damage[i]);
+        assert(!RegionNotEmpty(DamageRegion(&damage[i])));
+        free(damage[i].tiles);
+        RegionUninit(&damage[i].damage);
+        RegionUninit(&damage[i].pendingDamage);
+    }
+}
+
+/*
+ * Compositor-style drawing: many small IncludeInferiors primitives into a
+ * window with a fragmented border clip.  Clipping against the per-window
+ * cached region must give the same result as a fresh NotClippedByChildren().
+ */
+static void
+dix_not_clipped_by_children(void)
+{
+    const int prims = 1000, strips = 64;
+    WindowRec parent, win;
+    BoxRec box = { 0, 0, 1024, 768 };
+    RegionRec slow, fast, strip;
+    RegionPtr cached;
+    int i;
+
+    memset(&parent, 0, sizeof(parent));
+    memset(&win, 0, sizeof(win));
+    win.parent = &parent;
+    win.drawable.type = DRAWABLE_WINDOW;
+    win.drawable.serialNumber = 1;
+
+    RegionInit(&win.winSize, &box, 1);
+    RegionNull(&win.borderClip);
+    for (i = 0; i < strips; i++) {
+        BoxRec b = { (i * 37) % 960, i * 12, (i * 37) % 960 + 64, i * 12 + 10 };
+
+        RegionInit(&strip, &b, 1);
+        RegionUnion(&win.borderClip, &win.borderClip, &strip);
+        RegionUninit(&strip);
+    }
+
+    RegionNull(&slow);
+    RegionNull(&fast);
+
+    for (i = 0; i < prims; i++) {
+        BoxRec b = { (i * 13) % 1000, (i * 7) % 760, 0, 0 };
+        RegionPtr clip = NotClippedByChildren(&win);
+
+        b.x2 = b.x1 + 24;
+        b.y2 = b.y1 + 8;
+        RegionReset(&slow, &b);
+        RegionIntersect(&slow, &slow, clip);
+        RegionDestroy(clip);
+
+        RegionReset(&fast, &b);
+        RegionIntersect(&fast, &fast, GetNotClippedByChildren(&win));
+        assert(RegionEqual(&slow, &fast));
+    }
+
+    /* the cache follows the serial number ... */
+    cached = GetNotClippedByChildren(&win);
+    assert(cached == GetNotClippedByChildren(&win));
+    RegionEmpty(&win.borderClip);
+    assert(RegionNotEmpty(GetNotClippedByChildren(&win)));
+    win.drawable.serialNumber++;
+    assert(!RegionNotEmpty(GetNotClippedByChildren(&win)));
+
+    /* ... and explicit invalidation */
+    RegionCopy(&win.borderClip, &win.winSize);
+    InvalidateNotClippedByChildren(&win);
+    assert(RegionEqual(GetNotClippedByChildren(&win), &win.winSize));
+    assert(GetNotClippedByChildren(&win) == cached);
+
+    RegionDestroy(win.notClipped);
+    RegionUninit(&slow);
+    RegionUninit(&fast);
+    RegionUninit(&win.borderClip);
+    RegionUninit(&win.winSize);
+}
+
 int
 misc_test(void)
 {
@@ -227,6 +404,8 @@ misc_test(void)
     dix_update_desktop_dimensions();
     dix_request_size_checks();
     bswap_test();
+    miext_damage_tiled();
+    dix_not_clipped_by_children();
 
     return 0;
 }
@@ -0,0 +1,163 @@
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifdef HAVE_DIX_CONFIG_H
+#include <dix-config.h>
+#endif
+
+#include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include "misc.h"
+#include "os.h"
+#include "../os/ospoll.h"
+
+#include "tests-common.h"
+
+static void
+record_events(int fd, int xevents, void *data)
+{
+    int *seen = data;
+
+    *seen |= xevents;
+}
+
+static void
+drain(int fd)
+{
+    char buf[64];
+
+    while (read(fd, buf, sizeof(buf)) > 0)
+        ;
+}
+
+/* An edge-triggered fd that is muted and listened to again, the way
+ * clients are when they block and unblock, reports data that arrived
+ * or was left unread in between, and nothing once it has been read.
+ */
+static void
+ospoll_edge_mute_listen(void)
+{
+    struct ospoll *ospoll = ospoll_create();
+    struct ospoll_stats before, after;
+    int sv[2];
+    int seen = 0;
+
+    assert(ospoll);
+    assert(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == 0);
+    fcntl(sv[0], F_SETFL, O_NONBLOCK);
+
+    assert(ospoll_add(ospoll, sv[0], ospoll_trigger_edge,
+                      record_events, &seen));
+    ospoll_listen(ospoll, sv[0], X_NOTIFY_READ);
+
+    ospoll_wait(ospoll, 0);
+    assert(seen == 0);
+
+    assert(write(sv[1], "a", 1) == 1);
+    ospoll_wait(ospoll, 0);
+    assert(seen == X_NOTIFY_READ);
+
+    /* no edge to report while muted */
+    seen = 0;
+    ospoll_mute(ospoll, sv[0], X_NOTIFY_READ);
+    assert(write(sv[1], "b", 1) == 1);
+    ospoll_wait(ospoll, 0);
+    assert(seen == 0);
+
+    ospoll_listen(ospoll, sv[0], X_NOTIFY_READ);
+    ospoll_wait(ospoll, 0);
+    assert(seen == X_NOTIFY_READ);
+
+    /* unread data is reported again without anything new arriving */
+    seen = 0;
+    ospoll_get_stats(ospoll, &before);
+    ospoll_mute(ospoll, sv[0], X_NOTIFY_READ);
+    ospoll_listen(ospoll, sv[0], X_NOTIFY_READ);
+    ospoll_wait(ospoll, 0);
+    ospoll_get_stats(ospoll, &after);
+    assert(seen == X_NOTIFY_READ);
+#ifdef HAVE_EPOLL_CREATE1
+    assert(after.ctl == before.ctl);
+#endif
+
+    /* and not once it has all been read */
+    drain(sv[0]);
+    ospoll_reset_events(ospoll, sv[0]);
+    seen = 0;
+    ospoll_mute(ospoll, sv[0], X_NOTIFY_READ);
+    ospoll_listen(ospoll, sv[0], X_NOTIFY_READ);
+    ospoll_wait(ospoll, 0);
+    assert(seen == 0);
+
+    ospoll_remove(ospoll, sv[0]);
+    ospoll_destroy(ospoll);
+    close(sv[0]);
+    close(sv[1]);
+}
+
+/* A level-triggered fd keeps reporting until muted */
+static void
+ospoll_level_mute(void)
+{
+    struct ospoll *ospoll = ospoll_create();
+    int sv[2];
+    int seen = 0;
+
+    assert(ospoll);
+    assert(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == 0);
+
+    assert(ospoll_add(ospoll, sv[0], ospoll_trigger_level,
+                      record_events, &seen));
+    ospoll_listen(ospoll, sv[0], X_NOTIFY_READ);
+    assert(write(sv[1], "a", 1) == 1);
+
+    ospoll_wait(ospoll, 0);
+    assert(seen == X_NOTIFY_READ);
+    seen = 0;
+    ospoll_wait(ospoll, 0);
+    assert(seen == X_NOTIFY_READ);
+
+    seen = 0;
+    ospoll_mute(ospoll, sv[0], X_NOTIFY_READ);
+    ospoll_wait(ospoll, 0);
+    ospoll_wait(ospoll, 0);
+    assert(seen == 0);
+
+    ospoll_listen(ospoll, sv[0], X_NOTIFY_READ);
+    ospoll_wait(ospoll, 0);
+    assert(seen == X_NOTIFY_READ);
+
+    ospoll_remove(ospoll, sv[0]);
+    ospoll_destroy(ospoll);
+    close(sv[0]);
+    close(sv[1]);
+}
+
+int
+ospoll_test(void)
+{
+    ospoll_edge_mute_listen();
+    ospoll_level_mute();
+
+    return 0;
+}
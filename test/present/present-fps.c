@@ -0,0 +1,175 @@
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ * Present frame rate on Xvfb: a swrast-style client rotating through a
+ * few back buffers, presenting each one as soon as it is idle, to a
+ * plain window and to an automatically redirected one.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <xcb/xcb.h>
+#include <xcb/present.h>
+#include <xcb/composite.h>
+
+#define NUM_BUFFERS 3
+#define NUM_FRAMES 600
+#define WIDTH 1024
+#define HEIGHT 768
+
+static double
+now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int
+run(xcb_connection_t *c, xcb_screen_t *screen, int redirect)
+{
+    xcb_window_t parent = xcb_generate_id(c), window = xcb_generate_id(c);
+    xcb_pixmap_t buffers[NUM_BUFFERS];
+    int busy[NUM_BUFFERS] = { 0 };
+    uint32_t eid = xcb_generate_id(c);
+    xcb_special_event_t *special;
+    int frame = 0, completed = 0, outstanding = 0, modes[4] = { 0 };
+    double start, elapsed;
+    int i;
+
+    xcb_create_window(c, XCB_COPY_FROM_PARENT, parent, screen->root,
+                      0, 0, WIDTH, HEIGHT, 0, XCB_WINDOW_CLASS_INPUT_OUTPUT,
+                      screen->root_visual, 0, NULL);
+    if (redirect)
+        xcb_composite_redirect_subwindows(c, parent,
+                                          XCB_COMPOSITE_REDIRECT_AUTOMATIC);
+    xcb_create_window(c, XCB_COPY_FROM_PARENT, window, parent,
+                      0, 0, WIDTH, HEIGHT, 0, XCB_WINDOW_CLASS_INPUT_OUTPUT,
+                      screen->root_visual, 0, NULL);
+    xcb_map_window(c, window);
+    xcb_map_window(c, parent);
+
+    for (i = 0; i < NUM_BUFFERS; i++) {
+        buffers[i] = xcb_generate_id(c);
+        xcb_create_pixmap(c, screen->root_depth, buffers[i], window,
+                          WIDTH, HEIGHT);
+    }
+
+    special = xcb_register_for_special_xge(c, &xcb_present_id, eid, NULL);
+    xcb_present_select_input(c, eid, window,
+                             XCB_PRESENT_EVENT_MASK_COMPLETE_NOTIFY |
+                             XCB_PRESENT_EVENT_MASK_IDLE_NOTIFY);
+
+    start = now();
+    while (completed < NUM_FRAMES) {
+        xcb_generic_event_t *ev;
+
+        for (i = 0; i < NUM_BUFFERS && frame < NUM_FRAMES &&
+             outstanding < NUM_BUFFERS - 1; i++) {
+            if (busy[i])
+                continue;
+            busy[i] = 1;
+            outstanding++;
+            xcb_present_pixmap(c, window, buffers[i], frame, XCB_NONE,
+                               XCB_NONE, 0, 0, XCB_NONE, XCB_NONE, XCB_NONE,
+                               XCB_PRESENT_OPTION_NONE, 0, 0, 0, 0, NULL);
+            frame++;
+        }
+        xcb_flush(c);
+
+        ev = xcb_wait_for_special_event(c, special);
+        if (!ev) {
+            printf("Connection lost\n");
+            return 1;
+        }
+
+        switch (((xcb_present_generic_event_t *) ev)->evtype) {
+        case XCB_PRESENT_EVENT_COMPLETE_NOTIFY: {
+            xcb_present_complete_notify_event_t *ce = (void *) ev;
+
+            if (ce->kind == XCB_PRESENT_COMPLETE_KIND_PIXMAP) {
+                completed++;
+                outstanding--;
+                if (ce->mode < 4)
+                    modes[ce->mode]++;
+            }
+            break;
+        }
+        case XCB_PRESENT_EVENT_IDLE_NOTIFY: {
+            xcb_present_idle_notify_event_t *ie = (void *) ev;
+
+            for (i = 0; i < NUM_BUFFERS; i++)
+                if (buffers[i] == ie->pixmap)
+                    busy[i] = 0;
+            break;
+        }
+        }
+        free(ev);
+    }
+    elapsed = now() - start;
+
+    printf("%s window: %d frames in %.3f s, %.1f fps "
+           "(copy %d, flip %d, skip %d)\n",
+           redirect ? "redirected" : "plain", NUM_FRAMES, elapsed,
+           NUM_FRAMES / elapsed,
+           modes[XCB_PRESENT_COMPLETE_MODE_COPY],
+           modes[XCB_PRESENT_COMPLETE_MODE_FLIP],
+           modes[XCB_PRESENT_COMPLETE_MODE_SKIP]);
+
+    xcb_destroy_window(c, parent);
+    xcb_unregister_for_special_event(c, special);
+    for (i = 0; i < NUM_BUFFERS; i++)
+        xcb_free_pixmap(c, buffers[i]);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    xcb_connection_t *c = xcb_connect(NULL, NULL);
+    xcb_screen_t *screen = xcb_setup_roots_iterator(xcb_get_setup(c)).data;
+    const xcb_query_extension_reply_t *ext;
+
+    ext = xcb_get_extension_data(c, &xcb_present_id);
+    if (!ext->present) {
+        printf("No Present present\n");
+        exit(77);
+    }
+    ext = xcb_get_extension_data(c, &xcb_composite_id);
+    if (!ext->present) {
+        printf("No Composite present\n");
+        exit(77);
+    }
+
+    free(xcb_present_query_version_reply(c,
+            xcb_present_query_version(c, 1, 2), NULL));
+    free(xcb_composite_query_version_reply(c,
+            xcb_composite_query_version(c, 0, 4), NULL));
+
+    if (run(c, screen, 0) || run(c, screen, 1))
+        exit(1);
+
+    xcb_disconnect(c);
+    exit(0);
+}
@@ -0,0 +1,278 @@
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ * Contents of an automatically redirected window receiving presents.
+ * Full-window presents may exchange the presented pixmap with the
+ * window pixmap instead of copying; either way, GetImage on the window
+ * must return what was presented last, and every presented pixmap must
+ * eventually be reported idle.  A named window pixmap holds a reference
+ * to whatever pixmap the window uses, so while it exists the window has
+ * to keep that pixmap and later presents must show up in it as well.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <xcb/xcb.h>
+#include <xcb/present.h>
+#include <xcb/composite.h>
+
+#define NUM_PIXMAPS 3
+#define WIDTH 128
+#define HEIGHT 96
+
+static xcb_connection_t *c;
+static xcb_special_event_t *special;
+static xcb_window_t window;
+static xcb_pixmap_t pixmaps[NUM_PIXMAPS];
+static int idle[NUM_PIXMAPS];
+static int modes[4];
+
+/* Base color and a marker rectangle, different for every pattern */
+static uint32_t
+pattern_pixel(int pattern, int x, int y)
+{
+    if (x >= 10 + 20 * pattern && x < 30 + 20 * pattern &&
+        y >= 5 + 15 * pattern && y < 25 + 15 * pattern)
+        return 0xffffff;
+    return 0x400000 * (pattern + 1) + 0x50 * pattern;
+}
+
+static void
+fill_pattern(xcb_drawable_t drawable, xcb_gcontext_t gc, int pattern)
+{
+    xcb_rectangle_t all = { 0, 0, WIDTH, HEIGHT };
+    xcb_rectangle_t marker = { 10 + 20 * pattern, 5 + 15 * pattern, 20, 20 };
+    uint32_t pixel;
+
+    pixel = pattern_pixel(pattern, 0, 0);
+    xcb_change_gc(c, gc, XCB_GC_FOREGROUND, &pixel);
+    xcb_poly_fill_rectangle(c, drawable, gc, 1, &all);
+    pixel = 0xffffff;
+    xcb_change_gc(c, gc, XCB_GC_FOREGROUND, &pixel);
+    xcb_poly_fill_rectangle(c, drawable, gc, 1, &marker);
+}
+
+static void
+check(xcb_drawable_t drawable, const char *what, int pattern)
+{
+    xcb_get_image_reply_t *image;
+    uint32_t *data;
+    int x, y;
+
+    image = xcb_get_image_reply(c,
+            xcb_get_image(c, XCB_IMAGE_FORMAT_Z_PIXMAP, drawable,
+                          0, 0, WIDTH, HEIGHT, ~0), NULL);
+    if (!image) {
+        printf("GetImage of the %s failed\n", what);
+        exit(1);
+    }
+
+    data = (uint32_t *) xcb_get_image_data(image);
+    for (y = 0; y < HEIGHT; y++) {
+        for (x = 0; x < WIDTH; x++) {
+            uint32_t got = data[y * WIDTH + x] & 0xffffff;
+
+            if (got != pattern_pixel(pattern, x, y)) {
+                printf("%s pixel %d,%d: got 0x%06x, expected pattern %d\n",
+                       what, x, y, got, pattern);
+                exit(1);
+            }
+        }
+    }
+    free(image);
+}
+
+static void
+handle_event(xcb_generic_event_t *ev, uint32_t serial, int *completed)
+{
+    int i;
+
+    switch (((xcb_present_generic_event_t *) ev)->evtype) {
+    case XCB_PRESENT_EVENT_COMPLETE_NOTIFY: {
+        xcb_present_complete_notify_event_t *ce = (void *) ev;
+
+        if (ce->kind == XCB_PRESENT_COMPLETE_KIND_PIXMAP &&
+            ce->serial == serial) {
+            if (ce->mode < 4)
+                modes[ce->mode]++;
+            *completed = 1;
+        }
+        break;
+    }
+    case XCB_PRESENT_EVENT_IDLE_NOTIFY: {
+        xcb_present_idle_notify_event_t *ie = (void *) ev;
+
+        for (i = 0; i < NUM_PIXMAPS; i++)
+            if (pixmaps[i] == ie->pixmap)
+                idle[i] = 1;
+        break;
+    }
+    }
+    free(ev);
+}
+
+static void
+present(int i, uint32_t serial)
+{
+    int completed = 0;
+
+    if (!idle[i]) {
+        printf("Pixmap %d presented while busy\n", i);
+        exit(1);
+    }
+    idle[i] = 0;
+
+    xcb_present_pixmap(c, window, pixmaps[i], serial, XCB_NONE,
+                       XCB_NONE, 0, 0, XCB_NONE, XCB_NONE, XCB_NONE,
+                       XCB_PRESENT_OPTION_NONE, 0, 0, 0, 0, NULL);
+    xcb_flush(c);
+
+    while (!completed) {
+        xcb_generic_event_t *ev = xcb_wait_for_special_event(c, special);
+
+        if (!ev) {
+            printf("Connection lost\n");
+            exit(1);
+        }
+        handle_event(ev, serial, &completed);
+    }
+}
+
+static void
+wait_for_idle(int i)
+{
+    int completed;
+
+    while (!idle[i]) {
+        xcb_generic_event_t *ev = xcb_wait_for_special_event(c, special);
+
+        if (!ev) {
+            printf("Connection lost\n");
+            exit(1);
+        }
+        handle_event(ev, 0, &completed);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    xcb_screen_t *screen;
+    const xcb_query_extension_reply_t *ext;
+    xcb_window_t parent;
+    xcb_pixmap_t named;
+    xcb_gcontext_t gc;
+    uint32_t eid, serial = 0;
+    int i;
+
+    c = xcb_connect(NULL, NULL);
+    screen = xcb_setup_roots_iterator(xcb_get_setup(c)).data;
+
+    ext = xcb_get_extension_data(c, &xcb_present_id);
+    if (!ext->present) {
+        printf("No Present present\n");
+        exit(77);
+    }
+    ext = xcb_get_extension_data(c, &xcb_composite_id);
+    if (!ext->present) {
+        printf("No Composite present\n");
+        exit(77);
+    }
+    if (screen->root_depth != 24) {
+        printf("Root depth %d, need 24\n", screen->root_depth);
+        exit(77);
+    }
+
+    free(xcb_present_query_version_reply(c,
+            xcb_present_query_version(c, 1, 2), NULL));
+    free(xcb_composite_query_version_reply(c,
+            xcb_composite_query_version(c, 0, 4), NULL));
+
+    parent = xcb_generate_id(c);
+    window = xcb_generate_id(c);
+    xcb_create_window(c, XCB_COPY_FROM_PARENT, parent, screen->root,
+                      0, 0, WIDTH, HEIGHT, 0, XCB_WINDOW_CLASS_INPUT_OUTPUT,
+                      screen->root_visual, 0, NULL);
+    xcb_composite_redirect_subwindows(c, parent,
+                                      XCB_COMPOSITE_REDIRECT_AUTOMATIC);
+    xcb_create_window(c, XCB_COPY_FROM_PARENT, window, parent,
+                      0, 0, WIDTH, HEIGHT, 0, XCB_WINDOW_CLASS_INPUT_OUTPUT,
+                      screen->root_visual, 0, NULL);
+    xcb_map_window(c, window);
+    xcb_map_window(c, parent);
+
+    gc = xcb_generate_id(c);
+    xcb_create_gc(c, gc, window, 0, NULL);
+    for (i = 0; i < NUM_PIXMAPS; i++) {
+        pixmaps[i] = xcb_generate_id(c);
+        xcb_create_pixmap(c, screen->root_depth, pixmaps[i], window,
+                          WIDTH, HEIGHT);
+        fill_pattern(pixmaps[i], gc, i);
+        idle[i] = 1;
+    }
+
+    eid = xcb_generate_id(c);
+    special = xcb_register_for_special_xge(c, &xcb_present_id, eid, NULL);
+    xcb_present_select_input(c, eid, window,
+                             XCB_PRESENT_EVENT_MASK_COMPLETE_NOTIFY |
+                             XCB_PRESENT_EVENT_MASK_IDLE_NOTIFY);
+
+    /* Plain presents, each replacing the last one */
+    present(0, ++serial);
+    check(window, "window", 0);
+    present(1, ++serial);
+    check(window, "window", 1);
+    wait_for_idle(0);
+
+    /*
+     * Name the window pixmap, which may be the presented pixmap 1, and
+     * present again.  The window must keep the named pixmap, so the
+     * present has to show up in both.
+     */
+    named = xcb_generate_id(c);
+    xcb_composite_name_window_pixmap(c, window, named);
+    present(2, ++serial);
+    check(window, "window", 2);
+    check(named, "named window pixmap", 2);
+
+    /* Drawing to the window still lands in the named pixmap */
+    fill_pattern(window, gc, 0);
+    check(named, "named window pixmap", 0);
+    wait_for_idle(2);
+
+    /* Once the name is gone, presents may exchange again */
+    xcb_free_pixmap(c, named);
+    present(0, ++serial);
+    check(window, "window", 0);
+    present(2, ++serial);
+    check(window, "window", 2);
+    wait_for_idle(0);
+    wait_for_idle(1);
+
+    printf("%u presents read back correctly (copy %d, flip %d)\n", serial,
+           modes[XCB_PRESENT_COMPLETE_MODE_COPY],
+           modes[XCB_PRESENT_COMPLETE_MODE_FLIP]);
+
+    xcb_destroy_window(c, parent);
+    xcb_unregister_for_special_event(c, special);
+    xcb_disconnect(c);
+    exit(0);
+}
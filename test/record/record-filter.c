@@ -0,0 +1,184 @@
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ * Record GetInputFocus, XC-MISC GetXIDRange and BadWindow errors from
+ * one client and check that exactly those, and nothing the client did
+ * around them, come back from the context.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <xcb/xcb.h>
+#include <xcb/xc_misc.h>
+#include <xcb/record.h>
+
+#define NUM_REQUESTS 200
+
+enum { FROM_SERVER = 0, FROM_CLIENT = 1, END_OF_DATA = 5 };
+
+static xcb_connection_t *
+connect_or_die(void)
+{
+    xcb_connection_t *c = xcb_connect(NULL, NULL);
+
+    if (!c || xcb_connection_has_error(c)) {
+        fprintf(stderr, "cannot connect\n");
+        exit(1);
+    }
+    return c;
+}
+
+int
+main(void)
+{
+    xcb_connection_t *worker, *recorder, *control;
+    const xcb_query_extension_reply_t *ext;
+    xcb_record_enable_context_cookie_t cookie;
+    xcb_record_enable_context_reply_t *reply;
+    xcb_record_client_spec_t spec;
+    xcb_record_range_t range;
+    xcb_record_context_t context;
+    xcb_generic_error_t *error;
+    int focus = 0, xidrange = 0, badwindow = 0, other = 0;
+    uint8_t xcmisc;
+    int n;
+
+    worker = connect_or_die();
+    recorder = connect_or_die();
+    control = connect_or_die();
+
+    ext = xcb_get_extension_data(control, &xcb_record_id);
+    if (!ext || !ext->present) {
+        fprintf(stderr, "RECORD not present, skipping\n");
+        return 77;
+    }
+    ext = xcb_get_extension_data(worker, &xcb_xc_misc_id);
+    if (!ext || !ext->present) {
+        fprintf(stderr, "XC-MISC not present, skipping\n");
+        return 77;
+    }
+    xcmisc = ext->major_opcode;
+
+    memset(&range, 0, sizeof(range));
+    range.core_requests.first = range.core_requests.last = XCB_GET_INPUT_FOCUS;
+    range.ext_requests.major.first = range.ext_requests.major.last = xcmisc;
+    range.ext_requests.minor.first = range.ext_requests.minor.last =
+        XCB_XC_MISC_GET_XID_RANGE;
+    range.errors.first = range.errors.last = XCB_WINDOW;
+
+    /* any XID of the worker names it */
+    spec = xcb_get_setup(worker)->resource_id_base;
+    context = xcb_generate_id(control);
+    error = xcb_request_check(control,
+                              xcb_record_create_context_checked(control, context,
+                                                                0, 1, 1,
+                                                                &spec, &range));
+    if (error) {
+        fprintf(stderr, "CreateContext failed: %d\n", error->error_code);
+        return 1;
+    }
+
+    /* the first reply is StartOfData, after which recording is live */
+    cookie = xcb_record_enable_context(recorder, context);
+    reply = xcb_record_enable_context_reply(recorder, cookie, NULL);
+    if (!reply) {
+        fprintf(stderr, "EnableContext failed\n");
+        return 1;
+    }
+    free(reply);
+
+    for (n = 0; n < NUM_REQUESTS; n++) {
+        xcb_get_input_focus(worker);
+        xcb_get_geometry(worker, xcb_get_setup(worker)->resource_id_base);
+        xcb_xc_misc_get_xid_range(worker);
+        xcb_xc_misc_get_version(worker, 1, 1);
+        if (n % 10 == 0) {
+            xcb_map_window(worker, xcb_generate_id(worker));
+            xcb_free_pixmap(worker, xcb_generate_id(worker));
+        }
+    }
+    /* not recorded, but makes sure everything before it was */
+    free(xcb_xc_misc_get_version_reply(worker,
+                                       xcb_xc_misc_get_version(worker, 1, 1),
+                                       NULL));
+
+    error = xcb_request_check(control,
+                              xcb_record_disable_context_checked(control,
+                                                                 context));
+    if (error) {
+        fprintf(stderr, "DisableContext failed: %d\n", error->error_code);
+        return 1;
+    }
+
+    while ((reply = xcb_record_enable_context_reply(recorder, cookie, NULL))) {
+        uint8_t *data = xcb_record_enable_context_data(reply);
+        int len = xcb_record_enable_context_data_length(reply);
+        int category = reply->category;
+        int size;
+
+        if (category == END_OF_DATA) {
+            free(reply);
+            break;
+        }
+
+        for (; len > 0; data += size, len -= size) {
+            if (category == FROM_SERVER) {
+                size = 32;
+                if (data[0] == 0 && data[1] == XCB_WINDOW)
+                    badwindow++;
+                else
+                    other++;
+                continue;
+            }
+            if (category != FROM_CLIENT) {
+                other++;
+                break;
+            }
+            size = ((uint16_t *) data)[1] * 4;
+            if (size < 4) {
+                fprintf(stderr, "bad request length in recorded data\n");
+                return 1;
+            }
+            if (data[0] == XCB_GET_INPUT_FOCUS)
+                focus++;
+            else if (data[0] == xcmisc && data[1] == XCB_XC_MISC_GET_XID_RANGE)
+                xidrange++;
+            else
+                other++;
+        }
+        free(reply);
+    }
+
+    xcb_record_free_context(control, context);
+    xcb_disconnect(worker);
+    xcb_disconnect(recorder);
+    xcb_disconnect(control);
+
+    printf("recorded %d GetInputFocus, %d GetXIDRange, %d BadWindow, "
+           "%d other\n", focus, xidrange, badwindow, other);
+
+    if (focus != NUM_REQUESTS || xidrange != NUM_REQUESTS ||
+        badwindow != NUM_REQUESTS / 10 || other != 0)
+        return 1;
+    return 0;
+}
@@ -0,0 +1,211 @@
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ * Scheduler benchmark: many clients keep the server saturated with
+ * rendering while one more client measures how long a simple round trip
+ * takes.  Reports round trip latency and how evenly the busy clients
+ * were served.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <xcb/xcb.h>
+
+#define NUM_CLIENTS 64
+#define DURATION 3.0
+#define PROBE_INTERVAL_US 10000
+#define BATCH 16
+#define SIZE 256
+
+static double
+now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int
+compare_double(const void *a, const void *b)
+{
+    double x = *(const double *) a, y = *(const double *) b;
+
+    return x < y ? -1 : x > y;
+}
+
+/* Fill a pixmap over and over, syncing once per batch */
+static void
+busy_client(int go, int result)
+{
+    xcb_connection_t *c = xcb_connect(NULL, NULL);
+    xcb_screen_t *screen;
+    xcb_pixmap_t pixmap;
+    xcb_gcontext_t gc;
+    xcb_rectangle_t rect = { 0, 0, SIZE, SIZE };
+    unsigned long batches = 0;
+    double end;
+    char byte;
+    int i;
+
+    if (!c || xcb_connection_has_error(c))
+        _exit(1);
+
+    screen = xcb_setup_roots_iterator(xcb_get_setup(c)).data;
+    pixmap = xcb_generate_id(c);
+    gc = xcb_generate_id(c);
+    xcb_create_pixmap(c, screen->root_depth, pixmap, screen->root, SIZE, SIZE);
+    xcb_create_gc(c, gc, pixmap, 0, NULL);
+    free(xcb_get_input_focus_reply(c, xcb_get_input_focus(c), NULL));
+
+    if (read(go, &byte, 1) != 1)
+        _exit(1);
+
+    end = now() + DURATION;
+    while (now() < end) {
+        uint32_t fg = batches;
+        xcb_get_input_focus_reply_t *reply;
+
+        for (i = 0; i < BATCH; i++) {
+            xcb_change_gc(c, gc, XCB_GC_FOREGROUND, &fg);
+            xcb_poly_fill_rectangle(c, pixmap, gc, 1, &rect);
+        }
+        reply = xcb_get_input_focus_reply(c, xcb_get_input_focus(c), NULL);
+        if (!reply)
+            _exit(1);
+        free(reply);
+        batches++;
+    }
+
+    if (write(result, &batches, sizeof(batches)) != sizeof(batches))
+        _exit(1);
+    xcb_disconnect(c);
+    _exit(0);
+}
+
+int main(int argc, char **argv)
+{
+    int nclients = argc > 1 ? atoi(argv[1]) : NUM_CLIENTS;
+    int go[2], result[2];
+    xcb_connection_t *c;
+    double *latency, end, sum = 0, sum2 = 0;
+    unsigned long batches, min = ~0UL, max = 0;
+    int nprobes = 0, maxprobes, failed = 0;
+    pid_t *pids;
+    int i;
+
+    if (nclients <= 0)
+        nclients = NUM_CLIENTS;
+
+    pids = calloc(nclients, sizeof(pid_t));
+    maxprobes = DURATION * 1000000 / PROBE_INTERVAL_US + 1;
+    latency = calloc(maxprobes, sizeof(double));
+    if (!pids || !latency || pipe(go) < 0 || pipe(result) < 0) {
+        fprintf(stderr, "setup failed\n");
+        return 1;
+    }
+
+    for (i = 0; i < nclients; i++) {
+        pids[i] = fork();
+        if (pids[i] < 0) {
+            perror("fork");
+            return 1;
+        }
+        if (pids[i] == 0) {
+            close(go[1]);
+            close(result[0]);
+            busy_client(go[0], result[1]);
+        }
+    }
+    close(go[0]);
+    close(result[1]);
+
+    c = xcb_connect(NULL, NULL);
+    if (!c || xcb_connection_has_error(c)) {
+        fprintf(stderr, "Failed to connect to X server\n");
+        return 1;
+    }
+
+    /* Start everyone at once */
+    for (i = 0; i < nclients; i++) {
+        if (write(go[1], "", 1) != 1) {
+            perror("write");
+            return 1;
+        }
+    }
+
+    end = now() + DURATION;
+    while (now() < end && nprobes < maxprobes) {
+        double start = now();
+
+        free(xcb_get_input_focus_reply(c, xcb_get_input_focus(c), NULL));
+        latency[nprobes++] = now() - start;
+        usleep(PROBE_INTERVAL_US);
+    }
+
+    for (i = 0; i < nclients; i++) {
+        if (read(result[0], &batches, sizeof(batches)) != sizeof(batches)) {
+            failed++;
+            continue;
+        }
+        if (batches < min)
+            min = batches;
+        if (batches > max)
+            max = batches;
+        sum += batches;
+        sum2 += (double) batches * batches;
+    }
+
+    for (i = 0; i < nclients; i++) {
+        int status;
+
+        while (waitpid(pids[i], &status, 0) < 0 && errno == EINTR)
+            ;
+    }
+
+    qsort(latency, nprobes, sizeof(double), compare_double);
+    printf("%d busy clients: %.0f batches, min %lu max %lu, fairness %.3f\n",
+           nclients, sum, failed ? 0 : min, max,
+           sum2 > 0 ? sum * sum / (nclients * sum2) : 0);
+    if (nprobes)
+        printf("round trip: median %.2fms p99 %.2fms max %.2fms\n",
+               latency[nprobes / 2] * 1000,
+               latency[nprobes * 99 / 100] * 1000,
+               latency[nprobes - 1] * 1000);
+
+    xcb_disconnect(c);
+    free(latency);
+    free(pids);
+
+    /* A client that got nothing done in the whole run was starved */
+    if (failed || min == 0) {
+        fprintf(stderr, "%d clients failed, least served did %lu batches\n",
+                failed, failed ? 0 : min);
+        return 1;
+    }
+    return 0;
+}
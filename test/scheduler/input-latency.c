@@ -0,0 +1,219 @@
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ * Input to render latency under load: while a few clients render
+ * flat out, inject key presses with XTest and time how long it takes
+ * the window receiving them to see the event and get a frame drawn.
+ * Runs once with PointerRoot focus and once with the window focused,
+ * which puts its client in the latency scheduling class.
+ */
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <xcb/xcb.h>
+#include <xcb/xtest.h>
+
+#define NUM_BACKGROUND 8
+#define NUM_SAMPLES 200
+#define SIZE 1024
+
+static double
+now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int
+compare_double(const void *a, const void *b)
+{
+    double x = *(const double *) a, y = *(const double *) b;
+
+    return x < y ? -1 : x > y;
+}
+
+/* Render into a large pixmap until killed */
+static void
+background_client(void)
+{
+    xcb_connection_t *c = xcb_connect(NULL, NULL);
+    xcb_screen_t *screen;
+    xcb_pixmap_t pixmap;
+    xcb_gcontext_t gc;
+    xcb_rectangle_t rect = { 0, 0, SIZE, SIZE };
+    uint32_t fg = 0;
+    int i;
+
+    if (!c || xcb_connection_has_error(c))
+        _exit(1);
+
+    screen = xcb_setup_roots_iterator(xcb_get_setup(c)).data;
+    pixmap = xcb_generate_id(c);
+    gc = xcb_generate_id(c);
+    xcb_create_pixmap(c, screen->root_depth, pixmap, screen->root, SIZE, SIZE);
+    xcb_create_gc(c, gc, pixmap, 0, NULL);
+
+    for (;;) {
+        for (i = 0; i < 16; i++) {
+            fg++;
+            xcb_change_gc(c, gc, XCB_GC_FOREGROUND, &fg);
+            xcb_poly_fill_rectangle(c, pixmap, gc, 1, &rect);
+        }
+        free(xcb_get_input_focus_reply(c, xcb_get_input_focus(c), NULL));
+        if (xcb_connection_has_error(c))
+            _exit(0);
+    }
+}
+
+static xcb_generic_event_t *
+wait_for(xcb_connection_t *c, uint8_t type)
+{
+    xcb_generic_event_t *ev;
+
+    while ((ev = xcb_wait_for_event(c))) {
+        if ((ev->response_type & ~0x80) == type)
+            return ev;
+        free(ev);
+    }
+    return NULL;
+}
+
+static int
+measure(xcb_connection_t *c, xcb_window_t window, xcb_gcontext_t gc,
+        xcb_keycode_t key, const char *name)
+{
+    xcb_rectangle_t rect = { 0, 0, 256, 256 };
+    double latency[NUM_SAMPLES];
+    int i;
+
+    for (i = 0; i < NUM_SAMPLES; i++) {
+        xcb_generic_event_t *ev;
+        double start = now();
+
+        xcb_test_fake_input(c, XCB_KEY_PRESS, key, XCB_CURRENT_TIME,
+                            XCB_NONE, 0, 0, 0);
+        xcb_flush(c);
+        if (!(ev = wait_for(c, XCB_KEY_PRESS)))
+            return 1;
+        free(ev);
+
+        /* Draw the response and wait until the server has done it */
+        xcb_poly_fill_rectangle(c, window, gc, 1, &rect);
+        free(xcb_get_input_focus_reply(c, xcb_get_input_focus(c), NULL));
+        latency[i] = now() - start;
+
+        xcb_test_fake_input(c, XCB_KEY_RELEASE, key, XCB_CURRENT_TIME,
+                            XCB_NONE, 0, 0, 0);
+        xcb_flush(c);
+        if (!(ev = wait_for(c, XCB_KEY_RELEASE)))
+            return 1;
+        free(ev);
+
+        usleep(10000);
+    }
+
+    qsort(latency, NUM_SAMPLES, sizeof(double), compare_double);
+    printf("%s: median %.2fms p99 %.2fms max %.2fms\n", name,
+           latency[NUM_SAMPLES / 2] * 1000,
+           latency[NUM_SAMPLES * 99 / 100] * 1000,
+           latency[NUM_SAMPLES - 1] * 1000);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    xcb_connection_t *c;
+    xcb_screen_t *screen;
+    xcb_window_t window;
+    xcb_gcontext_t gc;
+    xcb_keycode_t key;
+    const xcb_query_extension_reply_t *ext;
+    uint32_t values[2];
+    pid_t pids[NUM_BACKGROUND];
+    int i, ret;
+
+    c = xcb_connect(NULL, NULL);
+    if (!c || xcb_connection_has_error(c)) {
+        fprintf(stderr, "Failed to connect to X server\n");
+        return 1;
+    }
+
+    ext = xcb_get_extension_data(c, &xcb_test_id);
+    if (!ext || !ext->present) {
+        printf("No XTEST extension\n");
+        return 77;
+    }
+
+    screen = xcb_setup_roots_iterator(xcb_get_setup(c)).data;
+    key = xcb_get_setup(c)->min_keycode + 30;
+
+    window = xcb_generate_id(c);
+    values[0] = screen->white_pixel;
+    values[1] = XCB_EVENT_MASK_KEY_PRESS | XCB_EVENT_MASK_KEY_RELEASE |
+        XCB_EVENT_MASK_EXPOSURE;
+    xcb_create_window(c, XCB_COPY_FROM_PARENT, window, screen->root,
+                      0, 0, 256, 256, 0, XCB_WINDOW_CLASS_INPUT_OUTPUT,
+                      screen->root_visual, XCB_CW_BACK_PIXEL | XCB_CW_EVENT_MASK,
+                      values);
+    gc = xcb_generate_id(c);
+    xcb_create_gc(c, gc, window, 0, NULL);
+    xcb_map_window(c, window);
+    xcb_warp_pointer(c, XCB_NONE, window, 0, 0, 0, 0, 128, 128);
+    xcb_flush(c);
+    free(wait_for(c, XCB_EXPOSE));
+
+    for (i = 0; i < NUM_BACKGROUND; i++) {
+        pids[i] = fork();
+        if (pids[i] == 0)
+            background_client();
+    }
+    /* Let the background clients get going */
+    sleep(1);
+
+    xcb_set_input_focus(c, XCB_INPUT_FOCUS_POINTER_ROOT,
+                        XCB_INPUT_FOCUS_POINTER_ROOT, XCB_CURRENT_TIME);
+    ret = measure(c, window, gc, key, "pointer root focus");
+
+    xcb_set_input_focus(c, XCB_INPUT_FOCUS_POINTER_ROOT, window,
+                        XCB_CURRENT_TIME);
+    if (!ret)
+        ret = measure(c, window, gc, key, "focused window");
+
+    for (i = 0; i < NUM_BACKGROUND; i++) {
+        if (pids[i] > 0) {
+            kill(pids[i], SIGTERM);
+            waitpid(pids[i], NULL, 0);
+        }
+    }
+
+    xcb_disconnect(c);
+    if (ret)
+        fprintf(stderr, "Lost connection while measuring\n");
+    return ret;
+}
@@ -0,0 +1,182 @@
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ * Rendering split over -workerthreads must not change any pixel.  The
+ * same scene is drawn into two pixmaps: once with requests big enough
+ * to be split into bands, once in strips small enough to always stay
+ * on the main thread.  Both are read back with GetImage and compared.
+ * Run against servers with -workerthreads 1 and with several threads;
+ * the checksum printed must match between the runs too.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <xcb/xcb.h>
+
+#define WIDTH 1024
+#define HEIGHT 768
+/* Rows per strip; 32 rows of 4KB stay below the banding threshold */
+#define STRIP 32
+
+typedef struct {
+    int16_t x, y;
+    uint16_t width, height;
+    uint32_t function, plane_mask, foreground;
+} fill_t;
+
+static const fill_t fills[] = {
+    { 0, 0, WIDTH, HEIGHT, XCB_GX_COPY, ~0, 0x336699 },
+    { 3, 1, WIDTH - 7, HEIGHT - 2, XCB_GX_XOR, 0x00ff00ff, 0xa5a5a5 },
+    { 17, 5, 1001, 700, XCB_GX_AND, ~0, 0xf0f0f0 },
+    { 1, 9, 999, 751, XCB_GX_OR_REVERSE, 0x00ffff00, 0x0f1e2d },
+};
+
+static void
+put_image(xcb_connection_t *c, xcb_pixmap_t pixmap, xcb_gcontext_t gc,
+          const uint32_t *image, int y, int height)
+{
+    xcb_put_image(c, XCB_IMAGE_FORMAT_Z_PIXMAP, pixmap, gc,
+                  WIDTH, height, 0, y, 0, 24,
+                  WIDTH * height * 4, (const uint8_t *) (image + y * WIDTH));
+}
+
+static void
+draw_scene(xcb_connection_t *c, xcb_pixmap_t pixmap, xcb_gcontext_t gc,
+           const uint32_t *image, int strip)
+{
+    uint32_t values[3];
+    int i, y;
+
+    for (y = 0; y < HEIGHT; y += strip)
+        put_image(c, pixmap, gc, image, y,
+                  y + strip > HEIGHT ? HEIGHT - y : strip);
+
+    for (i = 0; i < sizeof(fills) / sizeof(fills[0]); i++) {
+        const fill_t *f = &fills[i];
+
+        values[0] = f->function;
+        values[1] = f->plane_mask;
+        values[2] = f->foreground;
+        xcb_change_gc(c, gc, XCB_GC_FUNCTION | XCB_GC_PLANE_MASK |
+                      XCB_GC_FOREGROUND, values);
+        for (y = 0; y < f->height; y += strip) {
+            xcb_rectangle_t rect = {
+                f->x, f->y + y, f->width,
+                y + strip > f->height ? f->height - y : strip
+            };
+
+            xcb_poly_fill_rectangle(c, pixmap, gc, 1, &rect);
+        }
+    }
+
+    values[0] = XCB_GX_COPY;
+    values[1] = ~0;
+    values[2] = 0;
+    xcb_change_gc(c, gc, XCB_GC_FUNCTION | XCB_GC_PLANE_MASK |
+                  XCB_GC_FOREGROUND, values);
+}
+
+static xcb_get_image_reply_t *
+get_image(xcb_connection_t *c, xcb_pixmap_t pixmap)
+{
+    xcb_get_image_reply_t *reply;
+
+    reply = xcb_get_image_reply(c,
+            xcb_get_image(c, XCB_IMAGE_FORMAT_Z_PIXMAP, pixmap,
+                          0, 0, WIDTH, HEIGHT, ~0), NULL);
+    if (!reply) {
+        printf("GetImage failed\n");
+        exit(1);
+    }
+    return reply;
+}
+
+int main(int argc, char **argv)
+{
+    xcb_connection_t *c = xcb_connect(NULL, NULL);
+    xcb_screen_t *screen;
+    xcb_pixmap_t banded, strips;
+    xcb_gcontext_t gc;
+    xcb_get_image_reply_t *a, *b;
+    uint32_t *image, seed = 1, sum = 0;
+    const uint8_t *pa, *pb;
+    int i, length;
+
+    if (!c || xcb_connection_has_error(c)) {
+        printf("Cannot connect\n");
+        exit(1);
+    }
+
+    screen = xcb_setup_roots_iterator(xcb_get_setup(c)).data;
+    if (screen->root_depth != 24) {
+        printf("Root depth %d, need 24\n", screen->root_depth);
+        exit(77);
+    }
+
+    image = malloc(WIDTH * HEIGHT * 4);
+    if (!image)
+        exit(1);
+    for (i = 0; i < WIDTH * HEIGHT; i++) {
+        seed = seed * 1103515245 + 12345;
+        image[i] = seed >> 8;
+    }
+
+    banded = xcb_generate_id(c);
+    strips = xcb_generate_id(c);
+    gc = xcb_generate_id(c);
+    xcb_create_pixmap(c, 24, banded, screen->root, WIDTH, HEIGHT);
+    xcb_create_pixmap(c, 24, strips, screen->root, WIDTH, HEIGHT);
+    xcb_create_gc(c, gc, banded, 0, NULL);
+
+    draw_scene(c, banded, gc, image, HEIGHT);
+    draw_scene(c, strips, gc, image, STRIP);
+
+    a = get_image(c, banded);
+    b = get_image(c, strips);
+    pa = xcb_get_image_data(a);
+    pb = xcb_get_image_data(b);
+    length = xcb_get_image_data_length(a);
+
+    if (length != xcb_get_image_data_length(b) || length < WIDTH * HEIGHT * 4) {
+        printf("GetImage returned %d and %d bytes\n",
+               length, xcb_get_image_data_length(b));
+        exit(1);
+    }
+
+    for (i = 0; i < length; i++) {
+        if (pa[i] != pb[i]) {
+            printf("Banded rendering differs at pixel %d,%d\n",
+                   (i / 4) % WIDTH, (i / 4) / WIDTH);
+            exit(1);
+        }
+        sum = sum * 31 + pa[i];
+    }
+
+    printf("Banded and unbanded rendering match, checksum %08x\n", sum);
+
+    free(a);
+    free(b);
+    free(image);
+    xcb_disconnect(c);
+    exit(0);
+}
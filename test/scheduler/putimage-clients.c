@@ -0,0 +1,166 @@
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ * Several clients uploading large images to their own pixmaps at once;
+ * reports the combined upload rate.  Run against servers with and
+ * without -workerthreads to see how the pixel work scales.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <xcb/xcb.h>
+
+#define NUM_CLIENTS 4
+#define DURATION 2.0
+#define SIZE 512
+
+static double
+now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void
+upload_client(int go, int result)
+{
+    xcb_connection_t *c = xcb_connect(NULL, NULL);
+    xcb_screen_t *screen;
+    xcb_pixmap_t pixmap;
+    xcb_gcontext_t gc;
+    unsigned long bytes = 0;
+    uint8_t *image;
+    size_t size;
+    double end;
+    char byte;
+
+    if (!c || xcb_connection_has_error(c))
+        _exit(1);
+
+    screen = xcb_setup_roots_iterator(xcb_get_setup(c)).data;
+    if (screen->root_depth != 24)
+        _exit(77);
+
+    size = SIZE * SIZE * 4;
+    image = malloc(size);
+    if (!image)
+        _exit(1);
+    memset(image, 0x5a, size);
+
+    pixmap = xcb_generate_id(c);
+    gc = xcb_generate_id(c);
+    xcb_create_pixmap(c, 24, pixmap, screen->root, SIZE, SIZE);
+    xcb_create_gc(c, gc, pixmap, 0, NULL);
+    free(xcb_get_input_focus_reply(c, xcb_get_input_focus(c), NULL));
+
+    if (read(go, &byte, 1) != 1)
+        _exit(1);
+
+    end = now() + DURATION;
+    while (now() < end) {
+        int i;
+
+        for (i = 0; i < 4; i++) {
+            xcb_put_image(c, XCB_IMAGE_FORMAT_Z_PIXMAP, pixmap, gc,
+                          SIZE, SIZE, 0, 0, 0, 24, size, image);
+            bytes += size;
+        }
+        free(xcb_get_input_focus_reply(c, xcb_get_input_focus(c), NULL));
+        if (xcb_connection_has_error(c))
+            _exit(1);
+    }
+
+    if (write(result, &bytes, sizeof(bytes)) != sizeof(bytes))
+        _exit(1);
+    xcb_disconnect(c);
+    _exit(0);
+}
+
+int main(int argc, char **argv)
+{
+    int nclients = argc > 1 ? atoi(argv[1]) : NUM_CLIENTS;
+    int go[2], result[2];
+    unsigned long bytes;
+    double total = 0, start;
+    int i, status, ret = 0;
+
+    if (nclients <= 0)
+        nclients = NUM_CLIENTS;
+
+    if (pipe(go) < 0 || pipe(result) < 0) {
+        perror("pipe");
+        return 1;
+    }
+
+    for (i = 0; i < nclients; i++) {
+        pid_t pid = fork();
+
+        if (pid < 0) {
+            perror("fork");
+            return 1;
+        }
+        if (pid == 0) {
+            close(go[1]);
+            close(result[0]);
+            upload_client(go[0], result[1]);
+        }
+    }
+    close(go[0]);
+    close(result[1]);
+
+    /* Give everyone time to connect, then start them together */
+    sleep(1);
+    start = now();
+    for (i = 0; i < nclients; i++) {
+        if (write(go[1], "", 1) != 1) {
+            perror("write");
+            return 1;
+        }
+    }
+
+    for (i = 0; i < nclients; i++) {
+        if (read(result[0], &bytes, sizeof(bytes)) == sizeof(bytes))
+            total += bytes;
+    }
+
+    while (wait(&status) > 0) {
+        if (!WIFEXITED(status))
+            ret = 1;
+        else if (WEXITSTATUS(status) && !ret)
+            ret = WEXITSTATUS(status);
+    }
+
+    if (ret == 77) {
+        printf("Skipping, root depth is not 24\n");
+        return ret;
+    }
+
+    printf("%d clients: %.0f MB/s uploaded\n", nclients,
+           total / (now() - start) / (1024 * 1024));
+    return ret;
+}
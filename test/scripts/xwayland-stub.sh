@@ -0,0 +1,25 @@
+#!/bin/sh -e
+
+# Run an X client against Xwayland on top of the stub compositor.
+# usage: xwayland-stub.sh stub-compositor simple-xinit client -- Xwayland [args]
+
+STUB=$1
+shift
+
+# libwayland requires XDG_RUNTIME_DIR
+if test "x$XDG_RUNTIME_DIR" = "x"; then
+    export XDG_RUNTIME_DIR=$(mktemp -d)
+fi
+
+$STUB wayland-stub-$$ &
+STUB_PID=$!
+export WAYLAND_DISPLAY=wayland-stub-$$
+
+timeout --preserve-status 10s sh -c \
+    "while ! test -S $XDG_RUNTIME_DIR/$WAYLAND_DISPLAY; do sleep 0.1; done"
+
+STATUS=0
+"$@" || STATUS=$?
+
+kill $STUB_PID
+exit $STATUS
@@ -178,6 +178,8 @@ static void logging_format(void)
     memset(buf, '.', sizeof(buf));
     strcpy(&buf[sizeof(buf) - 4], "end");
 
+    /* messages are read back right after writing them */
+    LogSetParameter(XLOG_SYNC, TRUE);
     LogInit(log_file_path, NULL);
     assert((f = fopen(log_file_path, "r")));
 
@@ -396,10 +398,56 @@ static void logging_format(void)
 }
 #pragma GCC diagnostic pop /* "-Wformat-security" */
 
+/* Messages written through the log thread come out complete and in
+ * order; any that didn't fit in the ring are reported as dropped. */
+static void
+threaded_logging(void)
+{
+    const char *log_file_path = "/tmp/Xorg-logging-thread-test.log";
+    const int count = 20000;
+    FILE *f;
+    char line[256];
+    int i, next = 0, found = 0, dropped = 0;
+
+    LogInit(log_file_path, NULL);
+
+    for (i = 0; i < count; i++) {
+        if (i % 2)
+            LogMessageVerb(X_INFO, -1, "message %d\n", i);
+        else
+            LogMessageVerbSigSafe(X_INFO, -1, "message %d\n", i);
+    }
+
+    LogClose(EXIT_NO_ERROR);
+
+    assert((f = fopen(log_file_path, "r")));
+    while (fgets(line, sizeof(line), f)) {
+        char *msg;
+
+        if ((msg = strstr(line, "(WW) log ring full, "))) {
+            dropped += atoi(msg + strlen("(WW) log ring full, "));
+        }
+        else if ((msg = strstr(line, "message "))) {
+            int n = atoi(msg + strlen("message "));
+
+            assert(n >= next);
+            next = n + 1;
+            found++;
+        }
+    }
+    fclose(f);
+    unlink(log_file_path);
+
+    /* a dropped piece loses at most one message */
+    assert(found > 0);
+    assert(found + dropped >= count);
+}
+
 int
 signal_logging_test(void)
 {
     number_formatting();
+    threaded_logging();
     logging_format();
 
     return 0;
@@ -0,0 +1,130 @@
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ * Counter changes with many alarms attached: NUM_ALARMS alarms fire one
+ * by one as the counter steps through their values, while as many
+ * again sit far away from it and never fire.  Every change should only
+ * cost as much as the alarms it actually fires.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <xcb/sync.h>
+
+#define NUM_ALARMS 10000
+
+static double
+now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void
+create_alarm(xcb_connection_t *c, xcb_sync_counter_t counter,
+             int64_t value, uint32_t test_type, uint32_t events)
+{
+    uint32_t values[] = {
+        counter,
+        XCB_SYNC_VALUETYPE_ABSOLUTE,
+        value >> 32, value,
+        test_type,
+        0, 0,
+        events,
+    };
+
+    xcb_sync_create_alarm(c, xcb_generate_id(c),
+                          XCB_SYNC_CA_COUNTER | XCB_SYNC_CA_VALUE_TYPE |
+                          XCB_SYNC_CA_VALUE | XCB_SYNC_CA_TEST_TYPE |
+                          XCB_SYNC_CA_DELTA | XCB_SYNC_CA_EVENTS,
+                          values);
+}
+
+static int
+count_alarm_events(xcb_connection_t *c, int event_base)
+{
+    xcb_generic_event_t *ev;
+    int count = 0;
+
+    free(xcb_get_input_focus_reply(c, xcb_get_input_focus(c), NULL));
+
+    while ((ev = xcb_poll_for_event(c))) {
+        if ((ev->response_type & 0x7f) == event_base + XCB_SYNC_ALARM_NOTIFY)
+            count++;
+        free(ev);
+    }
+
+    return count;
+}
+
+int main(int argc, char **argv)
+{
+    xcb_connection_t *c = xcb_connect(NULL, NULL);
+    const xcb_query_extension_reply_t *ext = xcb_get_extension_data(c, &xcb_sync_id);
+    xcb_sync_counter_t counter;
+    double start, elapsed;
+    int i, fired = 0;
+
+    if (!ext->present) {
+        printf("No XSync present\n");
+        exit(77);
+    }
+
+    counter = xcb_generate_id(c);
+    xcb_sync_create_counter(c, counter, (xcb_sync_int64_t) { 0, 0 });
+
+    start = now();
+    for (i = 0; i < NUM_ALARMS; i++) {
+        create_alarm(c, counter, i + 1, XCB_SYNC_TESTTYPE_POSITIVE_TRANSITION,
+                     1);
+        create_alarm(c, counter, (int64_t) 1 << 40,
+                     i & 1 ? XCB_SYNC_TESTTYPE_POSITIVE_COMPARISON :
+                     XCB_SYNC_TESTTYPE_POSITIVE_TRANSITION, 0);
+    }
+    fired += count_alarm_events(c, ext->first_event);
+    elapsed = now() - start;
+    printf("created %d alarms in %.1f ms\n", 2 * NUM_ALARMS, elapsed * 1e3);
+
+    start = now();
+    for (i = 1; i <= NUM_ALARMS; i++) {
+        xcb_sync_set_counter(c, counter, (xcb_sync_int64_t) { 0, i });
+        if (i % 1000 == 0)
+            fired += count_alarm_events(c, ext->first_event);
+    }
+    fired += count_alarm_events(c, ext->first_event);
+    elapsed = now() - start;
+
+    printf("%d counter changes: %.2f us per change, %d alarms fired\n",
+           NUM_ALARMS, elapsed * 1e6 / NUM_ALARMS, fired);
+
+    xcb_disconnect(c);
+
+    if (fired != NUM_ALARMS) {
+        fprintf(stderr, "expected %d AlarmNotify events\n", NUM_ALARMS);
+        exit(1);
+    }
+
+    exit(0);
+}
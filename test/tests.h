@@ -6,6 +6,7 @@ int hashtabletest_test(void);
 int input_test(void);
 int list_test(void);
 int misc_test(void);
+int ospoll_test(void);
 int signal_logging_test(void);
 int string_test(void);
 int touch_test(void);
@@ -27,6 +27,7 @@
 
 #include <stdint.h>
 #include "inputstr.h"
+#include "eventstr.h"
 #include "assert.h"
 #include "scrnintstr.h"
 
@@ -279,6 +280,130 @@ touch_init(void)
     free(dev.name);
 }
 
+/**
+ * 20 concurrent touches updating at 120Hz for ten seconds, with one contact
+ * lifted and replaced every quarter second. Every update must find both the
+ * DDX and the client touch point for its id and the history must retain the
+ * TouchBegin and the most recent TouchUpdates.
+ */
+static void
+touch_stress(void)
+{
+    DeviceIntRec dev;
+    Atom labels[2] = { 0 };
+    SpriteInfoRec sprite;
+    ScreenRec screen;
+    uint32_t ddx_ids[20];
+    const int ncontacts = ARRAY_SIZE(ddx_ids);
+    uint32_t next_ddx_id = 1000;
+    int frame, i;
+
+    memset(&screen, 0, sizeof(screen));
+    screenInfo.screens[0] = &screen;
+
+    memset(&dev, 0, sizeof(dev));
+    dev.name = xnfstrdup("test device");
+    dev.id = 2;
+
+    memset(&sprite, 0, sizeof(sprite));
+    dev.spriteInfo = &sprite;
+
+    InitAtoms();
+    assert(InitValuatorClassDeviceStruct(&dev, 2, labels, 10, Absolute));
+    assert(InitTouchClassDeviceStruct(&dev, ncontacts, XIDirectTouch, 2));
+
+    for (i = 0; i < ncontacts; i++)
+        ddx_ids[i] = 0;
+
+    for (frame = 0; frame < 120 * 10; frame++) {
+        for (i = 0; i < ncontacts; i++) {
+            DDXTouchPointInfoPtr ddxti;
+            TouchPointInfoPtr ti;
+            DeviceEvent ev;
+
+            /* lift one contact every 30 frames */
+            if (ddx_ids[i] && frame % 30 == 0 && (frame / 30) % ncontacts == i) {
+                ddxti = TouchFindByDDXID(&dev, ddx_ids[i], FALSE);
+                assert(ddxti);
+                ti = TouchFindByClientID(&dev, ddxti->client_id);
+                assert(ti);
+                TouchEndTouch(&dev, ti);
+                TouchEndDDXTouch(&dev, ddxti);
+                assert(!TouchFindByDDXID(&dev, ddx_ids[i], FALSE));
+                ddx_ids[i] = 0;
+            }
+
+            memset(&ev, 0, sizeof(ev));
+            ev.header = ET_Internal;
+            ev.time = frame;
+
+            if (!ddx_ids[i]) {
+                ddx_ids[i] = next_ddx_id++;
+                ddxti = TouchFindByDDXID(&dev, ddx_ids[i], TRUE);
+                assert(ddxti);
+                ti = TouchBeginTouch(&dev, dev.id, ddxti->client_id,
+                                     ddxti->emulate_pointer);
+                assert(ti);
+                assert(TouchEventHistoryAllocate(ti));
+                ev.type = ET_TouchBegin;
+            }
+            else {
+                ddxti = TouchFindByDDXID(&dev, ddx_ids[i], FALSE);
+                assert(ddxti);
+                assert(ddxti->ddx_id == ddx_ids[i]);
+                ti = TouchFindByClientID(&dev, ddxti->client_id);
+                assert(ti);
+                assert(ti->client_id == ddxti->client_id);
+                ev.type = ET_TouchUpdate;
+            }
+
+            ev.touchid = ti->client_id;
+            TouchEventHistoryPush(ti, &ev);
+        }
+    }
+
+    /* never more touch points than concurrent contacts */
+    assert(dev.touch->num_touches == ncontacts);
+    assert(dev.last.num_touches == ncontacts);
+
+    for (i = 0; i < ncontacts; i++) {
+        DDXTouchPointInfoPtr ddxti = TouchFindByDDXID(&dev, ddx_ids[i], FALSE);
+        TouchPointInfoPtr ti = TouchFindByClientID(&dev, ddxti->client_id);
+        size_t ring = ti->history_size - 1;
+        size_t newest, oldest;
+
+        assert(ti->history[0].type == ET_TouchBegin);
+        if (ti->history_elements < ti->history_size)
+            continue;
+
+        newest = 1 + (ti->history_first + ti->history_elements - 2) % ring;
+        oldest = 1 + ti->history_first;
+        assert(ti->history[newest].type == ET_TouchUpdate);
+        assert(ti->history[newest].time == frame - 1);
+        assert(ti->history[oldest].time == frame - ring);
+    }
+
+    /* more contacts than touch points: both tables have to grow */
+    for (i = 0; i < 5; i++) {
+        DDXTouchPointInfoPtr ddxti = TouchFindByDDXID(&dev, next_ddx_id++, TRUE);
+
+        assert(ddxti);
+        assert(TouchBeginTouch(&dev, dev.id, ddxti->client_id, FALSE));
+        assert(TouchFindByClientID(&dev, ddxti->client_id));
+    }
+    assert(dev.touch->num_touches > ncontacts);
+    assert(dev.last.num_touches > ncontacts);
+
+    for (i = 0; i < ncontacts; i++) {
+        DDXTouchPointInfoPtr ddxti = TouchFindByDDXID(&dev, ddx_ids[i], FALSE);
+
+        assert(ddxti);
+        assert(TouchFindByClientID(&dev, ddxti->client_id));
+    }
+
+    free(dev.name);
+}
+
 int
 touch_test(void)
 {
@@ -288,6 +413,7 @@ touch_test(void)
     touch_begin_ddxtouch();
     touch_init();
     touch_begin_touch();
+    touch_stress();
 
     printf("touch_test: exiting successfully\n");
     return 0;
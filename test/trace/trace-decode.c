@@ -0,0 +1,174 @@
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ * Decoder for the binary trace written by the server's -tracefile
+ * option.  Prints one line per record, or with -s a per-opcode summary
+ * of request counts and processing times.
+ *
+ *   trace-decode [-s] [-c client] tracefile
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "tracefile.h"
+
+#define ARRAY_SIZE(a) (sizeof(a) / sizeof((a)[0]))
+
+static const char *kinds[] = {
+    [TRACE_REQUEST] = "request",
+    [TRACE_REPLY] = "reply",
+    [TRACE_EVENT] = "event",
+    [TRACE_ERROR] = "error",
+};
+
+typedef struct {
+    uint64_t count;
+    uint64_t total;
+    uint32_t max;
+    uint64_t errors;
+} OpStats;
+
+static void
+print_record(const TraceRecordRec *rec, uint64_t t0)
+{
+    printf("%12.6f client %3u seq %6u %-7s %3u.%-3u len %7u",
+           (rec->time - t0) / 1e6, rec->client, rec->sequence,
+           rec->kind < ARRAY_SIZE(kinds) && kinds[rec->kind] ? kinds[rec->kind] : "?",
+           rec->major, rec->minor, rec->length);
+    if (rec->kind == TRACE_REQUEST)
+        printf(" result %u time %uus", rec->result, rec->duration);
+    else if (rec->kind == TRACE_ERROR)
+        printf(" code %u", rec->result);
+    else if (rec->kind == TRACE_EVENT && rec->result)
+        printf(" extension %u", rec->result);
+    printf("\n");
+}
+
+int
+main(int argc, char **argv)
+{
+    const TraceHeaderRec *header;
+    const TraceRecordRec *ring;
+    OpStats *stats = NULL;
+    int summary = 0, client = -1, opt, fd;
+    uint64_t first, head, i, t0 = 0;
+    struct stat st;
+
+    while ((opt = getopt(argc, argv, "sc:")) != -1) {
+        switch (opt) {
+        case 's':
+            summary = 1;
+            break;
+        case 'c':
+            client = atoi(optarg);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-s] [-c client] tracefile\n", argv[0]);
+            return 1;
+        }
+    }
+    if (optind >= argc) {
+        fprintf(stderr, "usage: %s [-s] [-c client] tracefile\n", argv[0]);
+        return 1;
+    }
+
+    fd = open(argv[optind], O_RDONLY);
+    if (fd < 0 || fstat(fd, &st) < 0) {
+        perror(argv[optind]);
+        return 1;
+    }
+    if ((size_t) st.st_size < sizeof(*header)) {
+        fprintf(stderr, "%s: too short\n", argv[optind]);
+        return 1;
+    }
+    header = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (header == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+
+    if (header->magic != TRACE_MAGIC || header->version != TRACE_VERSION ||
+        header->record_size != sizeof(TraceRecordRec) ||
+        header->header_size + header->nrecords * header->record_size >
+        (uint64_t) st.st_size) {
+        fprintf(stderr, "%s: not a trace file\n", argv[optind]);
+        return 1;
+    }
+    ring = (const TraceRecordRec *) ((const char *) header +
+                                     header->header_size);
+
+    head = __atomic_load_n(&header->head, __ATOMIC_ACQUIRE);
+    first = head > header->nrecords ? head - header->nrecords : 0;
+    if (first != head)
+        t0 = ring[first & (header->nrecords - 1)].time;
+
+    if (summary)
+        stats = calloc(256 * 256, sizeof(OpStats));
+
+    for (i = first; i < head; i++) {
+        const TraceRecordRec *rec = &ring[i & (header->nrecords - 1)];
+
+        if (client >= 0 && rec->client != client)
+            continue;
+        if (!summary) {
+            print_record(rec, t0);
+        }
+        else if (stats && rec->kind == TRACE_REQUEST) {
+            /* extension minor opcodes fit in a byte */
+            OpStats *s = &stats[rec->major * 256 + (rec->minor & 0xff)];
+
+            s->count++;
+            s->total += rec->duration;
+            if (rec->duration > s->max)
+                s->max = rec->duration;
+            if (rec->result)
+                s->errors++;
+        }
+    }
+
+    if (summary && stats) {
+        printf("%7s %10s %12s %10s %10s %8s\n",
+               "opcode", "count", "total us", "avg us", "max us", "errors");
+        for (i = 0; i < 256 * 256; i++) {
+            if (!stats[i].count)
+                continue;
+            printf("%3u.%-3u %10llu %12llu %10.1f %10u %8llu\n",
+                   (unsigned) (i / 256), (unsigned) (i % 256),
+                   (unsigned long long) stats[i].count,
+                   (unsigned long long) stats[i].total,
+                   (double) stats[i].total / stats[i].count, stats[i].max,
+                   (unsigned long long) stats[i].errors);
+        }
+    }
+    if (first)
+        fprintf(stderr, "%llu older records were overwritten\n",
+                (unsigned long long) first);
+    free(stats);
+    return 0;
+}
@@ -0,0 +1,115 @@
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ * Run against a server started with -tracefile and check that our
+ * requests, their replies and errors show up in the trace.
+ *
+ *   trace-requests tracefile
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <xcb/xcb.h>
+
+#include "tracefile.h"
+
+#define NUM_ROUNDTRIPS 500
+
+int
+main(int argc, char **argv)
+{
+    xcb_connection_t *c;
+    xcb_generic_error_t *error;
+    const TraceHeaderRec *header;
+    const TraceRecordRec *ring;
+    struct stat st;
+    uint64_t head, i;
+    int requests = 0, replies = 0, errors = 0;
+    int fd, n;
+
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s tracefile\n", argv[0]);
+        return 1;
+    }
+
+    c = xcb_connect(NULL, NULL);
+    if (!c || xcb_connection_has_error(c)) {
+        fprintf(stderr, "cannot connect\n");
+        return 1;
+    }
+
+    for (n = 0; n < NUM_ROUNDTRIPS; n++)
+        free(xcb_get_input_focus_reply(c, xcb_get_input_focus(c), NULL));
+
+    /* 1 is never a valid pixmap for a client, so this fails */
+    error = xcb_request_check(c, xcb_free_pixmap_checked(c, 1));
+    if (!error || error->error_code != XCB_PIXMAP) {
+        fprintf(stderr, "FreePixmap did not fail\n");
+        return 1;
+    }
+    free(error);
+
+    fd = open(argv[1], O_RDONLY);
+    if (fd < 0 || fstat(fd, &st) < 0) {
+        perror(argv[1]);
+        return 1;
+    }
+    header = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (header == MAP_FAILED || header->magic != TRACE_MAGIC ||
+        header->record_size != sizeof(TraceRecordRec)) {
+        fprintf(stderr, "%s: not a trace file\n", argv[1]);
+        return 1;
+    }
+    ring = (const TraceRecordRec *) ((const char *) header +
+                                     header->header_size);
+
+    head = __atomic_load_n(&header->head, __ATOMIC_ACQUIRE);
+    for (i = head > header->nrecords ? head - header->nrecords : 0;
+         i < head; i++) {
+        const TraceRecordRec *rec = &ring[i & (header->nrecords - 1)];
+
+        if (rec->kind == TRACE_REQUEST && rec->major == XCB_GET_INPUT_FOCUS &&
+            rec->result == 0 && rec->length == 4)
+            requests++;
+        else if (rec->kind == TRACE_REPLY &&
+                 rec->major == XCB_GET_INPUT_FOCUS && rec->length == 32)
+            replies++;
+        else if (rec->kind == TRACE_ERROR && rec->major == XCB_FREE_PIXMAP &&
+                 rec->result == XCB_PIXMAP)
+            errors++;
+    }
+
+    printf("%llu records: %d GetInputFocus requests, %d replies, "
+           "%d FreePixmap errors\n", (unsigned long long) head,
+           requests, replies, errors);
+
+    xcb_disconnect(c);
+
+    if (requests < NUM_ROUNDTRIPS || replies < NUM_ROUNDTRIPS || errors < 1)
+        return 1;
+    return 0;
+}
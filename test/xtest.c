@@ -35,6 +35,7 @@
 #include "xkbsrv.h"
 #include "xserver-properties.h"
 #include "syncsrv.h"
+#include "eventstr.h"
 
 #include "tests-common.h"
 
@@ -129,11 +130,99 @@ xtest_properties(void)
     assert(rc == BadAccess);
 }
 
+static int xtest_key_events_delivered;
+
+static void
+xtest_key_process_input(InternalEvent *ev, DeviceIntPtr dev)
+{
+    xtest_key_events_delivered++;
+}
+
+/* Generate the events for one key press or release and run them through
+ * the XKB action handling */
+static void
+xtest_key_event(InternalEvent *events, int type, int key)
+{
+    int n, k;
+
+    n = GetKeyboardEvents(events, xtestkeyboard, type, key);
+    for (k = 0; k < n; k++) {
+        DeviceEvent *ev = &events[k].device_event;
+
+        if (ev->type != ET_KeyPress && ev->type != ET_KeyRelease)
+            continue;
+        XkbHandleActions(xtestkeyboard, xtestkeyboard, ev);
+    }
+}
+
+/**
+ * Push key events for the XTest keyboard through the XKB action handling,
+ * the same path fake input from XTestFakeInput takes after the event queue.
+ * Plain keys must not leave any action filters behind, a held modifier key
+ * must set its modifier for as long as it is down.
+ */
+static void
+xtest_key_actions(void)
+{
+    XkbSrvInfoPtr xkbi = xtestkeyboard->key->xkbInfo;
+    xkbDeviceInfoPtr xkbPrivPtr = XKBDEVICEINFO(xtestkeyboard);
+    ProcessInputProc oldproc = xkbPrivPtr->realInputProc;
+    InternalEvent *events;
+    int plain_key = 0, mod_key = 0;
+    int kc, i;
+
+    for (kc = xkbi->desc->min_key_code; kc <= xkbi->desc->max_key_code; kc++) {
+        if (!XkbKeyHasActions(xkbi->desc, kc)) {
+            if (!plain_key && XkbKeyNumSyms(xkbi->desc, kc) > 0)
+                plain_key = kc;
+        }
+        else if (!mod_key &&
+                 XkbKeyAction(xkbi->desc, kc, 0)->type == XkbSA_SetMods &&
+                 xkbi->desc->map->modmap[kc])
+            mod_key = kc;
+    }
+    assert(plain_key);
+    assert(mod_key);
+
+    /* Don't deliver the events anywhere, we only want the XKB state */
+    xkbPrivPtr->realInputProc = xtest_key_process_input;
+    xtest_key_events_delivered = 0;
+
+    events = InitEventList(GetMaximumEventsNum());
+
+    for (i = 0; i < 10; i++) {
+        xtest_key_event(events, KeyPress, plain_key);
+        xtest_key_event(events, KeyRelease, plain_key);
+    }
+    assert(xtest_key_events_delivered == 20);
+    assert(xkbi->nFilters == 0);
+    assert(xkbi->state.base_mods == 0);
+
+    xtest_key_event(events, KeyPress, mod_key);
+    assert(xkbi->nFilters == 1);
+    assert(xkbi->filters[0].active);
+    assert(xkbi->state.base_mods == xkbi->desc->map->modmap[mod_key]);
+
+    xtest_key_event(events, KeyPress, plain_key);
+    xtest_key_event(events, KeyRelease, plain_key);
+    assert(xkbi->state.base_mods == xkbi->desc->map->modmap[mod_key]);
+
+    /* the released filter is dropped from the table right away */
+    xtest_key_event(events, KeyRelease, mod_key);
+    assert(xkbi->state.base_mods == 0);
+    assert(xkbi->nFilters == 0);
+    assert(xtest_key_events_delivered == 24);
+
+    FreeEventList(events, GetMaximumEventsNum());
+    xkbPrivPtr->realInputProc = oldproc;
+}
+
 int
 xtest_test(void)
 {
     xtest_init_devices();
     xtest_properties();
+    xtest_key_actions();
 
     return 0;
 }
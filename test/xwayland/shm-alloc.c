@@ -0,0 +1,125 @@
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ * SHM pixmap allocation latency on rootless Xwayland.  Every top-level
+ * window gets its own backing pixmap, so mapping a window and resizing
+ * it each allocate one from the wl_shm path; each step is followed by
+ * a round trip and timed as a whole.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <xcb/xcb.h>
+
+#define NUM_WINDOWS 16
+#define NUM_ROUNDS 200
+
+static double
+now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+struct latency {
+    const char *name;
+    double total, max;
+    int count;
+};
+
+static void
+sync_and_account(xcb_connection_t *c, struct latency *lat, double start)
+{
+    double elapsed;
+
+    free(xcb_get_input_focus_reply(c, xcb_get_input_focus(c), NULL));
+
+    elapsed = now() - start;
+    lat->total += elapsed;
+    if (elapsed > lat->max)
+        lat->max = elapsed;
+    lat->count++;
+}
+
+int main(int argc, char **argv)
+{
+    xcb_connection_t *c = xcb_connect(NULL, NULL);
+    xcb_screen_t *screen;
+    xcb_window_t windows[NUM_WINDOWS];
+    struct latency stats[] = {
+        { "map" }, { "resize" }, { "destroy" },
+    };
+    double start;
+    int i, round;
+
+    if (xcb_connection_has_error(c)) {
+        printf("Failed to connect\n");
+        exit(77);
+    }
+
+    screen = xcb_setup_roots_iterator(xcb_get_setup(c)).data;
+
+    for (round = 0; round < NUM_ROUNDS; round++) {
+        for (i = 0; i < NUM_WINDOWS; i++) {
+            uint16_t w = 64 + 37 * ((round + i) % 24);
+            uint16_t h = 48 + 29 * ((round * 3 + i) % 24);
+
+            windows[i] = xcb_generate_id(c);
+            xcb_create_window(c, XCB_COPY_FROM_PARENT, windows[i],
+                              screen->root, 10 * i, 10 * i, w, h, 0,
+                              XCB_WINDOW_CLASS_INPUT_OUTPUT,
+                              screen->root_visual, 0, NULL);
+
+            start = now();
+            xcb_map_window(c, windows[i]);
+            sync_and_account(c, &stats[0], start);
+        }
+
+        for (i = 0; i < NUM_WINDOWS; i++) {
+            uint32_t size[2] = { 96 + 41 * ((round + i) % 20),
+                                 80 + 23 * ((round + 2 * i) % 20) };
+
+            start = now();
+            xcb_configure_window(c, windows[i],
+                                 XCB_CONFIG_WINDOW_WIDTH |
+                                 XCB_CONFIG_WINDOW_HEIGHT, size);
+            sync_and_account(c, &stats[1], start);
+        }
+
+        for (i = 0; i < NUM_WINDOWS; i++) {
+            start = now();
+            xcb_destroy_window(c, windows[i]);
+            sync_and_account(c, &stats[2], start);
+        }
+    }
+
+    for (i = 0; i < sizeof(stats) / sizeof(stats[0]); i++)
+        printf("%-8s %6d ops, mean %8.1f us, max %8.1f us\n",
+               stats[i].name, stats[i].count,
+               stats[i].total / stats[i].count * 1e6, stats[i].max * 1e6);
+
+    xcb_disconnect(c);
+    return 0;
+}
@@ -0,0 +1,312 @@
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ * Minimal Wayland compositor stand-in for running Xwayland in tests.
+ * It offers wl_compositor, wl_shm and a single wl_output, accepts every
+ * surface request, releases buffers and fires frame callbacks as soon
+ * as a surface is committed, and never puts anything on screen.
+ *
+ * With STUB_HELD_BUFFERS=n in the environment, the last n committed
+ * buffers are held before being released, the way a compositor still
+ * scanning them out would, so the client has to rotate through more
+ * buffers.  With STUB_DUMP=path, the contents of every committed shm
+ * buffer are written to path: width, height and stride as three
+ * int32_t, followed by the rows.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <wayland-server.h>
+
+struct stub_surface {
+    struct wl_resource *buffer;
+    struct wl_list frames;
+    struct wl_list held;
+};
+
+struct held_buffer {
+    struct wl_resource *buffer;
+    struct wl_listener destroy;
+    struct wl_list link;
+};
+
+static int max_held;
+static const char *dump_path;
+
+static void
+resource_destroy(struct wl_client *client, struct wl_resource *resource)
+{
+    wl_resource_destroy(resource);
+}
+
+static void
+region_add(struct wl_client *client, struct wl_resource *resource,
+           int32_t x, int32_t y, int32_t width, int32_t height)
+{
+}
+
+static const struct wl_region_interface region_impl = {
+    resource_destroy,
+    region_add,
+    region_add,
+};
+
+static void
+surface_attach(struct wl_client *client, struct wl_resource *resource,
+               struct wl_resource *buffer, int32_t x, int32_t y)
+{
+    struct stub_surface *surface = wl_resource_get_user_data(resource);
+
+    surface->buffer = buffer;
+}
+
+static void
+surface_damage(struct wl_client *client, struct wl_resource *resource,
+               int32_t x, int32_t y, int32_t width, int32_t height)
+{
+}
+
+static void
+surface_frame(struct wl_client *client, struct wl_resource *resource,
+              uint32_t id)
+{
+    struct stub_surface *surface = wl_resource_get_user_data(resource);
+    struct wl_resource *callback;
+
+    callback = wl_resource_create(client, &wl_callback_interface, 1, id);
+    wl_resource_set_implementation(callback, NULL, NULL, NULL);
+    wl_list_insert(surface->frames.prev, wl_resource_get_link(callback));
+}
+
+static void
+surface_set_region(struct wl_client *client, struct wl_resource *resource,
+                   struct wl_resource *region)
+{
+}
+
+static void
+held_buffer_free(struct held_buffer *held)
+{
+    wl_list_remove(&held->destroy.link);
+    wl_list_remove(&held->link);
+    free(held);
+}
+
+static void
+held_buffer_destroyed(struct wl_listener *listener, void *data)
+{
+    struct held_buffer *held = wl_container_of(listener, held, destroy);
+
+    held_buffer_free(held);
+}
+
+static void
+hold_buffer(struct stub_surface *surface, struct wl_resource *buffer)
+{
+    struct held_buffer *held = calloc(1, sizeof(*held));
+
+    if (!held) {
+        wl_buffer_send_release(buffer);
+        return;
+    }
+
+    held->buffer = buffer;
+    held->destroy.notify = held_buffer_destroyed;
+    wl_resource_add_destroy_listener(buffer, &held->destroy);
+    wl_list_insert(surface->held.prev, &held->link);
+
+    while (wl_list_length(&surface->held) > max_held) {
+        held = wl_container_of(surface->held.next, held, link);
+        wl_buffer_send_release(held->buffer);
+        held_buffer_free(held);
+    }
+}
+
+static void
+dump_buffer(struct wl_shm_buffer *shm)
+{
+    char tmp[4096];
+    int32_t header[3];
+    FILE *f;
+
+    header[0] = wl_shm_buffer_get_width(shm);
+    header[1] = wl_shm_buffer_get_height(shm);
+    header[2] = wl_shm_buffer_get_stride(shm);
+
+    snprintf(tmp, sizeof(tmp), "%s.tmp", dump_path);
+    f = fopen(tmp, "wb");
+    if (!f)
+        return;
+    fwrite(header, sizeof(header), 1, f);
+    fwrite(wl_shm_buffer_get_data(shm), header[2], header[1], f);
+    if (fclose(f) == 0)
+        rename(tmp, dump_path);
+}
+
+static void
+surface_commit(struct wl_client *client, struct wl_resource *resource)
+{
+    struct stub_surface *surface = wl_resource_get_user_data(resource);
+    struct wl_resource *callback, *next;
+
+    /* Touch the buffer the way a real compositor uploading it would */
+    if (surface->buffer) {
+        struct wl_shm_buffer *shm = wl_shm_buffer_get(surface->buffer);
+
+        if (shm) {
+            wl_shm_buffer_begin_access(shm);
+            (void) *(volatile char *) wl_shm_buffer_get_data(shm);
+            if (dump_path)
+                dump_buffer(shm);
+            wl_shm_buffer_end_access(shm);
+        }
+        if (max_held)
+            hold_buffer(surface, surface->buffer);
+        else
+            wl_buffer_send_release(surface->buffer);
+        surface->buffer = NULL;
+    }
+
+    wl_resource_for_each_safe(callback, next, &surface->frames) {
+        wl_callback_send_done(callback, 0);
+        wl_resource_destroy(callback);
+    }
+}
+
+static void
+surface_set_int(struct wl_client *client, struct wl_resource *resource,
+                int32_t value)
+{
+}
+
+static const struct wl_surface_interface surface_impl = {
+    resource_destroy,
+    surface_attach,
+    surface_damage,
+    surface_frame,
+    surface_set_region,
+    surface_set_region,
+    surface_commit,
+    surface_set_int,
+    surface_set_int,
+    surface_damage,
+};
+
+static void
+surface_free(struct wl_resource *resource)
+{
+    struct stub_surface *surface = wl_resource_get_user_data(resource);
+    struct wl_resource *callback, *next;
+    struct held_buffer *held, *tmp;
+
+    wl_resource_for_each_safe(callback, next, &surface->frames)
+        wl_resource_destroy(callback);
+    wl_list_for_each_safe(held, tmp, &surface->held, link)
+        held_buffer_free(held);
+    free(surface);
+}
+
+static void
+compositor_create_surface(struct wl_client *client,
+                          struct wl_resource *resource, uint32_t id)
+{
+    struct stub_surface *surface = calloc(1, sizeof(*surface));
+    struct wl_resource *res;
+
+    res = wl_resource_create(client, &wl_surface_interface,
+                             wl_resource_get_version(resource), id);
+    wl_list_init(&surface->frames);
+    wl_list_init(&surface->held);
+    wl_resource_set_implementation(res, &surface_impl, surface, surface_free);
+}
+
+static void
+compositor_create_region(struct wl_client *client,
+                         struct wl_resource *resource, uint32_t id)
+{
+    struct wl_resource *res;
+
+    res = wl_resource_create(client, &wl_region_interface, 1, id);
+    wl_resource_set_implementation(res, &region_impl, NULL, NULL);
+}
+
+static const struct wl_compositor_interface compositor_impl = {
+    compositor_create_surface,
+    compositor_create_region,
+};
+
+static void
+bind_compositor(struct wl_client *client, void *data,
+                uint32_t version, uint32_t id)
+{
+    struct wl_resource *res;
+
+    res = wl_resource_create(client, &wl_compositor_interface, version, id);
+    wl_resource_set_implementation(res, &compositor_impl, NULL, NULL);
+}
+
+static void
+bind_output(struct wl_client *client, void *data,
+            uint32_t version, uint32_t id)
+{
+    struct wl_resource *res;
+
+    res = wl_resource_create(client, &wl_output_interface, version, id);
+    wl_resource_set_implementation(res, NULL, NULL, NULL);
+
+    wl_output_send_geometry(res, 0, 0, 340, 270,
+                            WL_OUTPUT_SUBPIXEL_UNKNOWN, "xserver", "stub",
+                            WL_OUTPUT_TRANSFORM_NORMAL);
+    wl_output_send_mode(res, WL_OUTPUT_MODE_CURRENT | WL_OUTPUT_MODE_PREFERRED,
+                        1280, 1024, 60000);
+    if (version >= 2)
+        wl_output_send_done(res);
+}
+
+int main(int argc, char **argv)
+{
+    struct wl_display *display = wl_display_create();
+
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s socket-name\n", argv[0]);
+        return 1;
+    }
+
+    if (getenv("STUB_HELD_BUFFERS"))
+        max_held = atoi(getenv("STUB_HELD_BUFFERS"));
+    dump_path = getenv("STUB_DUMP");
+
+    if (wl_display_add_socket(display, argv[1]) < 0) {
+        perror("wl_display_add_socket");
+        return 1;
+    }
+
+    wl_display_init_shm(display);
+    wl_global_create(display, &wl_compositor_interface, 4, NULL,
+                     bind_compositor);
+    wl_global_create(display, &wl_output_interface, 2, NULL, bind_output);
+
+    wl_display_run(display);
+    wl_display_destroy(display);
+
+    return 0;
+}
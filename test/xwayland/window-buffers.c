@@ -0,0 +1,174 @@
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ * Window buffer contents on rootless Xwayland.  Each frame draws a
+ * small rectangle into a window, so only part of it is damaged, and
+ * waits until the stub compositor has been handed a buffer showing
+ * exactly what was drawn so far.  The compositor holds on to the last
+ * STUB_HELD_BUFFERS buffers, so every frame goes to a buffer which
+ * missed the damage of the frames in between, and has to be brought up
+ * to date from the damage history or, if it is older than that, by a
+ * full copy.  The compositor writes each committed buffer to STUB_DUMP.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <xcb/xcb.h>
+
+#define WIDTH 256
+#define HEIGHT 192
+#define NUM_FRAMES 60
+#define TIMEOUT 5.0
+
+static uint32_t expected[WIDTH * HEIGHT];
+
+static double
+now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void
+fill_expected(int x, int y, int w, int h, uint32_t pixel)
+{
+    int i, j;
+
+    for (j = y; j < y + h && j < HEIGHT; j++)
+        for (i = x; i < x + w && i < WIDTH; i++)
+            expected[j * WIDTH + i] = pixel;
+}
+
+/* Does the last committed buffer match what the client drew? */
+static int
+dump_matches(const char *path)
+{
+    int32_t header[3];
+    uint32_t row[WIDTH];
+    int match = 0;
+    FILE *f = fopen(path, "rb");
+    int x, y;
+
+    if (!f)
+        return 0;
+
+    if (fread(header, sizeof(header), 1, f) != 1 ||
+        header[0] != WIDTH || header[1] != HEIGHT ||
+        header[2] < WIDTH * 4)
+        goto out;
+
+    for (y = 0; y < HEIGHT; y++) {
+        if (fseek(f, sizeof(header) + (long) y * header[2], SEEK_SET) ||
+            fread(row, sizeof(row), 1, f) != 1)
+            goto out;
+        for (x = 0; x < WIDTH; x++) {
+            if ((row[x] & 0xffffff) != expected[y * WIDTH + x])
+                goto out;
+        }
+    }
+    match = 1;
+
+ out:
+    fclose(f);
+    return match;
+}
+
+static void
+wait_for_frame(xcb_connection_t *c, const char *path, int frame)
+{
+    double end = now() + TIMEOUT;
+
+    free(xcb_get_input_focus_reply(c, xcb_get_input_focus(c), NULL));
+
+    while (!dump_matches(path)) {
+        if (now() > end) {
+            printf("Frame %d: committed buffer does not match the window\n",
+                   frame);
+            exit(1);
+        }
+        usleep(2000);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    xcb_connection_t *c = xcb_connect(NULL, NULL);
+    const char *path = getenv("STUB_DUMP");
+    xcb_screen_t *screen;
+    xcb_window_t window;
+    xcb_gcontext_t gc;
+    uint32_t values[2];
+    int frame;
+
+    if (!path) {
+        printf("STUB_DUMP not set\n");
+        exit(77);
+    }
+
+    if (!c || xcb_connection_has_error(c)) {
+        printf("Cannot connect\n");
+        exit(1);
+    }
+
+    screen = xcb_setup_roots_iterator(xcb_get_setup(c)).data;
+    if (screen->root_depth != 24) {
+        printf("Root depth %d, need 24\n", screen->root_depth);
+        exit(77);
+    }
+
+    values[0] = 0x808080;
+    values[1] = 1;
+    window = xcb_generate_id(c);
+    xcb_create_window(c, XCB_COPY_FROM_PARENT, window, screen->root,
+                      0, 0, WIDTH, HEIGHT, 0, XCB_WINDOW_CLASS_INPUT_OUTPUT,
+                      screen->root_visual,
+                      XCB_CW_BACK_PIXEL | XCB_CW_OVERRIDE_REDIRECT, values);
+    xcb_map_window(c, window);
+    fill_expected(0, 0, WIDTH, HEIGHT, 0x808080);
+    wait_for_frame(c, path, 0);
+
+    gc = xcb_generate_id(c);
+    xcb_create_gc(c, gc, window, 0, NULL);
+
+    for (frame = 1; frame <= NUM_FRAMES; frame++) {
+        xcb_rectangle_t rect = {
+            (frame * 37) % (WIDTH - 24), (frame * 53) % (HEIGHT - 16), 24, 16
+        };
+        uint32_t pixel = (frame * 0x3b1d27) & 0xffffff;
+
+        xcb_change_gc(c, gc, XCB_GC_FOREGROUND, &pixel);
+        xcb_poly_fill_rectangle(c, window, gc, 1, &rect);
+        fill_expected(rect.x, rect.y, rect.width, rect.height, pixel);
+        wait_for_frame(c, path, frame);
+    }
+
+    printf("%d partial frames committed correctly\n", NUM_FRAMES);
+
+    xcb_disconnect(c);
+    exit(0);
+}
@@ -1138,24 +1138,24 @@ _XkbNextFreeFilter(XkbSrvInfoPtr xkbi)
 {
     register int i;
 
-    if (xkbi->szFilters == 0) {
-        xkbi->szFilters = 4;
-        xkbi->filters = calloc(xkbi->szFilters, sizeof(XkbFilterRec));
-        /* 6/21/93 (ef) -- XXX! deal with allocation failure */
-    }
-    for (i = 0; i < xkbi->szFilters; i++) {
+    for (i = 0; i < xkbi->nFilters; i++) {
         if (!xkbi->filters[i].active) {
             xkbi->filters[i].keycode = 0;
             return &xkbi->filters[i];
         }
     }
-    xkbi->szFilters *= 2;
-    xkbi->filters = reallocarray(xkbi->filters,
-                                 xkbi->szFilters, sizeof(XkbFilterRec));
-    /* 6/21/93 (ef) -- XXX! deal with allocation failure */
-    memset(&xkbi->filters[xkbi->szFilters / 2], 0,
-           (xkbi->szFilters / 2) * sizeof(XkbFilterRec));
-    return &xkbi->filters[xkbi->szFilters / 2];
+    if (xkbi->nFilters == xkbi->szFilters) {
+        int size = xkbi->szFilters ? xkbi->szFilters * 2 : 4;
+        XkbFilterPtr filters = reallocarray(xkbi->filters, size,
+                                            sizeof(XkbFilterRec));
+
+        if (!filters)
+            return NULL;
+        xkbi->filters = filters;
+        xkbi->szFilters = size;
+    }
+    memset(&xkbi->filters[xkbi->nFilters], 0, sizeof(XkbFilterRec));
+    return &xkbi->filters[xkbi->nFilters++];
 }
 
 static int
@@ -1164,13 +1164,16 @@ _XkbApplyFilters(XkbSrvInfoPtr xkbi, unsigned kc, XkbAction *pAction)
     register int i, send;
 
     send = 1;
-    for (i = 0; i < xkbi->szFilters; i++) {
+    for (i = 0; i < xkbi->nFilters; i++) {
         if ((xkbi->filters[i].active) && (xkbi->filters[i].filter))
             send =
                 ((*xkbi->filters[i].filter) (xkbi, &xkbi->filters[i], kc,
                                              pAction)
                  && send);
     }
+    /* drop trailing inactive filters so the next walk is shorter */
+    while (xkbi->nFilters > 0 && !xkbi->filters[xkbi->nFilters - 1].active)
+        xkbi->nFilters--;
     return send;
 }
 
@@ -1196,6 +1199,14 @@ _XkbApplyState(DeviceIntPtr dev, Bool genStateNotify, int evtype, int key)
     XkbSrvInfoPtr xkbi = dev->key->xkbInfo;
     int changed;
 
+    /* The derived state only depends on the base, latched and locked
+     * components, nothing to do if none of them changed */
+    if (genStateNotify &&
+        !XkbStateChangedFlags(&xkbi->prev_state, &xkbi->state)) {
+        xkbi->flags &= ~_XkbStateNotifyInProgress;
+        return;
+    }
+
     XkbComputeDerivedState(xkbi);
 
     changed = XkbStateChangedFlags(&xkbi->prev_state, &xkbi->state);
@@ -1272,54 +1283,60 @@ XkbActionGetFilter(DeviceIntPtr dev, DeviceEvent *event, KeyCode key,
         }
     }
 
+    switch (act->type) {
+    case XkbSA_NoAction:
+    case XkbSA_Terminate:
+        filter = NULL;
+        break;
+    default:
+        filter = _XkbNextFreeFilter(xkbi);
+        if (!filter) {
+            ErrorF("[xkb] %s: cannot allocate key action filter\n",
+                   dev->name);
+            *sendEvent = 1;
+            return;
+        }
+        break;
+    }
+
     switch (act->type) {
     case XkbSA_SetMods:
     case XkbSA_SetGroup:
-        filter = _XkbNextFreeFilter(xkbi);
         *sendEvent = _XkbFilterSetState(xkbi, filter, key, act);
         break;
     case XkbSA_LatchMods:
     case XkbSA_LatchGroup:
-        filter = _XkbNextFreeFilter(xkbi);
         *sendEvent = _XkbFilterLatchState(xkbi, filter, key, act);
         break;
     case XkbSA_LockMods:
     case XkbSA_LockGroup:
-        filter = _XkbNextFreeFilter(xkbi);
         *sendEvent = _XkbFilterLockState(xkbi, filter, key, act);
         break;
     case XkbSA_ISOLock:
-        filter = _XkbNextFreeFilter(xkbi);
         *sendEvent = _XkbFilterISOLock(xkbi, filter, key, act);
         break;
     case XkbSA_MovePtr:
-        filter = _XkbNextFreeFilter(xkbi);
         *sendEvent = _XkbFilterPointerMove(xkbi, filter, key, act);
         break;
     case XkbSA_PtrBtn:
     case XkbSA_LockPtrBtn:
     case XkbSA_SetPtrDflt:
-        filter = _XkbNextFreeFilter(xkbi);
         *sendEvent = _XkbFilterPointerBtn(xkbi, filter, key, act);
         break;
     case XkbSA_Terminate:
         *sendEvent = XkbDDXTerminateServer(dev, key, act);
         break;
     case XkbSA_SwitchScreen:
-        filter = _XkbNextFreeFilter(xkbi);
         *sendEvent = _XkbFilterSwitchScreen(xkbi, filter, key, act);
         break;
     case XkbSA_SetControls:
     case XkbSA_LockControls:
-        filter = _XkbNextFreeFilter(xkbi);
         *sendEvent = _XkbFilterControls(xkbi, filter, key, act);
         break;
     case XkbSA_ActionMessage:
-        filter = _XkbNextFreeFilter(xkbi);
         *sendEvent = _XkbFilterActionMessage(xkbi, filter, key, act);
         break;
     case XkbSA_RedirectKey:
-        filter = _XkbNextFreeFilter(xkbi);
         /* redirect actions must create a new DeviceEvent.  The
          * source device id for this event cannot be obtained from
          * xkbi, so we pass it here explicitly. The field deviceid
@@ -1329,11 +1346,9 @@ XkbActionGetFilter(DeviceIntPtr dev, DeviceEvent *event, KeyCode key,
         break;
     case XkbSA_DeviceBtn:
     case XkbSA_LockDeviceBtn:
-        filter = _XkbNextFreeFilter(xkbi);
         *sendEvent = _XkbFilterDeviceBtn(xkbi, filter, key, act);
         break;
     case XkbSA_XFree86Private:
-        filter = _XkbNextFreeFilter(xkbi);
         *sendEvent = _XkbFilterXF86Private(xkbi, filter, key, act);
         break;
     }
@@ -1376,14 +1391,21 @@ XkbHandleActions(DeviceIntPtr dev, DeviceIntPtr kbd, DeviceEvent *event)
             key |= BTN_ACT_FLAG;
         }
 
-        sendEvent = _XkbApplyFilters(xkbi, key, &act);
-        if (sendEvent)
-            XkbActionGetFilter(dev, event, key, &act, &sendEvent);
+        /* Fast path for plain keys: no action and no filters to run means
+         * no state change either */
+        if (act.type == XkbSA_NoAction && xkbi->nFilters == 0)
+            sendEvent = 1;
+        else {
+            sendEvent = _XkbApplyFilters(xkbi, key, &act);
+            if (sendEvent)
+                XkbActionGetFilter(dev, event, key, &act, &sendEvent);
+        }
     }
     else {
         if (!keyEvent)
             key |= BTN_ACT_FLAG;
-        sendEvent = _XkbApplyFilters(xkbi, key, NULL);
+        if (xkbi->nFilters > 0)
+            sendEvent = _XkbApplyFilters(xkbi, key, NULL);
     }
 
     if (xkbi->groupChange != 0)
@@ -1451,6 +1473,8 @@ XkbLatchModifiers(DeviceIntPtr pXDev, CARD8 mask, CARD8 latches)
         act.mods.flags = 0;
         act.mods.mask = mask & latches;
         filter = _XkbNextFreeFilter(xkbi);
+        if (!filter)
+            return BadAlloc;
         _XkbFilterLatchState(xkbi, filter, SYNTHETIC_KEYCODE, &act);
         _XkbFilterLatchState(xkbi, filter, SYNTHETIC_KEYCODE,
                              (XkbAction *) NULL);
@@ -1472,6 +1496,8 @@ XkbLatchGroup(DeviceIntPtr pXDev, int group)
         act.group.flags = 0;
         XkbSASetGroup(&act.group, group);
         filter = _XkbNextFreeFilter(xkbi);
+        if (!filter)
+            return BadAlloc;
         _XkbFilterLatchState(xkbi, filter, SYNTHETIC_KEYCODE, &act);
         _XkbFilterLatchState(xkbi, filter, SYNTHETIC_KEYCODE,
                              (XkbAction *) NULL);
@@ -696,6 +696,9 @@ XkbFreeInfo(XkbSrvInfoPtr xkbi)
 {
     free(xkbi->radioGroups);
     xkbi->radioGroups = NULL;
+    free(xkbi->filters);
+    xkbi->filters = NULL;
+    xkbi->szFilters = xkbi->nFilters = 0;
     if (xkbi->mouseKeyTimer) {
         TimerFree(xkbi->mouseKeyTimer);
         xkbi->mouseKeyTimer = NULL;